@@ -2,24 +2,142 @@
 
 // Standard.
 #include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <new>
 
 // Custom.
 #include "GcAllocation.h"
 #include "GcTypeInfo.h"
 #include "GcPtr.h"
 #include "GcContainerBase.h"
+#include "GcHeap.h"
+#include "GcRegionArena.h"
+#include "GcNursery.h"
+#include "GcPageTable.h"
+#include "GcThreadStack.h"
 #include "DebugLogger.hpp"
 
 namespace sgc {
 
-    GarbageCollector& GarbageCollector::get() {
-        static GarbageCollector garbageCollector;
+    GarbageCollector& GarbageCollector::getThreadLocal() {
+        static thread_local GarbageCollector garbageCollector(getDefault());
         return garbageCollector;
     }
 
-    GarbageCollector::GarbageCollector() {
+    GarbageCollector* GarbageCollector::getSharedGarbageCollector() const { return pSharedGarbageCollector; }
+
+    bool GarbageCollector::isOwnedByCurrentThread() const {
+        return owningThreadId == std::this_thread::get_id();
+    }
+
+    GarbageCollector::AllocationData::AllocationData() = default;
+
+    GarbageCollector::GarbageCollector() : iId(registerGarbageCollector(this)) {
         // Reserve some space for allocations to be processed.
         vGrayAllocations.reserve(1024); // NOLINT: seems like a good starting capacity
+
+        // Create heap.
+        mtxGcData.second.allocationData.pHeap = std::make_shared<GcHeap>();
+        mtxGcData.second.allocationData.pPageTable = std::make_unique<GcPageTable>();
+    }
+
+    GarbageCollector::GarbageCollector(GarbageCollector& sharedGarbageCollector)
+        : GarbageCollector() {
+        const_cast<GarbageCollector*&>(pSharedGarbageCollector) = &sharedGarbageCollector;
+
+        if (sharedGarbageCollector.pSharedGarbageCollector != nullptr) [[unlikely]] {
+            GcInfoCallbacks::getCriticalErrorCallback()(
+                "a thread-local garbage collector can't be used as a shared garbage collector");
+            throw std::runtime_error("critical error");
+        }
+
+        // Register in the shared garbage collector so that it will scan our objects.
+        std::scoped_lock guard(sharedGarbageCollector.mtxGcData.first);
+        sharedGarbageCollector.mtxGcData.second.vThreadLocalGarbageCollectors.push_back(this);
+    }
+
+    GarbageCollector::~GarbageCollector() {
+        // Delete unreachable objects (calls their destructors).
+        collectGarbage();
+
+        if (pSharedGarbageCollector != nullptr) {
+            // Lock in the same order as the shared garbage collector does.
+            std::scoped_lock sharedGuard(pSharedGarbageCollector->mtxGcData.first, mtxGcData.first);
+
+            // Objects that are still alive are referenced from other threads (for example our thread is
+            // exiting), they now belong to the shared garbage collector.
+            moveRootNodesToSharedGarbageCollector();
+            const std::vector<GcAllocation*> vAliveAllocations(
+                mtxGcData.second.allocationData.existingAllocations.begin(),
+                mtxGcData.second.allocationData.existingAllocations.end());
+            for (const auto& pAllocation : vAliveAllocations) {
+                if (pAllocation->getGarbageCollector() == this) {
+                    pSharedGarbageCollector->promoteAllocation(pAllocation);
+                }
+            }
+
+            // Unregister from the shared garbage collector.
+            auto& vThreadLocalGarbageCollectors =
+                pSharedGarbageCollector->mtxGcData.second.vThreadLocalGarbageCollectors;
+            std::erase(vThreadLocalGarbageCollectors, this);
+        }
+
+        std::scoped_lock guard(mtxGcData.first);
+        if (!mtxGcData.second.rootNodes.gcPtrRootNodes.empty() ||
+            !mtxGcData.second.rootNodes.gcContainerRootNodes.empty() ||
+            !mtxGcData.second.allocationData.existingAllocations.empty()) [[unlikely]] {
+            GcInfoCallbacks::getWarningCallback()(
+                "garbage collector is being destroyed while some of its GC pointers, GC containers "
+                "or GC objects are still alive");
+        }
+        if (!mtxGcData.second.vThreadLocalGarbageCollectors.empty()) [[unlikely]] {
+            GcInfoCallbacks::getWarningCallback()(
+                "garbage collector is being destroyed while some of its thread-local garbage collectors "
+                "are still alive");
+        }
+
+        unregisterGarbageCollector(iId);
+    }
+
+    /**
+     * Returns IDs of destroyed garbage collectors and the next never used ID (see
+     * `GarbageCollector::registerGarbageCollector`).
+     *
+     * @return Mutex and IDs.
+     */
+    static std::pair<std::mutex, std::pair<std::vector<uint16_t>, size_t>>& getFreeGarbageCollectorIds() {
+        static std::pair<std::mutex, std::pair<std::vector<uint16_t>, size_t>> mtxFreeIds;
+        return mtxFreeIds;
+    }
+
+    uint16_t GarbageCollector::registerGarbageCollector(GarbageCollector* pGarbageCollector) {
+        auto& mtxFreeIds = getFreeGarbageCollectorIds();
+        std::scoped_lock guard(mtxFreeIds.first);
+        auto& [vFreeIds, iNextId] = mtxFreeIds.second;
+
+        uint16_t iId = 0;
+        if (!vFreeIds.empty()) {
+            iId = vFreeIds.back();
+            vFreeIds.pop_back();
+        } else if (iNextId < iMaxGarbageCollectorCount) [[likely]] {
+            iId = static_cast<uint16_t>(iNextId);
+            iNextId += 1;
+        } else [[unlikely]] {
+            GcInfoCallbacks::getCriticalErrorCallback()("too many garbage collectors exist at the same time");
+            throw std::runtime_error("critical error");
+        }
+
+        vGarbageCollectorsById[iId] = pGarbageCollector;
+        return iId;
+    }
+
+    void GarbageCollector::unregisterGarbageCollector(uint16_t iId) {
+        auto& mtxFreeIds = getFreeGarbageCollectorIds();
+        std::scoped_lock guard(mtxFreeIds.first);
+
+        vGarbageCollectorsById[iId] = nullptr;
+        mtxFreeIds.second.first.push_back(iId);
     }
 
     size_t GarbageCollector::collectGarbage() {
@@ -30,6 +148,15 @@ namespace sgc {
         // lock GC mutex in constructor/destructor).
         std::scoped_lock guardAllocations(mtxGcData.first);
 
+        // Objects of thread-local garbage collectors might reference our objects so we scan them too
+        // (while their threads can't modify them).
+        const auto& vThreadLocalGarbageCollectors = mtxGcData.second.vThreadLocalGarbageCollectors;
+        std::vector<std::unique_lock<std::recursive_mutex>> vThreadLocalGuards;
+        vThreadLocalGuards.reserve(vThreadLocalGarbageCollectors.size());
+        for (const auto& pThreadLocalGarbageCollector : vThreadLocalGarbageCollectors) {
+            vThreadLocalGuards.emplace_back(pThreadLocalGarbageCollector->mtxGcData.first);
+        }
+
         SGC_DEBUG_LOG("GC started");
 
         // Before running the "mark" step color every allocation in white
@@ -39,14 +166,21 @@ namespace sgc {
              ++allocationIt) {
             (*allocationIt)->getAllocationInfo()->color = GcAllocationColor::WHITE;
         }
+        for (const auto& pThreadLocalGarbageCollector : vThreadLocalGarbageCollectors) {
+            for (const auto& pAllocation :
+                 pThreadLocalGarbageCollector->mtxGcData.second.allocationData.existingAllocations) {
+                pAllocation->getAllocationInfo()->color = GcAllocationColor::WHITE;
+            }
+        }
 
         // Prepare lambda to "mark" container items.
         const auto markContainerItems = [this](const GcContainerBase* pContainer) {
             // We know that GC containers don't point to allocations,
             // thus just iterate over GcPtr items of this container.
             pContainer->getFunctionToIterateOverGcPtrItems()(pContainer, [this](const GcPtrBase* pGcPtrItem) {
-                // Make sure this pointer references an allocation.
-                if (pGcPtrItem->pAllocation == nullptr) {
+                // Make sure this pointer references an allocation (that we manage).
+                if (pGcPtrItem->pAllocation == nullptr ||
+                    !isTracing(pGcPtrItem->pAllocation->getGarbageCollector())) {
                     return;
                 }
 
@@ -60,8 +194,23 @@ namespace sgc {
             });
         };
 
+        // Prepare a lambda to "mark" GC pointers in memory of tracing allocators.
+        const auto& tracedMemoryBlocks = mtxGcData.second.allocationData.tracedMemoryBlocks;
+        const auto& ownedTracedMemoryBlocks = mtxGcData.second.allocationData.ownedTracedMemoryBlocks;
+        const auto markTracedMemory = [this, &tracedMemoryBlocks](std::byte* pBlock) {
+            const auto iBlockSize = tracedMemoryBlocks.find(pBlock)->second.iSizeInBytes;
+            forEachGcPtrInTracedMemory(pBlock, iBlockSize, [this](const GcPtrBase* pGcPtr) {
+                if (pGcPtr->pAllocation->getAllocationInfo()->color == GcAllocationColor::WHITE) {
+                    vGrayAllocations.push_back(pGcPtr->pAllocation);
+                }
+            });
+        };
+
         // Prepare a lambda to do the "mark" step.
-        const auto markAllocationAndProcessFields = [this, &markContainerItems](GcAllocation* pAllocation) {
+        const auto markAllocationAndProcessFields = [this,
+                                                     &markContainerItems,
+                                                     &markTracedMemory,
+                                                     &ownedTracedMemoryBlocks](GcAllocation* pAllocation) {
             // Mark this object in black.
             pAllocation->getAllocationInfo()->color = GcAllocationColor::BLACK;
 
@@ -74,58 +223,43 @@ namespace sgc {
             }
 #endif
 
-            // Iterate over GcPtr fields of the allocation.
-            for (const auto& iGcPtrFieldOffset : pAllocation->getTypeInfo()->vGcPtrFieldOffsets) {
-                // Get address of GcPtr field.
-                const auto pGcPtrField = reinterpret_cast<GcPtrBase*>(
-                    reinterpret_cast<char*>(pAllocation->getAllocatedObject()) +
-                    static_cast<uintptr_t>(iGcPtrFieldOffset));
-
-                // Make sure this pointer references an allocation.
-                if (pGcPtrField->pAllocation == nullptr) {
-                    // Check the next GcPtr field.
-                    continue;
-                }
-
-                if (pGcPtrField->pAllocation->getAllocationInfo()->color != GcAllocationColor::WHITE) {
-                    // We already found pointer(s) to this allocation so skip processing it.
-                    continue;
-                }
+            // Iterate over GcPtr and GcContainer fields of the allocation.
+            pAllocation->getTypeInfo()->forEachGcNodeField(
+                pAllocation->getAllocatedObject(),
+                [this](GcPtrBase* pGcPtrField) {
+                    // Make sure this pointer references an allocation (that we manage).
+                    if (pGcPtrField->pAllocation == nullptr ||
+                        !isTracing(pGcPtrField->pAllocation->getGarbageCollector())) {
+                        // Check the next GcPtr field.
+                        return;
+                    }
 
-                // Add the allocation to be processed later.
-                vGrayAllocations.push_back(pGcPtrField->pAllocation);
-            }
+                    if (pGcPtrField->pAllocation->getAllocationInfo()->color != GcAllocationColor::WHITE) {
+                        // We already found pointer(s) to this allocation so skip processing it.
+                        return;
+                    }
 
-            // Now iterate over GcContainer fields of the allocation.
-            for (const auto& iGcContainerFieldOffset : pAllocation->getTypeInfo()->vGcContainerFieldOffsets) {
-                // Get address of GcContainer field.
-                const auto pGcContainerField = reinterpret_cast<GcContainerBase*>(
-                    reinterpret_cast<char*>(pAllocation->getAllocatedObject()) +
-                    static_cast<uintptr_t>(iGcContainerFieldOffset));
+                    // Add the allocation to be processed later.
+                    vGrayAllocations.push_back(pGcPtrField->pAllocation);
+                },
+                [&markContainerItems](GcContainerBase* pGcContainerField) {
+                    // Mark container items.
+                    markContainerItems(pGcContainerField);
+                });
 
-                // Mark container items.
-                markContainerItems(pGcContainerField);
+            // Mark items of standard containers that use tracing allocators owned by this object.
+            if (!ownedTracedMemoryBlocks.empty()) {
+                const auto blocksIt = ownedTracedMemoryBlocks.find(pAllocation);
+                if (blocksIt != ownedTracedMemoryBlocks.end()) {
+                    for (const auto& pBlock : blocksIt->second) {
+                        markTracedMemory(pBlock);
+                    }
+                }
             }
         };
 
-        // Start marking phase from root GcPtr nodes.
-        auto& rootSet = mtxGcData.second.rootNodes;
-        for (auto ptrIt = rootSet.gcPtrRootNodes.begin(); ptrIt != rootSet.gcPtrRootNodes.end(); ++ptrIt) {
-            // Make sure this GcPtr points to a valid allocation.
-            const auto pGcPtr = *ptrIt;
-            if (pGcPtr->pAllocation == nullptr) {
-                // This may happen and it's perfectly fine.
-                continue;
-            }
-
-            // Process root node.
-            SGC_DEBUG_LOG(std::format(
-                "processing root GcPtr {} with allocation {}",
-                reinterpret_cast<uintptr_t>(pGcPtr),
-                reinterpret_cast<uintptr_t>(pGcPtr->pAllocation)));
-            markAllocationAndProcessFields(pGcPtr->pAllocation);
-
-            // Process pending allocations.
+        // Prepare a lambda to process pending allocations.
+        const auto processGrayAllocations = [this, &markAllocationAndProcessFields]() {
             while (!vGrayAllocations.empty()) {
                 // Get allocation from gray array.
                 const auto pAllocation = vGrayAllocations.back(); // copy
@@ -138,59 +272,124 @@ namespace sgc {
                 // Process "gray" allocation.
                 markAllocationAndProcessFields(pAllocation);
             }
-        }
+        };
 
-        SGC_DEBUG_LOG("starting to process root GcContainers");
+        // Prepare a lambda to mark allocations reachable from the specified root set.
+        const auto markRootSet = [&](const RootNodes& rootSet) {
+            // Start marking phase from root GcPtr nodes.
+            for (auto ptrIt = rootSet.gcPtrRootNodes.begin(); ptrIt != rootSet.gcPtrRootNodes.end();
+                 ++ptrIt) {
+                // Make sure this GcPtr points to a valid allocation (that we manage).
+                const auto pGcPtr = *ptrIt;
+                if (pGcPtr->pAllocation == nullptr ||
+                    !isTracing(pGcPtr->pAllocation->getGarbageCollector())) {
+                    // This may happen and it's perfectly fine.
+                    continue;
+                }
 
-        // Now iterate over root GcContainer nodes.
-        for (auto ptrIt = rootSet.gcContainerRootNodes.begin(); ptrIt != rootSet.gcContainerRootNodes.end();
-             ++ptrIt) {
-            markContainerItems(*ptrIt);
+                // Process root node.
+                SGC_DEBUG_LOG(std::format(
+                    "processing root GcPtr {} with allocation {}",
+                    reinterpret_cast<uintptr_t>(pGcPtr),
+                    reinterpret_cast<uintptr_t>(pGcPtr->pAllocation.get())));
+                markAllocationAndProcessFields(pGcPtr->pAllocation);
 
-            // Process pending allocations.
-            while (!vGrayAllocations.empty()) {
-                // Get allocation from gray array.
-                const auto pAllocation = vGrayAllocations.back(); // copy
-                vGrayAllocations.pop_back();
+                // Process pending allocations.
+                processGrayAllocations();
+            }
 
-                SGC_DEBUG_LOG(std::format(
-                    "processing allocation with user object {} from gray set",
-                    reinterpret_cast<uintptr_t>(pAllocation->getAllocatedObject())));
+            SGC_DEBUG_LOG("starting to process root GcContainers");
 
-                // Process "gray" allocation.
-                markAllocationAndProcessFields(pAllocation);
+            // Now iterate over root GcContainer nodes.
+            for (auto ptrIt = rootSet.gcContainerRootNodes.begin();
+                 ptrIt != rootSet.gcContainerRootNodes.end();
+                 ++ptrIt) {
+                markContainerItems(*ptrIt);
+
+                // Process pending allocations.
+                processGrayAllocations();
             }
-        }
+        };
 
-        SGC_DEBUG_LOG("GC sweep started");
+        // Mark from our root set and root sets of our thread-local garbage collectors.
+        markRootSet(mtxGcData.second.rootNodes);
+        for (const auto& pThreadLocalGarbageCollector : vThreadLocalGarbageCollectors) {
+            markRootSet(pThreadLocalGarbageCollector->mtxGcData.second.rootNodes);
+        }
 
-        // Now do the "sweep" phase.
-        size_t iDeletedObjectCount = 0;
-        for (auto allocationIt = existingAllocations.begin(); allocationIt != existingAllocations.end();) {
-            // Check allocation color.
-            const auto pAllocation = *allocationIt;
+        // Mark from GC pointers on registered thread stacks.
+        for (const auto& pAllocation : findStackReferencedAllocations()) {
             if (pAllocation->getAllocationInfo()->color != GcAllocationColor::WHITE) {
-                // We should keep this allocation, switch to the next one.
-                ++allocationIt;
                 continue;
             }
 
-            // Remove the allocation (update our iterator).
-            allocationIt = existingAllocations.erase(allocationIt);
+            markAllocationAndProcessFields(pAllocation);
+            processGrayAllocations();
+        }
 
-            // Remove the allocation's info.
-            if (mtxGcData.second.allocationData.allocationInfoRefs.erase(pAllocation->getAllocationInfo()) !=
-                1) [[unlikely]] {
-                GcInfoCallbacks::getWarningCallback()(
-                    "GC allocation failed to find its allocation info (to be "
-                    "erased) in the array of existing allocation info objects");
+        // Mark from memory of tracing allocators that is not owned by objects.
+        for (const auto& [pBlock, block] : tracedMemoryBlocks) {
+            if (block.pOwner == nullptr) {
+                markTracedMemory(pBlock);
+                processGrayAllocations();
             }
+        }
 
-            // Delete (free) the allocation.
-            delete pAllocation;
-            iDeletedObjectCount += 1;
+        SGC_DEBUG_LOG("GC sweep started");
+
+        // Destructors of deleted objects and moved objects change GC pointers, reference counts are
+        // recalculated after that.
+        mtxGcData.second.allocationData.bIgnoreReferenceCountChanges = true;
+
+        // Now do the "sweep" phase.
+        std::vector<GcAllocation*> vGarbage;
+        for (const auto& pAllocation : existingAllocations) {
+            if (pAllocation->getAllocationInfo()->color == GcAllocationColor::WHITE) {
+                vGarbage.push_back(pAllocation);
+            }
+        }
+        deleteAllocations(vGarbage);
+        const auto iDeletedObjectCount = vGarbage.size();
+
+        // Defragment the heap (if enabled).
+        if (mtxGcData.second.allocationData.bCompactHeap) {
+            compactHeap();
+        }
+
+        mtxGcData.second.allocationData.bIgnoreReferenceCountChanges = false;
+        if (mtxGcData.second.allocationData.bUseReferenceCounting) {
+            recalculateReferenceCounts();
         }
 
+        // Return memory of empty pages to the OS (if needed).
+        mtxGcData.second.allocationData.pHeap->onGarbageCollectionFinished();
+        auto& vAdoptedHeaps = mtxGcData.second.allocationData.vAdoptedHeaps;
+        for (const auto& pAdoptedHeap : vAdoptedHeaps) {
+            pAdoptedHeap->onGarbageCollectionFinished();
+        }
+
+        // Release heaps of exited threads once all objects promoted from them are deleted.
+        std::erase_if(vAdoptedHeaps, [](const std::shared_ptr<GcHeap>& pAdoptedHeap) {
+            return pAdoptedHeap.use_count() == 1 && pAdoptedHeap->isEmpty();
+        });
+
+        // Free empty nursery blocks and reuse memory of deleted objects.
+        if (mtxGcData.second.allocationData.pNursery != nullptr) {
+            mtxGcData.second.allocationData.pNursery->onGarbageCollectionFinished();
+        }
+        auto& vAdoptedNurseries = mtxGcData.second.allocationData.vAdoptedNurseries;
+        for (const auto& pAdoptedNursery : vAdoptedNurseries) {
+            pAdoptedNursery->onGarbageCollectionFinished();
+        }
+        std::erase_if(vAdoptedNurseries, [](const std::shared_ptr<GcNursery>& pAdoptedNursery) {
+            return pAdoptedNursery.use_count() == 1 && pAdoptedNursery->isEmpty();
+        });
+
+        // Release memory of ended regions once all objects that escaped from them are deleted.
+        std::erase_if(
+            mtxGcData.second.allocationData.vAdoptedRegionArenas,
+            [](const std::shared_ptr<GcRegionArena>& pArena) { return pArena->isEmpty(); });
+
         SGC_DEBUG_LOG("GC ended");
 
         return iDeletedObjectCount;
@@ -201,6 +400,137 @@ namespace sgc {
         return mtxGcData.second.allocationData.existingAllocations.size();
     }
 
+    void GarbageCollector::setLargeObjectThreshold(size_t iSizeInBytes) {
+        std::scoped_lock guard(mtxGcData.first);
+        mtxGcData.second.allocationData.iLargeObjectThreshold = iSizeInBytes;
+    }
+
+    size_t GarbageCollector::getLargeObjectThreshold() {
+        std::scoped_lock guard(mtxGcData.first);
+        return mtxGcData.second.allocationData.iLargeObjectThreshold;
+    }
+
+    void GarbageCollector::setMemoryResource(std::pmr::memory_resource* pMemoryResource) {
+        std::scoped_lock guard(mtxGcData.first);
+        mtxGcData.second.allocationData.pMemoryResource = pMemoryResource;
+    }
+
+    std::pmr::memory_resource* GarbageCollector::getMemoryResource() {
+        std::scoped_lock guard(mtxGcData.first);
+        return mtxGcData.second.allocationData.pMemoryResource;
+    }
+
+    size_t GarbageCollector::getLargeObjectSpaceSize() {
+        std::scoped_lock guard(mtxGcData.first);
+        return mtxGcData.second.allocationData.iLargeObjectSpaceSize;
+    }
+
+    void GarbageCollector::setHeapDecommitPolicy(const GcDecommitPolicy& policy) {
+        std::scoped_lock guard(mtxGcData.first);
+        mtxGcData.second.allocationData.pHeap->setDecommitPolicy(policy);
+    }
+
+    GcDecommitPolicy GarbageCollector::getHeapDecommitPolicy() {
+        std::scoped_lock guard(mtxGcData.first);
+        return mtxGcData.second.allocationData.pHeap->getDecommitPolicy();
+    }
+
+    size_t GarbageCollector::getCommittedHeapSize() {
+        std::scoped_lock guard(mtxGcData.first);
+        return mtxGcData.second.allocationData.pHeap->getCommittedSize();
+    }
+
+    bool GarbageCollector::setUseHugePagesForHeap(bool bEnable) {
+        std::scoped_lock guard(mtxGcData.first);
+        return mtxGcData.second.allocationData.pHeap->setUseHugePages(bEnable);
+    }
+
+    bool GarbageCollector::isHeapUsingHugePages() {
+        std::scoped_lock guard(mtxGcData.first);
+        return mtxGcData.second.allocationData.pHeap->isUsingHugePages();
+    }
+
+    void GarbageCollector::setCompactHeap(bool bEnable) {
+        std::scoped_lock guard(mtxGcData.first);
+        mtxGcData.second.allocationData.bCompactHeap = bEnable;
+    }
+
+    bool GarbageCollector::isCompactingHeap() {
+        std::scoped_lock guard(mtxGcData.first);
+        return mtxGcData.second.allocationData.bCompactHeap;
+    }
+
+    void GarbageCollector::setUseNursery(bool bEnable) {
+        std::scoped_lock guard(mtxGcData.first);
+        auto& allocationData = mtxGcData.second.allocationData;
+
+        if (bEnable && allocationData.pNursery == nullptr) {
+            allocationData.pNursery = std::make_shared<GcNursery>();
+        }
+        allocationData.bUseNursery = bEnable;
+    }
+
+    bool GarbageCollector::isUsingNursery() {
+        std::scoped_lock guard(mtxGcData.first);
+        return mtxGcData.second.allocationData.bUseNursery;
+    }
+
+    size_t GarbageCollector::getNurserySize() {
+        std::scoped_lock guard(mtxGcData.first);
+        const auto& pNursery = mtxGcData.second.allocationData.pNursery;
+        return pNursery == nullptr ? 0 : pNursery->getReservedSize();
+    }
+
+    void GarbageCollector::setUseReferenceCounting(bool bEnable) {
+        std::scoped_lock guard(mtxGcData.first);
+        auto& allocationData = mtxGcData.second.allocationData;
+
+        if (bEnable == allocationData.bUseReferenceCounting) {
+            return;
+        }
+        allocationData.bUseReferenceCounting = bEnable;
+
+        if (bEnable) {
+            // Counts were not maintained.
+            recalculateReferenceCounts();
+            return;
+        }
+
+        for (const auto& pAllocation : allocationData.vZeroCountAllocations) {
+            pAllocation->getReferenceCount().bInZeroCountTable = false;
+        }
+        allocationData.vZeroCountAllocations.clear();
+        for (const auto& pAllocation : allocationData.vPossibleCycleRoots) {
+            pAllocation->getReferenceCount().bPossibleCycleRoot = false;
+        }
+        allocationData.vPossibleCycleRoots.clear();
+    }
+
+    bool GarbageCollector::isUsingReferenceCounting() {
+        std::scoped_lock guard(mtxGcData.first);
+        return mtxGcData.second.allocationData.bUseReferenceCounting;
+    }
+
+    size_t GarbageCollector::collectUnreferencedObjects() {
+        std::scoped_lock guard(mtxGcData.first);
+
+        if (!mtxGcData.second.allocationData.bUseReferenceCounting) {
+            return 0;
+        }
+
+        return deleteUnreferencedAllocations();
+    }
+
+    size_t GarbageCollector::collectUnreferencedCycles() {
+        std::scoped_lock guard(mtxGcData.first);
+
+        if (!mtxGcData.second.allocationData.bUseReferenceCounting) {
+            return 0;
+        }
+
+        return deleteUnreferencedCycles();
+    }
+
     std::pair<std::recursive_mutex*, GarbageCollector::RootNodes*> GarbageCollector::getRootNodes() {
         return std::make_pair(&mtxGcData.first, &mtxGcData.second.rootNodes);
     }
@@ -237,6 +567,23 @@ namespace sgc {
 
             auto& rootSet = mtxGcData.second.rootNodes;
 
+            // GC pointers in memory of tracing allocators are found by scanning that memory.
+            const auto& tracedMemoryBlocks = mtxGcData.second.allocationData.tracedMemoryBlocks;
+            if (!tracedMemoryBlocks.empty() && dynamic_cast<GcPtrBase*>(pConstructedNode) != nullptr) {
+                const auto pNode = reinterpret_cast<std::byte*>(pConstructedNode);
+                auto blockIt = tracedMemoryBlocks.upper_bound(pNode);
+                if (blockIt != tracedMemoryBlocks.begin() &&
+                    pNode < (--blockIt)->first + blockIt->second.iSizeInBytes) {
+                    if (blockIt->second.pOwner != nullptr) {
+                        // Belongs to the owner object.
+                        return false;
+                    }
+
+                    pConstructedNode->setIsScannedNode();
+                    return true;
+                }
+            }
+
             // Add this node as a new root node.
             if (const auto pGcContainerNode = dynamic_cast<GcContainerBase*>(pConstructedNode)) {
                 rootSet.gcContainerRootNodes.insert(pGcContainerNode);
@@ -279,4 +626,734 @@ namespace sgc {
             throw std::runtime_error("critical error");
         }
     }
+
+    void GarbageCollector::onAllocationBeingReferenced(GcAllocation* pAllocation) {
+        if (pAllocation == nullptr || pAllocation->getGarbageCollector() == this) {
+            return;
+        }
+
+        // Thread-local objects can reference objects of the shared garbage collector.
+        if (pAllocation->getGarbageCollector() == pSharedGarbageCollector) {
+            return;
+        }
+
+        // Objects of our thread-local garbage collectors escape to us.
+        if (pAllocation->getGarbageCollector()->pSharedGarbageCollector == this) {
+            promoteAllocation(pAllocation);
+            return;
+        }
+
+        GcInfoCallbacks::getCriticalErrorCallback()(
+            "a GC pointer can't reference an object that belongs to a different garbage collector");
+        throw std::runtime_error("critical error");
+    }
+
+    GcAllocation* GarbageCollector::findThreadLocalAllocation(GcAllocationInfo* pAllocationInfo) {
+        for (const auto& pThreadLocalGarbageCollector : mtxGcData.second.vThreadLocalGarbageCollectors) {
+            std::scoped_lock guard(pThreadLocalGarbageCollector->mtxGcData.first);
+
+            const auto& allocationInfoRefs =
+                pThreadLocalGarbageCollector->mtxGcData.second.allocationData.allocationInfoRefs;
+            const auto allocationInfoIt = allocationInfoRefs.find(pAllocationInfo);
+            if (allocationInfoIt != allocationInfoRefs.end()) {
+                return allocationInfoIt->second;
+            }
+        }
+
+        return nullptr;
+    }
+
+    GcAllocation* GarbageCollector::findAllocationContaining(const void* pAddress) {
+        const auto& allocationData = mtxGcData.second.allocationData;
+
+        // Objects in heaps are found by the owner of the heap slot that contains the address.
+        const auto findInHeap = [this, pAddress](GcHeap* pHeap) -> GcAllocation* {
+            const auto pAllocation = static_cast<GcAllocation*>(pHeap->findOwner(pAddress));
+            if (pAllocation == nullptr || pAllocation->getGarbageCollector() != this ||
+                !pAllocation->containsAddress(pAddress)) {
+                return nullptr;
+            }
+            return pAllocation;
+        };
+        if (const auto pAllocation = findInHeap(allocationData.pHeap.get())) {
+            return pAllocation;
+        }
+
+        // Heaps of thread-local garbage collectors are used under their mutex (adopted heaps of finished
+        // thread-local garbage collectors are only used by us).
+        for (const auto& pThreadLocalGarbageCollector : mtxGcData.second.vThreadLocalGarbageCollectors) {
+            std::scoped_lock guard(pThreadLocalGarbageCollector->mtxGcData.first);
+            if (const auto pAllocation =
+                    findInHeap(pThreadLocalGarbageCollector->mtxGcData.second.allocationData.pHeap.get())) {
+                return pAllocation;
+            }
+        }
+        for (const auto& pAdoptedHeap : allocationData.vAdoptedHeaps) {
+            if (pAdoptedHeap.use_count() != 1) {
+                continue;
+            }
+            if (const auto pAllocation = findInHeap(pAdoptedHeap.get())) {
+                return pAllocation;
+            }
+        }
+
+        // Look for other objects in the page table.
+        const auto pAllocation = static_cast<GcAllocation*>(allocationData.pPageTable->findOwner(pAddress));
+        if (pAllocation == nullptr || !pAllocation->containsAddress(pAddress)) {
+            return nullptr;
+        }
+
+        return pAllocation;
+    }
+
+    GcAllocation* GarbageCollector::findThreadLocalAllocationContaining(const void* pAddress) {
+        for (const auto& pThreadLocalGarbageCollector : mtxGcData.second.vThreadLocalGarbageCollectors) {
+            std::scoped_lock guard(pThreadLocalGarbageCollector->mtxGcData.first);
+
+            if (const auto pAllocation = pThreadLocalGarbageCollector->findAllocationContaining(pAddress)) {
+                return pAllocation;
+            }
+        }
+
+        return nullptr;
+    }
+
+    void GarbageCollector::promoteAllocation(GcAllocation* pAllocation) {
+        // Lock thread-local garbage collector after ours (same order as in garbage collection).
+        const auto pThreadLocalGarbageCollector = pAllocation->getGarbageCollector();
+        std::scoped_lock guard(pThreadLocalGarbageCollector->mtxGcData.first);
+
+        // Once allocated on the thread-local heap (or nursery) the memory is freed to that heap
+        // (or nursery) so keep it alive while we have objects from it.
+        auto& vAdoptedHeaps = mtxGcData.second.allocationData.vAdoptedHeaps;
+        const auto& pThreadLocalHeap = pThreadLocalGarbageCollector->mtxGcData.second.allocationData.pHeap;
+        if (std::find(vAdoptedHeaps.begin(), vAdoptedHeaps.end(), pThreadLocalHeap) == vAdoptedHeaps.end()) {
+            vAdoptedHeaps.push_back(pThreadLocalHeap);
+        }
+        auto& vAdoptedNurseries = mtxGcData.second.allocationData.vAdoptedNurseries;
+        const auto& pThreadLocalNursery =
+            pThreadLocalGarbageCollector->mtxGcData.second.allocationData.pNursery;
+        if (pThreadLocalNursery != nullptr &&
+            std::find(vAdoptedNurseries.begin(), vAdoptedNurseries.end(), pThreadLocalNursery) ==
+                vAdoptedNurseries.end()) {
+            vAdoptedNurseries.push_back(pThreadLocalNursery);
+        }
+
+        // Move all thread-local allocations reachable from the specified one.
+        std::vector<GcAllocation*> vAllocationsToPromote = {pAllocation};
+        const auto promoteGcPtr = [&](GcPtrBase* pGcPtr) {
+            pGcPtr->iGarbageCollectorId = iId;
+
+            // Check referenced allocation.
+            if (pGcPtr->pAllocation != nullptr &&
+                pGcPtr->pAllocation->getGarbageCollector() == pThreadLocalGarbageCollector) {
+                vAllocationsToPromote.push_back(pGcPtr->pAllocation);
+            }
+        };
+        while (!vAllocationsToPromote.empty()) {
+            const auto pAllocationToPromote = vAllocationsToPromote.back(); // copy
+            vAllocationsToPromote.pop_back();
+
+            if (pAllocationToPromote->getGarbageCollector() != pThreadLocalGarbageCollector) {
+                // Already promoted.
+                continue;
+            }
+
+            SGC_DEBUG_LOG(std::format(
+                "promoting allocation with user object {}",
+                reinterpret_cast<uintptr_t>(pAllocationToPromote->getAllocatedObject())));
+
+            pAllocationToPromote->moveToGarbageCollector(this);
+
+            // GC node fields now belong to us.
+            pAllocationToPromote->getTypeInfo()->forEachGcNodeField(
+                pAllocationToPromote->getAllocatedObject(),
+                promoteGcPtr,
+                [this, &promoteGcPtr](GcContainerBase* pContainer) {
+                    pContainer->iGarbageCollectorId = iId;
+
+                    pContainer->getFunctionToIterateOverGcPtrItems()(
+                        pContainer, [&](const GcPtrBase* pGcPtrItem) {
+                            promoteGcPtr(const_cast<GcPtrBase*>(pGcPtrItem));
+                        });
+                });
+        }
+    }
+
+    void GarbageCollector::moveRootNodesToSharedGarbageCollector() {
+        const auto pParentGarbageCollector = pSharedGarbageCollector;
+
+        auto& rootNodes = mtxGcData.second.rootNodes;
+        auto& parentRootNodes = pParentGarbageCollector->mtxGcData.second.rootNodes;
+
+        // Objects reachable from root nodes that are still alive escape.
+        for (const auto& pGcPtr : rootNodes.gcPtrRootNodes) {
+            pParentGarbageCollector->onAllocationBeingReferenced(pGcPtr->pAllocation);
+
+            const_cast<GcPtrBase*>(pGcPtr)->iGarbageCollectorId = pParentGarbageCollector->iId;
+            parentRootNodes.gcPtrRootNodes.insert(pGcPtr);
+        }
+        for (const auto& pContainer : rootNodes.gcContainerRootNodes) {
+            pContainer->getFunctionToIterateOverGcPtrItems()(
+                pContainer, [pParentGarbageCollector](const GcPtrBase* pGcPtrItem) {
+                    pParentGarbageCollector->onAllocationBeingReferenced(pGcPtrItem->pAllocation);
+                    const_cast<GcPtrBase*>(pGcPtrItem)->iGarbageCollectorId = pParentGarbageCollector->iId;
+                });
+
+            const_cast<GcContainerBase*>(pContainer)->iGarbageCollectorId = pParentGarbageCollector->iId;
+            parentRootNodes.gcContainerRootNodes.insert(pContainer);
+        }
+        rootNodes.gcPtrRootNodes.clear();
+        rootNodes.gcContainerRootNodes.clear();
+    }
+
+    void GarbageCollector::onRegionEnded() {
+        const auto pParentGarbageCollector = pSharedGarbageCollector;
+
+        {
+            // Lock in the same order as promotion does.
+            std::scoped_lock guard(pParentGarbageCollector->mtxGcData.first, mtxGcData.first);
+
+            // Root nodes that are still alive outlive the region.
+            moveRootNodesToSharedGarbageCollector();
+        }
+
+        // Everything that did not escape is unreachable now (no root nodes left), there's nothing to mark.
+        collectGarbage();
+
+        // Keep memory of escaped objects.
+        std::scoped_lock guard(pParentGarbageCollector->mtxGcData.first, mtxGcData.first);
+        auto& pRegionArena = mtxGcData.second.allocationData.pRegionArena;
+        if (!pRegionArena->isEmpty()) {
+            pParentGarbageCollector->mtxGcData.second.allocationData.vAdoptedRegionArenas.push_back(
+                pRegionArena);
+        }
+        pRegionArena = nullptr;
+    }
+
+    size_t GarbageCollector::compactHeap() {
+        // Objects that are being constructed (if garbage collection was started from a constructor)
+        // can't be moved.
+        std::scoped_lock constructingGuard(mtxCurrentlyConstructingObjects.first);
+        if (!mtxCurrentlyConstructingObjects.second.empty()) {
+            return 0;
+        }
+
+        const auto pHeap = mtxGcData.second.allocationData.pHeap.get();
+        if (!pHeap->beginCompaction()) {
+            return 0;
+        }
+
+        SGC_DEBUG_LOG("heap compaction started");
+
+        // Find objects in evacuating pages (objects promoted from other heaps are not moved).
+        std::vector<GcAllocation*> vAllocationsToMove;
+        for (const auto& pAllocation : mtxGcData.second.allocationData.existingAllocations) {
+            if (pAllocation->shouldRelocate(pHeap)) {
+                vAllocationsToMove.push_back(pAllocation);
+            }
+        }
+
+        // Move them (move constructors are called so don't iterate over allocations here).
+        for (const auto& pAllocation : vAllocationsToMove) {
+            pAllocation->relocateInHeap();
+        }
+        const auto iMovedObjectCount = vAllocationsToMove.size();
+
+        pHeap->endCompaction();
+
+        SGC_DEBUG_LOG(std::format("heap compaction moved {} object(s)", iMovedObjectCount));
+
+        return iMovedObjectCount;
+    }
+
+    void GarbageCollector::onReferenceChanged(
+        const GcPtrBase* pGcPtr, GcAllocation* pOldAllocation, GcAllocation* pNewAllocation) {
+        auto& allocationData = mtxGcData.second.allocationData;
+        if (allocationData.bIgnoreReferenceCountChanges) {
+            return;
+        }
+
+        if (pGcPtr->isRootNode()) {
+            // References from root nodes are not counted (found when unreferenced objects are deleted).
+            if (allocationData.bCollectingUnreferencedObjects && pNewAllocation != nullptr) {
+                allocationData.rootReferencedAllocations.insert(pNewAllocation);
+            }
+            return;
+        }
+
+        if (pNewAllocation != nullptr) {
+            auto& referenceCount = pNewAllocation->getReferenceCount();
+            if (pNewAllocation->getGarbageCollector() != this) [[unlikely]] {
+                referenceCount.bUnknown = true;
+            } else {
+                referenceCount.iCount += 1;
+            }
+        }
+
+        if (pOldAllocation != nullptr) {
+            auto& referenceCount = pOldAllocation->getReferenceCount();
+            if (pOldAllocation->getGarbageCollector() != this || referenceCount.iCount == 0) [[unlikely]] {
+                referenceCount.bUnknown = true;
+                return;
+            }
+
+            referenceCount.iCount -= 1;
+            if (referenceCount.iCount == 0) {
+                if (!referenceCount.bInZeroCountTable) {
+                    referenceCount.bInZeroCountTable = true;
+                    allocationData.vZeroCountAllocations.push_back(pOldAllocation);
+                }
+            } else if (!referenceCount.bPossibleCycleRoot) {
+                // Remaining references might come from a garbage cycle.
+                referenceCount.bPossibleCycleRoot = true;
+                allocationData.vPossibleCycleRoots.push_back(pOldAllocation);
+            }
+        }
+    }
+
+    void GarbageCollector::onAllocationConstructed(GcAllocation* pAllocation) {
+        auto& allocationData = mtxGcData.second.allocationData;
+
+        // Not referenced by other objects yet.
+        pAllocation->getReferenceCount().bInZeroCountTable = true;
+        allocationData.vZeroCountAllocations.push_back(pAllocation);
+
+        if (allocationData.bCollectingUnreferencedObjects) {
+            // Created in a destructor of a deleted object, referenced by `makeGc`'s pointer.
+            allocationData.rootReferencedAllocations.insert(pAllocation);
+            return;
+        }
+
+        // Process the table once it grows enough (objects referenced by root nodes stay in the table).
+        constexpr size_t iMinZeroCountAllocationsToProcess = 256; // NOLINT: seems like a good value
+        if (allocationData.vZeroCountAllocations.size() >=
+            std::max(
+                iMinZeroCountAllocationsToProcess, 2 * allocationData.iRetainedZeroCountAllocationCount)) {
+            deleteUnreferencedAllocations();
+        }
+
+        // Look for garbage cycles once enough objects lost references.
+        constexpr size_t iMinPossibleCycleRootsToProcess = 1024; // NOLINT: seems like a good value
+        if (allocationData.vPossibleCycleRoots.size() >= iMinPossibleCycleRootsToProcess) {
+            deleteUnreferencedCycles();
+        }
+    }
+
+    void GarbageCollector::recalculateReferenceCounts() {
+        auto& allocationData = mtxGcData.second.allocationData;
+
+        // Tables might reference deleted allocations.
+        allocationData.vZeroCountAllocations.clear();
+        allocationData.vPossibleCycleRoots.clear();
+
+        // Objects of thread-local garbage collectors might reference our objects.
+        const bool bCountsUnknown = !mtxGcData.second.vThreadLocalGarbageCollectors.empty();
+        for (const auto& pAllocation : allocationData.existingAllocations) {
+            pAllocation->getReferenceCount() = GcAllocation::ReferenceCount{.bUnknown = bCountsUnknown};
+        }
+        if (bCountsUnknown) {
+            allocationData.iRetainedZeroCountAllocationCount = 0;
+            return;
+        }
+
+        // Count references from GC pointers that are not root nodes.
+        const auto countReference = [this](const GcPtrBase* pGcPtr) {
+            if (pGcPtr->pAllocation != nullptr && pGcPtr->pAllocation->getGarbageCollector() == this) {
+                pGcPtr->pAllocation->getReferenceCount().iCount += 1;
+            }
+        };
+        for (const auto& pAllocation : allocationData.existingAllocations) {
+            forEachGcPtrOfAllocation(pAllocation, countReference);
+        }
+        for (const auto& pContainer : mtxGcData.second.rootNodes.gcContainerRootNodes) {
+            pContainer->getFunctionToIterateOverGcPtrItems()(pContainer, countReference);
+        }
+
+        // Fill the table.
+        for (const auto& pAllocation : allocationData.existingAllocations) {
+            if (pAllocation->getReferenceCount().iCount == 0) {
+                pAllocation->getReferenceCount().bInZeroCountTable = true;
+                allocationData.vZeroCountAllocations.push_back(pAllocation);
+            }
+        }
+        allocationData.iRetainedZeroCountAllocationCount = allocationData.vZeroCountAllocations.size();
+    }
+
+    size_t GarbageCollector::deleteUnreferencedAllocations() {
+        auto& allocationData = mtxGcData.second.allocationData;
+
+        if (!canDeleteUnreferencedAllocations()) {
+            return 0;
+        }
+
+        SGC_DEBUG_LOG("deleting unreferenced objects");
+
+        allocationData.bCollectingUnreferencedObjects = true;
+        findRootReferencedAllocations();
+
+        // Deleting an object might add objects referenced by it to the table.
+        size_t iDeletedObjectCount = 0;
+        std::vector<GcAllocation*> vRetainedAllocations;
+        auto& vZeroCountAllocations = allocationData.vZeroCountAllocations;
+        while (!vZeroCountAllocations.empty()) {
+            const auto pAllocation = vZeroCountAllocations.back(); // copy
+            vZeroCountAllocations.pop_back();
+
+            auto& referenceCount = pAllocation->getReferenceCount();
+            referenceCount.bInZeroCountTable = false;
+            if (referenceCount.iCount != 0 || referenceCount.bUnknown) {
+                // Referenced again.
+                continue;
+            }
+
+            if (allocationData.rootReferencedAllocations.contains(pAllocation)) {
+                vRetainedAllocations.push_back(pAllocation);
+                referenceCount.bInZeroCountTable = true;
+                continue;
+            }
+
+            if (referenceCount.bPossibleCycleRoot) {
+                std::erase(allocationData.vPossibleCycleRoots, pAllocation);
+            }
+
+            // Destructors of GC pointer fields update counts of referenced objects.
+            deleteAllocations({pAllocation});
+            iDeletedObjectCount += 1;
+        }
+        vZeroCountAllocations = std::move(vRetainedAllocations);
+        allocationData.iRetainedZeroCountAllocationCount = vZeroCountAllocations.size();
+
+        allocationData.rootReferencedAllocations.clear();
+        allocationData.bCollectingUnreferencedObjects = false;
+
+        SGC_DEBUG_LOG(std::format("deleted {} unreferenced object(s)", iDeletedObjectCount));
+
+        return iDeletedObjectCount;
+    }
+
+    size_t GarbageCollector::deleteUnreferencedCycles() {
+        auto& allocationData = mtxGcData.second.allocationData;
+
+        if (!canDeleteUnreferencedAllocations()) {
+            return 0;
+        }
+
+        SGC_DEBUG_LOG(std::format(
+            "running trial deletion from {} possible cycle root(s)",
+            allocationData.vPossibleCycleRoots.size()));
+
+        allocationData.bCollectingUnreferencedObjects = true;
+        findRootReferencedAllocations();
+
+        // Take possible roots.
+        std::vector<GcAllocation*> vAllocationsToProcess;
+        std::unordered_map<GcAllocation*, size_t> trialCounts;
+        for (const auto& pAllocation : allocationData.vPossibleCycleRoots) {
+            pAllocation->getReferenceCount().bPossibleCycleRoot = false;
+
+            // Zero count objects are processed by the table of zero count allocations.
+            if (pAllocation->getReferenceCount().iCount != 0 &&
+                trialCounts.emplace(pAllocation, pAllocation->getReferenceCount().iCount).second) {
+                vAllocationsToProcess.push_back(pAllocation);
+            }
+        }
+        allocationData.vPossibleCycleRoots.clear();
+
+        // Subtract references between reachable objects from their counts.
+        const auto isOurAllocation = [this](const GcPtrBase* pGcPtr) {
+            return pGcPtr->pAllocation != nullptr && pGcPtr->pAllocation->getGarbageCollector() == this;
+        };
+        while (!vAllocationsToProcess.empty()) {
+            const auto pAllocation = vAllocationsToProcess.back(); // copy
+            vAllocationsToProcess.pop_back();
+
+            forEachGcPtrOfAllocation(pAllocation, [&](const GcPtrBase* pGcPtr) {
+                if (!isOurAllocation(pGcPtr)) {
+                    return;
+                }
+
+                const auto [it, bInserted] =
+                    trialCounts.emplace(pGcPtr->pAllocation, pGcPtr->pAllocation->getReferenceCount().iCount);
+                if (bInserted) {
+                    vAllocationsToProcess.push_back(pGcPtr->pAllocation);
+                }
+                if (it->second != 0) {
+                    it->second -= 1;
+                }
+            });
+        }
+
+        // Objects that are still referenced from the outside are alive, so are objects reachable from them.
+        std::unordered_set<GcAllocation*> aliveAllocations;
+        for (const auto& [pAllocation, iTrialCount] : trialCounts) {
+            if ((iTrialCount != 0 || pAllocation->getReferenceCount().bUnknown ||
+                 allocationData.rootReferencedAllocations.contains(pAllocation)) &&
+                aliveAllocations.insert(pAllocation).second) {
+                vAllocationsToProcess.push_back(pAllocation);
+            }
+        }
+        while (!vAllocationsToProcess.empty()) {
+            const auto pAllocation = vAllocationsToProcess.back(); // copy
+            vAllocationsToProcess.pop_back();
+
+            forEachGcPtrOfAllocation(pAllocation, [&](const GcPtrBase* pGcPtr) {
+                if (isOurAllocation(pGcPtr) && trialCounts.contains(pGcPtr->pAllocation) &&
+                    aliveAllocations.insert(pGcPtr->pAllocation).second) {
+                    vAllocationsToProcess.push_back(pGcPtr->pAllocation);
+                }
+            });
+        }
+
+        // The rest are garbage cycles.
+        std::vector<GcAllocation*> vGarbage;
+        for (const auto& [pAllocation, iTrialCount] : trialCounts) {
+            if (!aliveAllocations.contains(pAllocation)) {
+                vGarbage.push_back(pAllocation);
+            }
+        }
+
+        // Garbage no longer references alive objects.
+        for (const auto& pAllocation : vGarbage) {
+            forEachGcPtrOfAllocation(pAllocation, [&](const GcPtrBase* pGcPtr) {
+                if (isOurAllocation(pGcPtr) && aliveAllocations.contains(pGcPtr->pAllocation)) {
+                    onReferenceChanged(pGcPtr, pGcPtr->pAllocation, nullptr);
+                }
+            });
+        }
+
+        // Delete garbage (references between garbage objects are no longer counted).
+        std::erase_if(allocationData.vZeroCountAllocations, [&](GcAllocation* pAllocation) {
+            return trialCounts.contains(pAllocation) && !aliveAllocations.contains(pAllocation);
+        });
+        allocationData.bIgnoreReferenceCountChanges = true;
+        deleteAllocations(vGarbage);
+        allocationData.bIgnoreReferenceCountChanges = false;
+
+        allocationData.rootReferencedAllocations.clear();
+        allocationData.bCollectingUnreferencedObjects = false;
+
+        SGC_DEBUG_LOG(std::format("trial deletion deleted {} object(s)", vGarbage.size()));
+
+        return vGarbage.size();
+    }
+
+    bool GarbageCollector::canDeleteUnreferencedAllocations() {
+        // Objects of thread-local garbage collectors might reference our objects and objects that are being
+        // constructed might not be referenced yet.
+        std::scoped_lock constructingGuard(mtxCurrentlyConstructingObjects.first);
+        return !mtxGcData.second.allocationData.bCollectingUnreferencedObjects &&
+               mtxGcData.second.vThreadLocalGarbageCollectors.empty() &&
+               mtxCurrentlyConstructingObjects.second.empty();
+    }
+
+    void GarbageCollector::findRootReferencedAllocations() {
+        // References from root nodes are not counted.
+        auto& rootReferencedAllocations = mtxGcData.second.allocationData.rootReferencedAllocations;
+        for (const auto& pGcPtr : mtxGcData.second.rootNodes.gcPtrRootNodes) {
+            if (pGcPtr->pAllocation != nullptr) {
+                rootReferencedAllocations.insert(pGcPtr->pAllocation);
+            }
+        }
+        for (const auto& pAllocation : findStackReferencedAllocations()) {
+            rootReferencedAllocations.insert(pAllocation);
+        }
+        for (const auto& [pBlock, block] : mtxGcData.second.allocationData.tracedMemoryBlocks) {
+            if (block.pOwner == nullptr) {
+                forEachGcPtrInTracedMemory(pBlock, block.iSizeInBytes, [&](const GcPtrBase* pGcPtr) {
+                    rootReferencedAllocations.insert(pGcPtr->pAllocation);
+                });
+            }
+        }
+    }
+
+    std::vector<GcAllocation*> GarbageCollector::findStackReferencedAllocations() {
+        const auto& existingAllocations = mtxGcData.second.allocationData.existingAllocations;
+
+        std::vector<GcAllocation*> vReferencedAllocations;
+        GcThreadStack::forEachRegisteredStack([&](const std::byte* pStack, size_t iStackSize) {
+            // Look at each properly aligned place of the stack as if a GC pointer was there (stack GC
+            // pointers store their allocation under our mutex and clear it using an atomic store when
+            // destroyed so the copy has either the old or the empty reference).
+            for (size_t iOffset = 0; iOffset + sizeof(GcPtrBase) <= iStackSize;
+                 iOffset += alignof(GcPtrBase)) {
+                const auto pGcPtr = reinterpret_cast<const GcPtrBase*>(pStack + iOffset);
+                if (!pGcPtr->isScannedNode() || pGcPtr->iGarbageCollectorId != iId) {
+                    continue;
+                }
+
+                // Make sure the value is a valid allocation (and not some other data that looks similar),
+                // the page map can't be used here because it maps object memory (not allocation records).
+                const auto pAllocation = pGcPtr->pAllocation.get();
+                if (pAllocation == nullptr || !existingAllocations.contains(pAllocation)) {
+                    continue;
+                }
+
+                vReferencedAllocations.push_back(pAllocation);
+            }
+        });
+
+        return vReferencedAllocations;
+    }
+
+    void GarbageCollector::deleteAllocations(const std::vector<GcAllocation*>& vAllocations) {
+        auto& allocationData = mtxGcData.second.allocationData;
+
+        // Remove from the "database" first.
+        for (const auto& pAllocation : vAllocations) {
+            SGC_DEBUG_LOG(std::format(
+                "deleting allocation with user object {}",
+                reinterpret_cast<uintptr_t>(pAllocation->getAllocatedObject())));
+
+            allocationData.existingAllocations.erase(pAllocation);
+            if (pAllocation->isInAllocationInfoRefs() &&
+                allocationData.allocationInfoRefs.erase(pAllocation->getAllocationInfo()) != 1) [[unlikely]] {
+                GcInfoCallbacks::getWarningCallback()(
+                    "GC allocation failed to find its allocation info (to be "
+                    "erased) in the array of existing allocation info objects");
+            }
+            pAllocation->removeFromPageMap();
+
+            if (!allocationData.ownedTracedMemoryBlocks.empty()) {
+                onTracedMemoryOwnerBeingDeleted(pAllocation);
+            }
+
+            pAllocation->markAsGarbage();
+        }
+
+        // Garbage objects might reference each other so free memory only after all destructors finished.
+        for (const auto& pAllocation : vAllocations) {
+            pAllocation->destroyObject();
+        }
+        for (const auto& pAllocation : vAllocations) {
+            delete pAllocation;
+        }
+    }
+
+    void GarbageCollector::forEachGcPtrOfAllocation(
+        GcAllocation* pAllocation, const std::function<void(const GcPtrBase*)>& onGcPtr) {
+        pAllocation->getTypeInfo()->forEachGcNodeField(
+            pAllocation->getAllocatedObject(), onGcPtr, [&onGcPtr](GcContainerBase* pContainer) {
+                pContainer->getFunctionToIterateOverGcPtrItems()(pContainer, onGcPtr);
+            });
+
+        const auto& ownedTracedMemoryBlocks = mtxGcData.second.allocationData.ownedTracedMemoryBlocks;
+        if (ownedTracedMemoryBlocks.empty()) {
+            return;
+        }
+        const auto blocksIt = ownedTracedMemoryBlocks.find(pAllocation);
+        if (blocksIt == ownedTracedMemoryBlocks.end()) {
+            return;
+        }
+        for (const auto& pBlock : blocksIt->second) {
+            forEachGcPtrInTracedMemory(
+                pBlock,
+                mtxGcData.second.allocationData.tracedMemoryBlocks.find(pBlock)->second.iSizeInBytes,
+                onGcPtr);
+        }
+    }
+
+    GcAllocation* GarbageCollector::findTracedMemoryOwner(const void* pOwnerObject) {
+        std::scoped_lock guard(mtxGcData.first);
+
+        // Same as GC pointers do.
+        const auto iObjectAddress = reinterpret_cast<uintptr_t>(pOwnerObject);
+        if (iObjectAddress < sizeof(GcAllocationInfo)) [[unlikely]] {
+            return nullptr;
+        }
+        const auto pAllocationInfo =
+            reinterpret_cast<GcAllocationInfo*>(iObjectAddress - sizeof(GcAllocationInfo));
+
+        const auto& allocationInfoRefs = mtxGcData.second.allocationData.allocationInfoRefs;
+        const auto allocationInfoIt = allocationInfoRefs.find(pAllocationInfo);
+        if (allocationInfoIt == allocationInfoRefs.end()) {
+            // Maybe a pointer to a non-primary base of the object.
+            return findAllocationContaining(pOwnerObject);
+        }
+
+        return allocationInfoIt->second;
+    }
+
+    void*
+    GarbageCollector::allocateTracedMemory(size_t iSizeInBytes, size_t iAlignment, GcAllocation* pOwner) {
+        // Zero the memory so that we don't find GC pointers in garbage left from previous use.
+        const auto pMemory =
+            static_cast<std::byte*>(::operator new(iSizeInBytes, std::align_val_t(iAlignment)));
+        std::memset(pMemory, 0, iSizeInBytes);
+
+        std::scoped_lock guard(mtxGcData.first);
+        auto& allocationData = mtxGcData.second.allocationData;
+
+        allocationData.tracedMemoryBlocks[pMemory] =
+            TracedMemoryBlock{.iSizeInBytes = iSizeInBytes, .pOwner = pOwner};
+        if (pOwner != nullptr) {
+            allocationData.ownedTracedMemoryBlocks[pOwner].push_back(pMemory);
+        }
+
+        return pMemory;
+    }
+
+    void GarbageCollector::freeTracedMemory(void* pMemory, size_t iSizeInBytes, size_t iAlignment) noexcept {
+        {
+            std::scoped_lock guard(mtxGcData.first);
+            auto& allocationData = mtxGcData.second.allocationData;
+
+            const auto blockIt = allocationData.tracedMemoryBlocks.find(static_cast<std::byte*>(pMemory));
+            if (blockIt == allocationData.tracedMemoryBlocks.end()) [[unlikely]] {
+                GcInfoCallbacks::getWarningCallback()(
+                    "failed to find memory of a tracing allocator that is being freed");
+            } else {
+                const auto pOwner = blockIt->second.pOwner;
+                allocationData.tracedMemoryBlocks.erase(blockIt);
+
+                if (pOwner != nullptr) {
+                    const auto ownerIt = allocationData.ownedTracedMemoryBlocks.find(pOwner);
+                    std::erase(ownerIt->second, static_cast<std::byte*>(pMemory));
+                    if (ownerIt->second.empty()) {
+                        allocationData.ownedTracedMemoryBlocks.erase(ownerIt);
+                    }
+                }
+            }
+        }
+
+        ::operator delete(pMemory, iSizeInBytes, std::align_val_t(iAlignment));
+    }
+
+    void GarbageCollector::onTracedMemoryOwnerBeingDeleted(GcAllocation* pAllocation) {
+        auto& allocationData = mtxGcData.second.allocationData;
+
+        // Memory that is still used after the owner's destructor (for example a container that was moved to a
+        // local variable) must be scanned as a root.
+        const auto ownerIt = allocationData.ownedTracedMemoryBlocks.find(pAllocation);
+        if (ownerIt == allocationData.ownedTracedMemoryBlocks.end()) {
+            return;
+        }
+
+        for (const auto& pBlock : ownerIt->second) {
+            allocationData.tracedMemoryBlocks.find(pBlock)->second.pOwner = nullptr;
+        }
+        allocationData.ownedTracedMemoryBlocks.erase(ownerIt);
+    }
+
+    void GarbageCollector::forEachGcPtrInTracedMemory(
+        const std::byte* pBlock, size_t iSizeInBytes, const std::function<void(const GcPtrBase*)>& onGcPtr) {
+        const auto& existingAllocations = mtxGcData.second.allocationData.existingAllocations;
+
+        // Look at each properly aligned place of the block as if a GC pointer was there (memory is zeroed on
+        // allocation and GC pointers clear their allocation when destroyed).
+        for (size_t iOffset = 0; iOffset + sizeof(GcPtrBase) <= iSizeInBytes; iOffset += alignof(GcPtrBase)) {
+            const auto pGcPtr = reinterpret_cast<const GcPtrBase*>(pBlock + iOffset);
+            if (pGcPtr->iGarbageCollectorId != iId || (pGcPtr->isRootNode() && !pGcPtr->isScannedNode())) {
+                continue;
+            }
+
+            // Make sure the value is a valid allocation (and not some other data that looks similar).
+            const auto pAllocation = pGcPtr->pAllocation.get();
+            if (pAllocation == nullptr || !existingAllocations.contains(pAllocation)) {
+                continue;
+            }
+
+            onGcPtr(pGcPtr);
+        }
+    }
 }
@@ -1,15 +1,49 @@
 #include "GcAllocation.h"
 
+// Standard.
+#include <new>
+#include <algorithm>
+
 // Custom.
+#include "GcVirtualMemory.h"
+#include "GcHeap.h"
+#include "GcRegionArena.h"
+#include "GcNursery.h"
+#include "GcPageTable.h"
+#include "GcAllocationRef.hpp"
+#if defined(SGC_COMPRESSED_REFERENCES)
+#include "GcAllocationTable.h"
+#endif
 #include "DebugLogger.hpp"
 
 namespace sgc {
 
-    GcAllocation::GcAllocation(void* pAllocatedMemory, GcTypeInfo* pTypeInfo)
-        : pAllocatedMemory(pAllocatedMemory), pTypeInfo(pTypeInfo) {
+#if !defined(SGC_COMPRESSED_REFERENCES)
+    static_assert(
+        alignof(GcAllocation) >= (size_t(1) << GcAllocationRef::iTagBitCount),
+        "low bits of references to allocations are used to store tags");
+#endif
+    static_assert(
+        sizeof(void*) != sizeof(uint64_t) || sizeof(GcAllocation) == 64, // NOLINT: one cache line
+        "allocation records should stay small");
+    static_assert(
+        GcNursery::iGranularity % GcPageTable::iGranularity == 0,
+        "memory blocks of the nursery are found using the page table");
+
+    GcAllocation::GcAllocation(
+        GarbageCollector* pGarbageCollector,
+        void* pAllocatedMemory,
+        void* pAllocatedObject,
+        GcTypeInfo* pTypeInfo,
+        MemorySource memorySource,
+        std::pmr::memory_resource* pMemoryResource)
+        : pGarbageCollector(pGarbageCollector),
+          memoryOwner(getMemoryOwner(pGarbageCollector, memorySource, pMemoryResource)),
+          pAllocatedMemory(pAllocatedMemory), pAllocatedObject(pAllocatedObject), pTypeInfo(pTypeInfo),
+          memorySource(memorySource) {
         // Get allocations info.
-        std::scoped_lock guard(GarbageCollector::get().mtxGcData.first);
-        auto& mtxAllocationsInfo = GarbageCollector::get().mtxGcData.second.allocationData;
+        std::scoped_lock guard(pGarbageCollector->mtxGcData.first);
+        auto& mtxAllocationsInfo = pGarbageCollector->mtxGcData.second.allocationData;
 
         SGC_DEBUG_LOG(std::format(
             "GcAllocation() with user object {} being constructed",
@@ -17,10 +51,22 @@ namespace sgc {
 
         // Add self and allocation info.
         mtxAllocationsInfo.existingAllocations.insert(this);
-        mtxAllocationsInfo.allocationInfoRefs[getAllocationInfo()] = this;
+        if (isInAllocationInfoRefs()) {
+            mtxAllocationsInfo.allocationInfoRefs[getAllocationInfo()] = this;
+        }
+        addToPageMap();
     }
 
     GcAllocation::~GcAllocation() {
+        SGC_DEBUG_LOG(std::format(
+            "GcAllocation() with user object {} being freed",
+            reinterpret_cast<uintptr_t>(getAllocatedObject())));
+
+        // Free the allocated memory.
+        freeMemory();
+    }
+
+    void GcAllocation::destroyObject() {
         SGC_DEBUG_LOG(std::format(
             "GcAllocation() with user object {} being destroyed",
             reinterpret_cast<uintptr_t>(getAllocatedObject())));
@@ -34,14 +80,271 @@ namespace sgc {
 
         // Call destructor on allocated object.
         pTypeInfo->getInvokeDestructor()(pAllocatedObject);
-
-        // Free the allocated memory.
-        ::operator delete(pAllocatedMemory);
     }
 
     GcTypeInfo* GcAllocation::getTypeInfo() const { return pTypeInfo; }
 
-    void* GcAllocation::getAllocatedObject() const {
-        return reinterpret_cast<char*>(pAllocatedMemory) + sizeof(GcAllocationInfo);
+#if defined(SGC_COMPRESSED_REFERENCES)
+    void* GcAllocation::operator new(size_t iSizeInBytes) {
+        return GcAllocationTable::allocate(iSizeInBytes);
+    }
+
+    void GcAllocation::operator delete(void* pMemory) { GcAllocationTable::free(pMemory); }
+#endif
+
+    void GcAllocation::moveToGarbageCollector(GarbageCollector* pNewGarbageCollector) {
+        auto& oldAllocationData = pGarbageCollector->mtxGcData.second.allocationData;
+        auto& newAllocationData = pNewGarbageCollector->mtxGcData.second.allocationData;
+
+        // Move self and allocation info.
+        oldAllocationData.existingAllocations.erase(this);
+        removeFromPageMap();
+        newAllocationData.existingAllocations.insert(this);
+        if (isInAllocationInfoRefs()) {
+            oldAllocationData.allocationInfoRefs.erase(getAllocationInfo());
+            newAllocationData.allocationInfoRefs[getAllocationInfo()] = this;
+        }
+
+        // Reference count was maintained by the old garbage collector (recalculated on the next collection).
+        if (referenceCount.bInZeroCountTable) {
+            std::erase(oldAllocationData.vZeroCountAllocations, this);
+            referenceCount.bInZeroCountTable = false;
+        }
+        if (referenceCount.bPossibleCycleRoot) {
+            std::erase(oldAllocationData.vPossibleCycleRoots, this);
+            referenceCount.bPossibleCycleRoot = false;
+        }
+        referenceCount.bUnknown = true;
+
+        if (memorySource == MemorySource::LARGE_OBJECT_SPACE) {
+            // Move mapped size.
+            const auto iMappingSize = GcVirtualMemory::roundUpToPageSize(getAllocatedMemorySize());
+            oldAllocationData.iLargeObjectSpaceSize -= iMappingSize;
+            newAllocationData.iLargeObjectSpaceSize += iMappingSize;
+        }
+
+        pGarbageCollector = pNewGarbageCollector;
+        addToPageMap();
+    }
+
+    bool GcAllocation::shouldRelocate(GcHeap* pCompactingHeap) const {
+        return memorySource == MemorySource::HEAP && memoryOwner.pHeap == pCompactingHeap && iPinCount == 0 &&
+               pTypeInfo->getInvokeRelocate() != nullptr && pCompactingHeap->isEvacuating(pAllocatedMemory);
+    }
+
+    void GcAllocation::relocateInHeap() {
+        auto& allocationInfoRefs = pGarbageCollector->mtxGcData.second.allocationData.allocationInfoRefs;
+
+        // Save old location.
+        const auto pOldMemory = pAllocatedMemory;
+        const auto pOldObject = pAllocatedObject;
+        const auto pOldAllocationInfo = getAllocationInfo();
+        const auto iObjectOffset = getObjectOffset(pTypeInfo->getTypeAlignment());
+
+        // Take a new slot (evacuating pages are not used for new slots).
+        pAllocatedMemory =
+            memoryOwner.pHeap->allocate(getAllocatedMemorySize(), pTypeInfo->getTypeAlignment());
+        pAllocatedObject = reinterpret_cast<char*>(pAllocatedMemory) + iObjectOffset;
+        memoryOwner.pHeap->setOwner(pAllocatedMemory, this);
+
+        // Move allocation info.
+        allocationInfoRefs.erase(pOldAllocationInfo);
+        new (getAllocationInfo()) GcAllocationInfo(*pOldAllocationInfo);
+        pOldAllocationInfo->~GcAllocationInfo();
+        allocationInfoRefs[getAllocationInfo()] = this;
+
+        {
+            // Fields of the new object belong to our garbage collector and are not root nodes.
+            GcScope scope(*pGarbageCollector);
+            GcAllocationConstructionGuard allocationGuard(this);
+
+            // Move the object.
+            pTypeInfo->getInvokeRelocate()(pAllocatedObject, pOldObject);
+        }
+
+        // Free the old slot.
+        memoryOwner.pHeap->free(pOldMemory);
+    }
+
+    void GcAllocation::removeFromPageMap() {
+        // Owners of heap slots are forgotten when the slot is freed.
+        if (memorySource == MemorySource::HEAP) {
+            return;
+        }
+
+        pGarbageCollector->mtxGcData.second.allocationData.pPageTable->remove(
+            pAllocatedMemory, getAllocatedMemorySize());
+    }
+
+    void GcAllocation::addToPageMap() {
+        if (memorySource == MemorySource::HEAP) {
+            memoryOwner.pHeap->setOwner(pAllocatedMemory, this);
+            return;
+        }
+
+        pGarbageCollector->mtxGcData.second.allocationData.pPageTable->add(
+            pAllocatedMemory, getAllocatedMemorySize(), this);
+    }
+
+    GcAllocation::MemoryOwner GcAllocation::getMemoryOwner(
+        GarbageCollector* pGarbageCollector,
+        MemorySource memorySource,
+        std::pmr::memory_resource* pMemoryResource) {
+        const auto& allocationData = pGarbageCollector->mtxGcData.second.allocationData;
+
+        switch (memorySource) {
+        case MemorySource::HEAP:
+            return MemoryOwner{.pHeap = allocationData.pHeap.get()};
+        case MemorySource::REGION:
+            return MemoryOwner{.pRegionArena = allocationData.pRegionArena.get()};
+        case MemorySource::NURSERY:
+            return MemoryOwner{.pNursery = allocationData.pNursery.get()};
+        case MemorySource::MEMORY_RESOURCE:
+            return MemoryOwner{.pMemoryResource = pMemoryResource};
+        case MemorySource::PROCESS_ALLOCATOR:
+        case MemorySource::LARGE_OBJECT_SPACE:
+            break;
+        }
+
+        return MemoryOwner{.pHeap = nullptr};
+    }
+
+    GcAllocation::MemorySource GcAllocation::pickMemorySource(
+        GarbageCollector* pGarbageCollector,
+        size_t iSizeInBytes,
+        size_t iAlignment,
+        std::pmr::memory_resource* pMemoryResource) {
+        if (pMemoryResource != nullptr) {
+            return MemorySource::MEMORY_RESOURCE;
+        }
+
+        std::scoped_lock guard(pGarbageCollector->mtxGcData.first);
+        const auto& allocationData = pGarbageCollector->mtxGcData.second.allocationData;
+
+        // Objects created inside of a region are bump-allocated.
+        if (allocationData.pRegionArena != nullptr &&
+            GcRegionArena::canAllocate(iSizeInBytes, getPageTableAlignment(iAlignment))) {
+            return MemorySource::REGION;
+        }
+
+        if (allocationData.bUseNursery && GcNursery::canAllocate(iSizeInBytes, iAlignment)) {
+            return MemorySource::NURSERY;
+        }
+
+        // Mappings are only aligned to the page size.
+        if (iSizeInBytes >= allocationData.iLargeObjectThreshold &&
+            iAlignment <= GcVirtualMemory::getPageSize()) {
+            return MemorySource::LARGE_OBJECT_SPACE;
+        }
+
+        if (GcHeap::canAllocate(iSizeInBytes, iAlignment)) {
+            return MemorySource::HEAP;
+        }
+
+        return MemorySource::PROCESS_ALLOCATOR;
+    }
+
+    void* GcAllocation::allocateMemory(
+        GarbageCollector* pGarbageCollector,
+        size_t iSizeInBytes,
+        size_t iAlignment,
+        MemorySource memorySource,
+        std::pmr::memory_resource* pMemoryResource) {
+        switch (memorySource) {
+        case MemorySource::HEAP: {
+            std::scoped_lock guard(pGarbageCollector->mtxGcData.first);
+            return pGarbageCollector->mtxGcData.second.allocationData.pHeap->allocate(
+                iSizeInBytes, iAlignment);
+        }
+        case MemorySource::LARGE_OBJECT_SPACE: {
+            // Give the object its own mapping.
+            const auto iMappingSize = GcVirtualMemory::roundUpToPageSize(iSizeInBytes);
+            const auto pMemory = GcVirtualMemory::allocatePages(iMappingSize);
+
+            std::scoped_lock guard(pGarbageCollector->mtxGcData.first);
+            pGarbageCollector->mtxGcData.second.allocationData.iLargeObjectSpaceSize += iMappingSize;
+
+            return pMemory;
+        }
+        case MemorySource::PROCESS_ALLOCATOR: {
+            if (getPageTableAlignment(iAlignment) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+                return ::operator new(iSizeInBytes, std::align_val_t{getPageTableAlignment(iAlignment)});
+            }
+
+            return ::operator new(iSizeInBytes);
+        }
+        case MemorySource::MEMORY_RESOURCE: {
+            return pMemoryResource->allocate(iSizeInBytes, getPageTableAlignment(iAlignment));
+        }
+        case MemorySource::REGION: {
+            std::scoped_lock guard(pGarbageCollector->mtxGcData.first);
+            return pGarbageCollector->mtxGcData.second.allocationData.pRegionArena->allocate(
+                iSizeInBytes, getPageTableAlignment(iAlignment));
+        }
+        case MemorySource::NURSERY: {
+            std::scoped_lock guard(pGarbageCollector->mtxGcData.first);
+            return pGarbageCollector->mtxGcData.second.allocationData.pNursery->allocate(iSizeInBytes);
+        }
+        }
+
+        throw std::bad_alloc(); // unreachable
+    }
+
+    size_t GcAllocation::getPageTableAlignment(size_t iAlignment) {
+        return std::max(iAlignment, GcPageTable::iGranularity);
+    }
+
+    size_t GcAllocation::getAllocatedMemorySize() const {
+        return getObjectOffset(pTypeInfo->getTypeAlignment()) + pTypeInfo->getTypeSize();
+    }
+
+    void GcAllocation::freeMemory() {
+        const auto pMemory = pAllocatedMemory;
+        const auto iSizeInBytes = getAllocatedMemorySize();
+        const auto iAlignment = pTypeInfo->getTypeAlignment();
+
+        switch (memorySource) {
+        case MemorySource::HEAP: {
+            // The heap is used while the mutex of its garbage collector is locked (the shared garbage
+            // collector locks mutexes of its thread-local garbage collectors while collecting garbage).
+            std::scoped_lock guard(pGarbageCollector->mtxGcData.first);
+            memoryOwner.pHeap->free(pMemory);
+            break;
+        }
+        case MemorySource::LARGE_OBJECT_SPACE: {
+            // Return the memory to the OS right away.
+            const auto iMappingSize = GcVirtualMemory::roundUpToPageSize(iSizeInBytes);
+            GcVirtualMemory::freePages(pMemory, iMappingSize);
+
+            std::scoped_lock guard(pGarbageCollector->mtxGcData.first);
+            pGarbageCollector->mtxGcData.second.allocationData.iLargeObjectSpaceSize -= iMappingSize;
+            break;
+        }
+        case MemorySource::PROCESS_ALLOCATOR: {
+            if (getPageTableAlignment(iAlignment) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+                ::operator delete(pMemory, std::align_val_t{getPageTableAlignment(iAlignment)});
+                break;
+            }
+
+            ::operator delete(pMemory);
+            break;
+        }
+        case MemorySource::MEMORY_RESOURCE: {
+            memoryOwner.pMemoryResource->deallocate(pMemory, iSizeInBytes, getPageTableAlignment(iAlignment));
+            break;
+        }
+        case MemorySource::REGION: {
+            // The memory is released all at once together with the region memory.
+            std::scoped_lock guard(pGarbageCollector->mtxGcData.first);
+            memoryOwner.pRegionArena->free(pMemory);
+            break;
+        }
+        case MemorySource::NURSERY: {
+            // The memory is reused (or the whole block is freed) once the garbage collection is finished.
+            std::scoped_lock guard(pGarbageCollector->mtxGcData.first);
+            memoryOwner.pNursery->free(pMemory, iSizeInBytes);
+            break;
+        }
+        }
     }
 }
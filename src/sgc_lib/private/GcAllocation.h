@@ -8,6 +8,10 @@
 #include "GcInfoCallbacks.hpp"
 
 namespace sgc {
+    class GcHeap;
+    class GcRegionArena;
+    class GcNursery;
+
     /** Manages GC allocated object/memory. */
     class GcAllocation {
     public:
@@ -19,10 +23,29 @@ namespace sgc {
         GcAllocation(GcAllocation&&) noexcept = delete;
         GcAllocation& operator=(GcAllocation&&) noexcept = delete;
 
+#if defined(SGC_COMPRESSED_REFERENCES)
         /**
-         * Calls destructor on the previously allocated object and deletes (frees) all allocated memory.
+         * Allocates memory for a GC allocation object in the allocation table (so that GC pointers
+         * can reference it using a compressed reference).
+         *
+         * @param iSizeInBytes Size of the object.
          *
-         * @remark Removes self and GC allocation info from the garbage collector's "database".
+         * @return Allocated memory.
+         */
+        static void* operator new(size_t iSizeInBytes);
+
+        /**
+         * Frees memory of a GC allocation object.
+         *
+         * @param pMemory Memory returned by `new`.
+         */
+        static void operator delete(void* pMemory);
+#endif
+
+        /**
+         * Frees all allocated memory.
+         *
+         * @warning Expects that @ref destroyObject was called.
          */
         ~GcAllocation();
 
@@ -36,19 +59,31 @@ namespace sgc {
          *
          * @remark Also calls constructor for the created object.
          *
-         * @param constructorArgs Arguments that will be passed to the type's constructor.
+         * @param pGarbageCollector Garbage collector to register the allocation in.
+         * @param constructorArgs   Arguments that will be passed to the type's constructor.
          *
          * @return Newly allocated memory.
          */
         template <typename Type, typename... ConstructorArgs>
-        static inline GcAllocation* registerNewAllocationWithInfo(ConstructorArgs&&... constructorArgs) {
+        static inline GcAllocation* registerNewAllocationWithInfo(
+            GarbageCollector* pGarbageCollector, ConstructorArgs&&... constructorArgs) {
             // Get type info.
             const auto pTypeInfo = GcTypeInfo::getStaticInfo<Type>();
 
+            // Calculate where the object will be located (right after the allocation info but aligned).
+            constexpr auto iObjectOffset = getObjectOffset(alignof(Type));
+            constexpr auto iAllocationSize = iObjectOffset + sizeof(Type);
+
+            // Pick where to allocate memory.
+            const auto pMemoryResource = pGarbageCollector->getMemoryResource();
+            const auto memorySource =
+                pickMemorySource(pGarbageCollector, iAllocationSize, alignof(Type), pMemoryResource);
+
             void* pAllocatedMemory = nullptr;
             try {
                 // Allocate memory for the allocation info and the object.
-                pAllocatedMemory = ::operator new(sizeof(GcAllocationInfo) + pTypeInfo->getTypeSize());
+                pAllocatedMemory = allocateMemory(
+                    pGarbageCollector, iAllocationSize, alignof(Type), memorySource, pMemoryResource);
             } catch (std::exception& exception) {
                 GcInfoCallbacks::getCriticalErrorCallback()(
                     "failed to allocate memory for a new GC controlled object");
@@ -56,23 +91,43 @@ namespace sgc {
             }
 
             // Create new allocation.
-            auto pAllocation = new GcAllocation(pAllocatedMemory, pTypeInfo);
+            auto pAllocation = new GcAllocation(
+                pGarbageCollector,
+                pAllocatedMemory,
+                reinterpret_cast<char*>(pAllocatedMemory) + iObjectOffset,
+                pTypeInfo,
+                memorySource,
+                pMemoryResource);
 
             // Call constructor on the allocation info (before running user type's constructor)
             // (using placement new operator to call constructor).
             new (pAllocation->getAllocationInfo()) GcAllocationInfo();
 
             {
-                // Add this allocation as being constructed and remove by the end of the scope.
-                GcAllocationConstructionGuard allocationGuard(pAllocation);
+                // Make sure fields of the new object belong to the allocation's garbage collector.
+                GcScope scope(*pGarbageCollector);
 
-                // Invoke object constructor on the allocated object memory.
-                new (pAllocation->getAllocatedObject())
-                    Type(std::forward<ConstructorArgs>(constructorArgs)...);
-            }
+                // Offsets of GC node fields are gathered while the first object of the type is constructed,
+                // make sure different garbage collectors don't do this simultaneously.
+                std::unique_lock typeInfoGuard(GcTypeInfo::getFieldOffsetsMutex(), std::defer_lock);
+                if (!pTypeInfo->bAllGcNodeFieldOffsetsInitialized) [[unlikely]] {
+                    typeInfoGuard.lock();
+                }
 
-            // GC node offsets are initialized (constructors of GC node objects register themselves).
-            pTypeInfo->bAllGcNodeFieldOffsetsInitialized = true;
+                {
+                    // Add this allocation as being constructed and remove by the end of the scope.
+                    GcAllocationConstructionGuard allocationGuard(pAllocation);
+
+                    // Invoke object constructor on the allocated object memory.
+                    new (pAllocation->getAllocatedObject())
+                        Type(std::forward<ConstructorArgs>(constructorArgs)...);
+                }
+
+                // GC node offsets are initialized (constructors of GC node objects register themselves).
+                if (typeInfoGuard.owns_lock()) [[unlikely]] {
+                    pTypeInfo->onAllGcNodeFieldOffsetsInitialized();
+                }
+            }
 
             return pAllocation;
         }
@@ -86,6 +141,134 @@ namespace sgc {
          */
         GcTypeInfo* getTypeInfo() const;
 
+        /**
+         * Moves this allocation from its current (thread-local) garbage collector to the specified
+         * (shared) garbage collector.
+         *
+         * @warning Expects that mutexes of both garbage collectors are locked.
+         *
+         * @param pNewGarbageCollector Garbage collector that the allocation will belong to.
+         */
+        void moveToGarbageCollector(GarbageCollector* pNewGarbageCollector);
+
+        /**
+         * Tells if the object should be moved to another heap slot by @ref relocateInHeap.
+         *
+         * @param pCompactingHeap Heap that is being compacted.
+         *
+         * @return `true` if allocated in an evacuating page of the specified heap, not pinned and the
+         * type is nothrow move constructible.
+         */
+        bool shouldRelocate(GcHeap* pCompactingHeap) const;
+
+        /**
+         * Moves the object (and its allocation info) to a new slot of the same heap (used by heap
+         * compaction), GC pointers to this allocation stay valid but raw pointers to the old object
+         * become dangling.
+         *
+         * @warning Expects that the mutex of the allocation's garbage collector is locked and
+         * @ref shouldRelocate is `true`.
+         */
+        void relocateInHeap();
+
+        /**
+         * Forbids moving the object during heap compaction (see @ref GcPin).
+         *
+         * @warning Expects that the mutex of the allocation's garbage collector is locked.
+         */
+        inline void pin() { iPinCount += 1; }
+
+        /**
+         * Undoes a previous @ref pin call.
+         *
+         * @remark Does nothing if the allocation is garbage (pins of garbage are dropped when the
+         * garbage collector starts deleting it, see @ref markAsGarbage).
+         *
+         * @warning Expects that the mutex of the allocation's garbage collector is locked.
+         */
+        inline void unpin() {
+            if (bIsGarbage) {
+                return;
+            }
+            iPinCount -= 1;
+        }
+
+        /**
+         * Called by the garbage collector on all allocations that it's about to delete before calling
+         * destructors of their objects (destructors of garbage objects might unpin other garbage).
+         *
+         * @warning Expects that the mutex of the allocation's garbage collector is locked.
+         */
+        inline void markAsGarbage() {
+            bIsGarbage = true;
+            iPinCount = 0;
+        }
+
+        /**
+         * Calls destructor on the allocated object (the memory is freed in the destructor of this
+         * allocation).
+         */
+        void destroyObject();
+
+        /**
+         * Tells if the allocation is registered in `allocationInfoRefs` of its garbage collector.
+         *
+         * @return `false` for allocations in the nursery (found using the page table), `true` otherwise.
+         */
+        inline bool isInAllocationInfoRefs() const { return memorySource != MemorySource::NURSERY; }
+
+        /**
+         * Tells if the specified address points to a byte of the allocated object.
+         *
+         * @param pAddress Address to check.
+         *
+         * @return `true` if the address is inside of the object, `false` otherwise.
+         */
+        inline bool containsAddress(const void* pAddress) const {
+            const auto iAddress = reinterpret_cast<uintptr_t>(pAddress);
+            const auto iObjectAddress = reinterpret_cast<uintptr_t>(pAllocatedObject);
+            return iAddress >= iObjectAddress && iAddress - iObjectAddress < pTypeInfo->getTypeSize();
+        }
+
+        /**
+         * Removes the allocation from the page table of its garbage collector (see
+         * `GarbageCollector::findAllocationContaining`).
+         *
+         * @warning Expects that the mutex of the allocation's garbage collector is locked.
+         */
+        void removeFromPageMap();
+
+        /** Reference counting data (used if enabled in the garbage collector). */
+        struct ReferenceCount {
+            /** Number of GC pointers that are not root nodes and reference this allocation. */
+            size_t iCount = 0;
+
+            /** `true` if references from GC pointers of other garbage collectors were found. */
+            bool bUnknown = false;
+
+            /** `true` if stored in the garbage collector's table of zero count allocations. */
+            bool bInZeroCountTable = false;
+
+            /** `true` if stored in the garbage collector's possible roots of garbage cycles. */
+            bool bPossibleCycleRoot = false;
+        };
+
+        /**
+         * Returns reference counting data of this allocation.
+         *
+         * @warning Expects that the mutex of the allocation's garbage collector is locked.
+         *
+         * @return Reference counting data.
+         */
+        inline ReferenceCount& getReferenceCount() { return referenceCount; }
+
+        /**
+         * Returns garbage collector that this allocation belongs to.
+         *
+         * @return Garbage collector.
+         */
+        inline GarbageCollector* getGarbageCollector() const { return pGarbageCollector; }
+
         /**
          * Returns allocation info from @ref pAllocatedMemory.
          *
@@ -94,7 +277,8 @@ namespace sgc {
          * @return Allocation info, always valid while this GC allocation object is alive.
          */
         inline GcAllocationInfo* getAllocationInfo() const {
-            return reinterpret_cast<GcAllocationInfo*>(pAllocatedMemory);
+            return reinterpret_cast<GcAllocationInfo*>(
+                reinterpret_cast<char*>(pAllocatedObject) - sizeof(GcAllocationInfo));
         }
 
         /**
@@ -105,26 +289,187 @@ namespace sgc {
          * @return Pointer to the allocated user object, always valid while this GC allocation object is
          * alive.
          */
-        void* getAllocatedObject() const;
+        inline void* getAllocatedObject() const { return pAllocatedObject; }
 
     private:
+        /** Defines where memory of an allocation was allocated. */
+        enum class MemorySource : unsigned char {
+            HEAP,               ///< GC heap for small objects.
+            PROCESS_ALLOCATOR,  ///< `operator new`.
+            LARGE_OBJECT_SPACE, ///< Separate mapping per allocation.
+            MEMORY_RESOURCE,    ///< User-specified `std::pmr::memory_resource`.
+            REGION,             ///< Bump-pointer memory of a @ref GcRegion.
+            NURSERY,            ///< Bump-pointer blocks of the garbage collector's nursery.
+        };
+
+        /**
+         * Memory that @ref pAllocatedMemory was allocated from (only sources that need to know about
+         * freed memory are stored).
+         */
+        union MemoryOwner {
+            /**
+             * Heap of the garbage collector that created this allocation (if @ref memorySource is
+             * @ref MemorySource::HEAP).
+             */
+            GcHeap* pHeap;
+
+            /** Region memory (if @ref memorySource is @ref MemorySource::REGION). */
+            GcRegionArena* pRegionArena;
+
+            /** Nursery (if @ref memorySource is @ref MemorySource::NURSERY). */
+            GcNursery* pNursery;
+
+            /** Memory resource (if @ref memorySource is @ref MemorySource::MEMORY_RESOURCE). */
+            std::pmr::memory_resource* pMemoryResource;
+        };
+
+        /**
+         * Returns memory that memory of a new allocation was allocated from.
+         *
+         * @param pGarbageCollector Garbage collector that creates the allocation.
+         * @param memorySource      Where the memory was allocated.
+         * @param pMemoryResource   Memory resource that the memory was allocated from (if the memory source
+         * is @ref MemorySource::MEMORY_RESOURCE).
+         *
+         * @return Memory owner.
+         */
+        static MemoryOwner getMemoryOwner(
+            GarbageCollector* pGarbageCollector,
+            MemorySource memorySource,
+            std::pmr::memory_resource* pMemoryResource);
+
+        /**
+         * Makes the allocation findable by a pointer to any byte of its object (see
+         * `GarbageCollector::findAllocationContaining`).
+         *
+         * @warning Expects that the mutex of the allocation's garbage collector is locked.
+         */
+        void addToPageMap();
+
         /**
          * Allocates a new GC controlled object.
          *
          * @remark Adds self and GC allocation info to the garbage collector's "database".
          *
+         * @param pGarbageCollector Garbage collector that the allocation belongs to.
          * @param pAllocatedMemory Pointer to the allocated memory that stores allocation info and the
          * allocated object.
+         * @param pAllocatedObject Pointer to the (not constructed yet) user object in the allocated memory.
          * @param pTypeInfo        User-specified type of this allocation.
+         * @param memorySource     Where the memory was allocated.
+         * @param pMemoryResource  Memory resource that the memory was allocated from (if the memory source
+         * is @ref MemorySource::MEMORY_RESOURCE).
+         */
+        GcAllocation(
+            GarbageCollector* pGarbageCollector,
+            void* pAllocatedMemory,
+            void* pAllocatedObject,
+            GcTypeInfo* pTypeInfo,
+            MemorySource memorySource,
+            std::pmr::memory_resource* pMemoryResource);
+
+        /**
+         * Returns offset from the start of the allocated memory to the user object.
+         *
+         * @remark The allocation info is always located right before the user object, padding (if needed)
+         * is located before the allocation info: [padding][GcAllocationInfo][object].
+         *
+         * @param iTypeAlignment Alignment of the user-specified type (power of 2).
+         *
+         * @return Offset in bytes.
+         */
+        static constexpr size_t getObjectOffset(size_t iTypeAlignment) {
+            return (sizeof(GcAllocationInfo) + iTypeAlignment - 1) & ~(iTypeAlignment - 1);
+        }
+
+        /**
+         * Picks where to allocate memory of the specified size.
+         *
+         * @remark If a memory resource is specified everything is allocated from it, otherwise small
+         * allocations go to the GC heap, large objects get their own page-aligned mapping (so that their
+         * memory is returned to the OS as soon as they are deleted) and everything in between is allocated
+         * using `operator new`.
+         *
+         * @param pGarbageCollector Garbage collector that the allocation will belong to.
+         * @param iSizeInBytes      Size of the memory to allocate.
+         * @param iAlignment        Alignment of the user object (power of 2).
+         * @param pMemoryResource   User-specified memory resource (might be `nullptr`).
+         *
+         * @return Memory source to use.
          */
-        GcAllocation(void* pAllocatedMemory, GcTypeInfo* pTypeInfo);
+        static MemorySource pickMemorySource(
+            GarbageCollector* pGarbageCollector,
+            size_t iSizeInBytes,
+            size_t iAlignment,
+            std::pmr::memory_resource* pMemoryResource);
+
+        /**
+         * Allocates memory for a new GC allocation.
+         *
+         * @param pGarbageCollector Garbage collector that the allocation will belong to.
+         * @param iSizeInBytes      Size of the memory to allocate.
+         * @param iAlignment        Alignment of the user object (power of 2), if exceeds the default
+         * alignment of `operator new` an over-aligned allocation is made.
+         * @param memorySource      Result of @ref pickMemorySource.
+         * @param pMemoryResource   Memory resource to use if the memory source is
+         * @ref MemorySource::MEMORY_RESOURCE.
+         *
+         * @return Allocated memory, the start of the memory is aligned to the specified alignment.
+         */
+        static void* allocateMemory(
+            GarbageCollector* pGarbageCollector,
+            size_t iSizeInBytes,
+            size_t iAlignment,
+            MemorySource memorySource,
+            std::pmr::memory_resource* pMemoryResource);
+
+        /** Frees @ref pAllocatedMemory (allocated by @ref allocateMemory). */
+        void freeMemory();
+
+        /**
+         * Returns size of @ref pAllocatedMemory.
+         *
+         * @return Size in bytes.
+         */
+        size_t getAllocatedMemorySize() const;
+
+        /**
+         * Returns alignment to allocate memory with for memory sources that are not aligned to the
+         * granularity of the garbage collector's page table (used to find objects that are not in a
+         * GC heap) by themselves.
+         *
+         * @param iAlignment Alignment of the memory block.
+         *
+         * @return Alignment that is not smaller than the specified one.
+         */
+        static size_t getPageTableAlignment(size_t iAlignment);
+
+        /**
+         * Garbage collector that this allocation belongs to.
+         *
+         * @remark Initialized in constructor, only changed when the allocation is promoted from
+         * a thread-local garbage collector to its shared garbage collector.
+         */
+        GarbageCollector* pGarbageCollector = nullptr;
+
+        /** Memory that @ref pAllocatedMemory was allocated from (depends on @ref memorySource). */
+        const MemoryOwner memoryOwner;
 
         /**
          * Pointer to the allocated memory that stores allocation info and the allocated object.
          *
-         * @remark Initialized in constructor, always valid while this GC allocation object is alive.
+         * @remark Initialized in constructor, always valid while this GC allocation object is alive
+         * (changed when the object is moved by heap compaction).
          */
-        void* const pAllocatedMemory = nullptr;
+        void* pAllocatedMemory = nullptr;
+
+        /**
+         * Pointer to the allocated user object (located inside of @ref pAllocatedMemory).
+         *
+         * @remark Initialized in constructor, always valid while this GC allocation object is alive
+         * (changed when the object is moved by heap compaction).
+         */
+        void* pAllocatedObject = nullptr;
 
         /**
          * User-specified type of this allocation.
@@ -132,5 +477,17 @@ namespace sgc {
          * @remark Initialized in constructor, always valid because points to a static variable.
          */
         GcTypeInfo* const pTypeInfo = nullptr;
+
+        /** Reference counting data (used if enabled in the garbage collector). */
+        ReferenceCount referenceCount;
+
+        /** Number of active pins, pinned objects are not moved by heap compaction. */
+        uint32_t iPinCount = 0;
+
+        /** Defines where @ref pAllocatedMemory was allocated. */
+        MemorySource const memorySource = MemorySource::PROCESS_ALLOCATOR;
+
+        /** `true` if the garbage collector is deleting this allocation (see @ref markAsGarbage). */
+        bool bIsGarbage = false;
     };
 }
@@ -2,13 +2,19 @@
 
 // Custom.
 #include "GarbageCollector.h"
+#include "GcAllocation.h"
 #include "GcInfoCallbacks.hpp"
 
 namespace sgc {
+    thread_local GcAllocationConstructionGuard* GcAllocationConstructionGuard::pCurrentGuard = nullptr;
+
     GcAllocationConstructionGuard::GcAllocationConstructionGuard(GcAllocation* pAllocation)
-        : pAllocation(pAllocation) {
+        : pAllocation(pAllocation), pGarbageCollector(pAllocation->getGarbageCollector()),
+          pPreviousGuard(pCurrentGuard) {
+        pCurrentGuard = this;
+
         // Get array of creating objects.
-        auto& mtxCreatingObjects = GarbageCollector::get().mtxCurrentlyConstructingObjects;
+        auto& mtxCreatingObjects = pGarbageCollector->mtxCurrentlyConstructingObjects;
 
         std::scoped_lock guard(mtxCreatingObjects.first);
 
@@ -17,8 +23,9 @@ namespace sgc {
     }
 
     GcAllocationConstructionGuard::~GcAllocationConstructionGuard() {
+        pCurrentGuard = pPreviousGuard;
         // Get array of creating objects.
-        auto& mtxCreatingObjects = GarbageCollector::get().mtxCurrentlyConstructingObjects;
+        auto& mtxCreatingObjects = pGarbageCollector->mtxCurrentlyConstructingObjects;
 
         std::scoped_lock guard(mtxCreatingObjects.first);
 
@@ -41,4 +48,13 @@ namespace sgc {
             "failed to find previously added allocation in the array of currently constructing objects");
         // don't throw in destructor
     }
+
+    GcAllocation* GcAllocationConstructionGuard::getConstructingAllocation(const void* pObjectPart) {
+        const auto pGuard = pCurrentGuard;
+        if (pGuard == nullptr || !pGuard->pAllocation->containsAddress(pObjectPart)) {
+            return nullptr;
+        }
+
+        return pGuard->pAllocation;
+    }
 }
@@ -2,6 +2,7 @@
 
 namespace sgc {
     class GcAllocation;
+    class GarbageCollector;
 
     /**
      * RAII-style object used while calling allocated object constructor.
@@ -24,6 +25,17 @@ namespace sgc {
 
         ~GcAllocationConstructionGuard();
 
+        /**
+         * Returns allocation which object is being constructed by the current thread if the specified
+         * address belongs to the object (for example `this` of a base type or a field of the object).
+         *
+         * @param pObjectPart Address to check.
+         *
+         * @return `nullptr` if the current thread is not constructing an object that contains the address,
+         * otherwise allocation of the innermost object that is being constructed.
+         */
+        static GcAllocation* getConstructingAllocation(const void* pObjectPart);
+
     private:
         /**
          * Constructors a new object.
@@ -34,5 +46,17 @@ namespace sgc {
 
         /** Allocation that uses this object. */
         GcAllocation* const pAllocation = nullptr;
+
+        /**
+         * Garbage collector that the allocation belonged to when this object was created (the allocation
+         * might be promoted to another garbage collector while being constructed).
+         */
+        GarbageCollector* const pGarbageCollector = nullptr;
+
+        /** Object that was created by the current thread before this one (`nullptr` if none). */
+        GcAllocationConstructionGuard* const pPreviousGuard = nullptr;
+
+        /** Innermost object created by the current thread (`nullptr` if none). */
+        static thread_local GcAllocationConstructionGuard* pCurrentGuard;
     };
 }
@@ -13,6 +13,9 @@ namespace sgc {
      * imagine flat memory: [...sizeof(GcAllocationInfo)sizeof(T)...]. This way our GC pointers can
      * operate on raw pointers but also keep track of GC allocation states (accessing allocation info by just
      * subtracting sizeof(GcAllocationInfo) from the raw pointer).
+     *
+     * @remark If the user-specified type requires alignment, padding is inserted before the allocation
+     * info (not between the info and the object): [...padding|sizeof(GcAllocationInfo)|sizeof(T)...].
      */
     struct GcAllocationInfo {
         GcAllocationInfo() = default;
@@ -0,0 +1,140 @@
+#pragma once
+
+// Standard.
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Custom.
+#if defined(SGC_COMPRESSED_REFERENCES)
+#include "GcAllocationTable.h"
+#endif
+
+namespace sgc {
+    class GcAllocation;
+
+    /**
+     * Reference to a GC allocation stored in GC pointers, behaves like a raw pointer.
+     *
+     * @remark When `SGC_COMPRESSED_REFERENCES` is defined stores a 32-bit offset into the allocation
+     * table (see @ref GcAllocationTable) instead of a full pointer.
+     *
+     * @remark Low bits of the stored reference are always zero (allocation objects are aligned) and
+     * can store a small tag (see `GcTaggedPtr`), the tag is masked off when the allocation is returned
+     * and is kept when a different allocation is referenced.
+     */
+    class GcAllocationRef {
+    public:
+#if defined(SGC_COMPRESSED_REFERENCES)
+        /** Number of low bits of the stored reference that can store a tag. */
+        static constexpr size_t iTagBitCount = GcAllocationTable::iZeroLowBitCount;
+#else
+        /** Number of low bits of the stored reference that can store a tag. */
+        static constexpr size_t iTagBitCount = 3; // allocation objects are aligned to at least 8 bytes
+#endif
+
+        GcAllocationRef() = default;
+
+        /**
+         * Creates a reference to the specified allocation.
+         *
+         * @param pAllocation Allocation to reference (might be `nullptr`).
+         */
+        GcAllocationRef(GcAllocation* pAllocation) { set(pAllocation); } // NOLINT: behaves like a pointer
+
+        /**
+         * Makes this object reference the specified allocation.
+         *
+         * @param pAllocation Allocation to reference (might be `nullptr`).
+         *
+         * @return This object.
+         */
+        inline GcAllocationRef& operator=(GcAllocation* pAllocation) {
+            set(pAllocation);
+            return *this;
+        }
+
+        /**
+         * Returns referenced allocation.
+         *
+         * @return `nullptr` if empty, otherwise allocation.
+         */
+        inline GcAllocation* get() const {
+#if defined(SGC_COMPRESSED_REFERENCES)
+            return static_cast<GcAllocation*>(GcAllocationTable::decompress(iReference & ~iTagMask));
+#else
+            return reinterpret_cast<GcAllocation*>(iReference & ~iTagMask);
+#endif
+        }
+
+        /**
+         * Returns referenced allocation.
+         *
+         * @return `nullptr` if empty, otherwise allocation.
+         */
+        inline operator GcAllocation*() const { return get(); } // NOLINT: behaves like a pointer
+
+        /**
+         * Accesses referenced allocation.
+         *
+         * @return Allocation.
+         */
+        inline GcAllocation* operator->() const { return get(); }
+
+        /**
+         * Returns tag stored in low bits of the reference.
+         *
+         * @return Tag (0 if never set).
+         */
+        inline size_t getTag() const { return static_cast<size_t>(iReference & iTagMask); }
+
+        /**
+         * Makes the reference empty (the tag is kept) using a single atomic store so that a thread that
+         * reads the reference at the same time sees either the previous or the empty reference.
+         */
+        inline void clearAtomically() {
+            std::atomic_ref<StoredReference>(iReference).store(
+                iReference & iTagMask, std::memory_order_relaxed);
+        }
+
+        /**
+         * Stores the specified tag in low bits of the reference (the referenced allocation is not changed).
+         *
+         * @param iTag Tag, only the lowest @ref iTagBitCount bits are stored.
+         */
+        inline void setTag(size_t iTag) {
+            iReference = (iReference & ~iTagMask) | (static_cast<StoredReference>(iTag) & iTagMask);
+        }
+
+    private:
+#if defined(SGC_COMPRESSED_REFERENCES)
+        /** Type of the stored reference. */
+        using StoredReference = uint32_t;
+#else
+        /** Type of the stored reference. */
+        using StoredReference = uintptr_t;
+#endif
+
+        /** Bits of the stored reference that store a tag. */
+        static constexpr StoredReference iTagMask = (StoredReference(1) << iTagBitCount) - 1;
+
+        /**
+         * Makes this object reference the specified allocation.
+         *
+         * @param pAllocation Allocation to reference (might be `nullptr`).
+         */
+        inline void set(GcAllocation* pAllocation) {
+#if defined(SGC_COMPRESSED_REFERENCES)
+            iReference = GcAllocationTable::compress(pAllocation) | (iReference & iTagMask);
+#else
+            iReference = reinterpret_cast<StoredReference>(pAllocation) | (iReference & iTagMask);
+#endif
+        }
+
+        /**
+         * Compressed pointer (offset into the allocation table) or pointer to the referenced allocation
+         * (0 if empty) with a tag in low bits.
+         */
+        StoredReference iReference = 0;
+    };
+}
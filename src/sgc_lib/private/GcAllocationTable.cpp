@@ -0,0 +1,77 @@
+#include "GcAllocationTable.h"
+
+#if defined(SGC_COMPRESSED_REFERENCES)
+
+// Standard.
+#include <new>
+#include <stdexcept>
+
+// Custom.
+#include "GcVirtualMemory.h"
+#include "GcInfoCallbacks.hpp"
+
+namespace sgc {
+
+    static_assert(sizeof(void*) == sizeof(uint64_t), "compressed references require a 64-bit build");
+
+    void* GcAllocationTable::allocate(size_t iSizeInBytes) {
+        auto& mtxTableData = getTableData();
+        std::scoped_lock guard(mtxTableData.first);
+        auto& tableData = mtxTableData.second;
+
+        if (pTableStart == nullptr) {
+            // Reserve the whole range once, memory is committed on demand.
+            pTableStart = static_cast<std::byte*>(
+                GcVirtualMemory::reservePages(iReservedSize, GcVirtualMemory::getPageSize()));
+
+            // Offset 0 is used for `nullptr`.
+            tableData.pFirstUntouched = pTableStart + iSlotAlignment;
+            tableData.pCommittedEnd = pTableStart;
+            tableData.iSlotSize = (iSizeInBytes + (iSlotAlignment - 1)) & ~(iSlotAlignment - 1);
+        }
+
+        if (iSizeInBytes > tableData.iSlotSize) [[unlikely]] {
+            GcInfoCallbacks::getCriticalErrorCallback()(
+                "all objects in the GC allocation table are expected to have the same size");
+            throw std::runtime_error("critical error");
+        }
+
+        // Reuse a freed slot.
+        if (tableData.pFreeSlots != nullptr) {
+            const auto pSlot = tableData.pFreeSlots;
+            tableData.pFreeSlots = *reinterpret_cast<void**>(pSlot);
+            return pSlot;
+        }
+
+        // Take a new slot.
+        const auto pSlot = tableData.pFirstUntouched;
+        if (pSlot + tableData.iSlotSize > pTableStart + iReservedSize) [[unlikely]] {
+            throw std::bad_alloc();
+        }
+        while (pSlot + tableData.iSlotSize > tableData.pCommittedEnd) {
+            GcVirtualMemory::commitPages(tableData.pCommittedEnd, iCommitSize);
+            tableData.pCommittedEnd += iCommitSize;
+        }
+        tableData.pFirstUntouched += tableData.iSlotSize;
+
+        return pSlot;
+    }
+
+    void GcAllocationTable::free(void* pMemory) {
+        auto& mtxTableData = getTableData();
+        std::scoped_lock guard(mtxTableData.first);
+
+        *reinterpret_cast<void**>(pMemory) = mtxTableData.second.pFreeSlots;
+        mtxTableData.second.pFreeSlots = pMemory;
+    }
+
+    std::pair<std::mutex, GcAllocationTable::TableData>& GcAllocationTable::getTableData() {
+        // The reserved range is never released because allocation objects can be deleted in destructors
+        // of static objects.
+        static std::pair<std::mutex, TableData> mtxTableData;
+        return mtxTableData;
+    }
+
+}
+
+#endif
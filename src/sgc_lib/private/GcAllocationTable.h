@@ -0,0 +1,118 @@
+#pragma once
+
+#if defined(SGC_COMPRESSED_REFERENCES)
+
+// Standard.
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+namespace sgc {
+    /**
+     * Stores GC allocation objects in a single reserved range of virtual memory so that references
+     * to them can be stored as 32-bit scaled offsets from the start of the range (used when
+     * `SGC_COMPRESSED_REFERENCES` is defined).
+     *
+     * @remark Thread-safe.
+     */
+    class GcAllocationTable {
+    public:
+        /** Offsets of slots from the start of the table are stored divided by this value. */
+        static constexpr size_t iOffsetScale = 8; // NOLINT
+
+        /**
+         * Number of low bits of compressed references that are always zero since slots are aligned
+         * to @ref iSlotAlignment (used to store tags of `GcTaggedPtr`).
+         */
+        static constexpr size_t iZeroLowBitCount = 2;
+
+        /** Alignment in bytes of slots in the table. */
+        static constexpr size_t iSlotAlignment = iOffsetScale << iZeroLowBitCount;
+
+        /** Size in bytes of the reserved range (maximum offset that fits into 32 bits). */
+        static constexpr size_t iReservedSize = (size_t(1) << 32) * iOffsetScale; // NOLINT
+
+        /** Size in bytes of memory committed at once when the table grows. */
+        static constexpr size_t iCommitSize = 64 * 1024; // NOLINT
+
+        GcAllocationTable() = delete;
+
+        /**
+         * Allocates a slot for a GC allocation object.
+         *
+         * @remark Throws `std::bad_alloc` if failed.
+         *
+         * @param iSizeInBytes Size of the object (all objects allocated in the table must have the
+         * same size).
+         *
+         * @return Memory for the object (aligned to @ref iSlotAlignment).
+         */
+        static void* allocate(size_t iSizeInBytes);
+
+        /**
+         * Frees a slot previously returned by @ref allocate.
+         *
+         * @param pMemory Allocated memory.
+         */
+        static void free(void* pMemory);
+
+        /**
+         * Converts a pointer to a slot in the table into a 32-bit reference.
+         *
+         * @param pMemory Pointer returned by @ref allocate (or `nullptr`).
+         *
+         * @return Compressed reference (0 for `nullptr`).
+         */
+        static inline uint32_t compress(const void* pMemory) {
+            if (pMemory == nullptr) {
+                return 0;
+            }
+            return static_cast<uint32_t>(
+                static_cast<size_t>(reinterpret_cast<const std::byte*>(pMemory) - pTableStart) /
+                iOffsetScale);
+        }
+
+        /**
+         * Converts a 32-bit reference created by @ref compress back to a pointer.
+         *
+         * @param iCompressed Compressed reference.
+         *
+         * @return Pointer to a slot in the table (or `nullptr`).
+         */
+        static inline void* decompress(uint32_t iCompressed) {
+            if (iCompressed == 0) {
+                return nullptr;
+            }
+            return pTableStart + static_cast<size_t>(iCompressed) * iOffsetScale;
+        }
+
+    private:
+        /** Groups data used to allocate slots. */
+        struct TableData {
+            /** Start of the memory that was never used. */
+            std::byte* pFirstUntouched = nullptr;
+
+            /** End of committed memory. */
+            std::byte* pCommittedEnd = nullptr;
+
+            /** First freed slot (freed slots store a pointer to the next freed slot). */
+            void* pFreeSlots = nullptr;
+
+            /** Size in bytes of a slot (size of the first allocated object). */
+            size_t iSlotSize = 0;
+        };
+
+        /**
+         * Returns slot allocation data.
+         *
+         * @return Mutex and data.
+         */
+        static std::pair<std::mutex, TableData>& getTableData();
+
+        /** Start of the reserved range (`nullptr` until the first allocation). */
+        static inline std::byte* pTableStart = nullptr;
+    };
+}
+
+#endif
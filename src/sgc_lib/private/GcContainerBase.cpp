@@ -1,23 +1,29 @@
 #include "GcContainerBase.h"
 
+// Standard.
+#include <cstdint>
+
 // Custom.
 #include "GarbageCollector.h"
 
 namespace sgc {
 
+    thread_local GarbageCollector* GcContainerBase::pModifyingGarbageCollector = nullptr;
+    thread_local GcContainerBase::ItemConstructionGuard* GcContainerBase::pCurrentItemConstruction = nullptr;
+
     GcContainerBase::GcContainerBase(IterateOverContainerGcPtrItems pIterateOverContainerGcPtrItems)
         : pIterateOverContainerGcPtrItems(pIterateOverContainerGcPtrItems) {
         // Notify garbage collector.
-        setIsRootNode(GarbageCollector::get().onGcNodeConstructed(this));
+        setIsRootNode(getGarbageCollector()->onGcNodeConstructed(this));
     }
 
     void GcContainerBase::notifyGarbageCollectorAboutDestruction() {
         // Make sure the GC has finished iterating over the container.
-        std::scoped_lock guard(*GarbageCollector::get().getGarbageCollectionMutex());
+        std::scoped_lock guard(*getGarbageCollector()->getGarbageCollectionMutex());
 
         if (isRootNode()) {
             // Notify garbage collector.
-            GarbageCollector::get().onGcRootNodeBeingDestroyed(this);
+            getGarbageCollector()->onGcRootNodeBeingDestroyed(this);
         }
     }
 
@@ -26,4 +32,75 @@ namespace sgc {
         return pIterateOverContainerGcPtrItems;
     }
 
+    GcContainerBase::ModificationGuard::ModificationGuard(const GcContainerBase* pContainer)
+        : scope(*pContainer->getGarbageCollector()),
+          guard(*pContainer->getGarbageCollector()->getGarbageCollectionMutex()),
+          pPreviousGarbageCollector(pModifyingGarbageCollector) {
+        pModifyingGarbageCollector = pContainer->getGarbageCollector();
+    }
+
+    GcContainerBase::ModificationGuard::~ModificationGuard() {
+        pModifyingGarbageCollector = pPreviousGarbageCollector;
+    }
+
+    GcContainerBase::ItemConstructionGuard::ItemConstructionGuard(
+        void* pItem,
+        size_t iItemSizeInBytes,
+        std::vector<size_t>* pRecordedGcPtrOffsets,
+        const std::vector<size_t>* pExpectedGcPtrOffsets)
+        : pItem(static_cast<std::byte*>(pItem)), iItemSizeInBytes(iItemSizeInBytes),
+          pRecordedGcPtrOffsets(pRecordedGcPtrOffsets), pExpectedGcPtrOffsets(pExpectedGcPtrOffsets),
+          pPreviousGuard(pCurrentItemConstruction), bRecordingGcPtrOffsets(pExpectedGcPtrOffsets == nullptr) {
+        pCurrentItemConstruction = this;
+    }
+
+    GcContainerBase::ItemConstructionGuard::~ItemConstructionGuard() {
+        pCurrentItemConstruction = pPreviousGuard;
+    }
+
+    GarbageCollector* GcContainerBase::getModifyingGarbageCollector() {
+        return pModifyingGarbageCollector;
+    }
+
+    bool GcContainerBase::isConstructingItem(const void* pAddress) {
+        const auto pGuard = pCurrentItemConstruction;
+        if (pGuard == nullptr) {
+            return false;
+        }
+
+        const auto iAddress = reinterpret_cast<uintptr_t>(pAddress);
+        const auto iItemStart = reinterpret_cast<uintptr_t>(pGuard->pItem);
+        return iAddress >= iItemStart && iAddress < iItemStart + pGuard->iItemSizeInBytes;
+    }
+
+    bool GcContainerBase::tryRegisteringConstructedItem(const GcPtrBase* pGcPtr) {
+        // Make sure the pointer is located in the item.
+        if (!isConstructingItem(pGcPtr)) {
+            return false;
+        }
+
+        const auto pGuard = pCurrentItemConstruction;
+        const auto iOffset = static_cast<size_t>(
+            reinterpret_cast<uintptr_t>(pGcPtr) - reinterpret_cast<uintptr_t>(pGuard->pItem));
+        const auto iIndex = pGuard->iConstructedGcPtrCount;
+        pGuard->iConstructedGcPtrCount += 1;
+
+        if (!pGuard->bRecordingGcPtrOffsets) {
+            const auto& vExpectedOffsets = *pGuard->pExpectedGcPtrOffsets;
+            if (iIndex < vExpectedOffsets.size() && vExpectedOffsets[iIndex] == iOffset) [[likely]] {
+                return true;
+            }
+
+            // This item differs from the expected one, record its own offsets (previous GC pointers were
+            // constructed at the expected offsets).
+            pGuard->pRecordedGcPtrOffsets->assign(
+                vExpectedOffsets.begin(), vExpectedOffsets.begin() + static_cast<std::ptrdiff_t>(iIndex));
+            pGuard->bRecordingGcPtrOffsets = true;
+        }
+
+        pGuard->pRecordedGcPtrOffsets->push_back(iOffset);
+
+        return true;
+    }
+
 }
@@ -1,7 +1,10 @@
 #pragma once
 
 // Standard.
+#include <cstddef>
 #include <functional>
+#include <mutex>
+#include <vector>
 
 // Custom.
 #include "GcNode.hpp"
@@ -11,6 +14,9 @@ namespace sgc {
 
     /** Base class for containers that store `GcPtr` items. */
     class GcContainerBase : public GcNode {
+        // Asks if constructed GC pointers are items of a container.
+        friend class GcPtrBase;
+
     public:
         /** Signature of the function to iterate over container's GcPtr items. */
         using IterateOverContainerGcPtrItems = void (*)(
@@ -28,6 +34,115 @@ namespace sgc {
         IterateOverContainerGcPtrItems getFunctionToIterateOverGcPtrItems() const;
 
     protected:
+        /**
+         * RAII-style object that derived containers create before modifying their items: locks the
+         * garbage collection mutex (so that the GC is not iterating over the container) and binds the
+         * container's garbage collector to the thread (so that new items belong to this garbage collector).
+         */
+        class ModificationGuard {
+        public:
+            /**
+             * Locks the garbage collection mutex of the container's garbage collector.
+             *
+             * @param pContainer Container that is going to be modified.
+             */
+            explicit ModificationGuard(const GcContainerBase* pContainer);
+
+            /** Restores the garbage collector of the container that was modified before. */
+            ~ModificationGuard();
+
+            ModificationGuard(const ModificationGuard&) = delete;
+            ModificationGuard& operator=(const ModificationGuard&) = delete;
+
+            ModificationGuard(ModificationGuard&&) noexcept = delete;
+            ModificationGuard& operator=(ModificationGuard&&) noexcept = delete;
+
+        private:
+            /** Binds the container's garbage collector to the thread. */
+            GcScope scope;
+
+            /** Locks the garbage collection mutex. */
+            std::scoped_lock<std::recursive_mutex> guard;
+
+            /**
+             * Garbage collector of the container that was being modified by the current thread before this
+             * one (`nullptr` if none).
+             */
+            GarbageCollector* const pPreviousGarbageCollector = nullptr;
+        };
+
+        /**
+         * RAII-style object that derived containers create while constructing an item which GC pointers
+         * the container does not know at compile time (for example captures of a callable): GC pointers that
+         * the current thread constructs in memory of the item are not registered as root nodes, instead
+         * their offsets (from the start of the item) are checked against expected offsets (in construction
+         * order) and recorded once they differ.
+         */
+        class ItemConstructionGuard {
+            // Registers constructed GC pointers.
+            friend class GcContainerBase;
+
+        public:
+            ItemConstructionGuard() = delete;
+
+            /**
+             * Starts construction of an item.
+             *
+             * @param pItem                   Memory of the item.
+             * @param iItemSizeInBytes        Size of the item.
+             * @param pRecordedGcPtrOffsets   Array that receives all offsets of constructed GC pointers once
+             * they differ from the expected ones.
+             * @param pExpectedGcPtrOffsets   Offsets that constructed GC pointers are expected to have (in
+             * construction order, for example recorded from another item of the same type) or `nullptr` to
+             * record all offsets.
+             */
+            ItemConstructionGuard(
+                void* pItem,
+                size_t iItemSizeInBytes,
+                std::vector<size_t>* pRecordedGcPtrOffsets,
+                const std::vector<size_t>* pExpectedGcPtrOffsets);
+
+            /** Finishes construction of the item. */
+            ~ItemConstructionGuard();
+
+            ItemConstructionGuard(const ItemConstructionGuard&) = delete;
+            ItemConstructionGuard& operator=(const ItemConstructionGuard&) = delete;
+
+            ItemConstructionGuard(ItemConstructionGuard&&) noexcept = delete;
+            ItemConstructionGuard& operator=(ItemConstructionGuard&&) noexcept = delete;
+
+            /**
+             * Tells if GC pointers constructed in the item so far have exactly the expected offsets.
+             *
+             * @return `false` if offsets were recorded (see @ref pRecordedGcPtrOffsets), `true` otherwise.
+             */
+            inline bool hasExpectedGcPtrOffsets() const {
+                return !bRecordingGcPtrOffsets && iConstructedGcPtrCount == pExpectedGcPtrOffsets->size();
+            }
+
+        private:
+            /** Memory of the item. */
+            const std::byte* const pItem = nullptr;
+
+            /** Size of the item in bytes. */
+            const size_t iItemSizeInBytes = 0;
+
+            /** Array to record offsets to. */
+            std::vector<size_t>* const pRecordedGcPtrOffsets = nullptr;
+
+            /** Offsets to check constructed GC pointers against (`nullptr` to record offsets). */
+            const std::vector<size_t>* const pExpectedGcPtrOffsets = nullptr;
+
+            /** Item that was being constructed by the current thread before this one (`nullptr` if none). */
+            ItemConstructionGuard* const pPreviousGuard = nullptr;
+
+            /** Number of GC pointers constructed in the item. */
+            size_t iConstructedGcPtrCount = 0;
+
+            /** `true` if offsets are added to @ref pRecordedGcPtrOffsets instead of being checked. */
+            bool bRecordingGcPtrOffsets = false;
+        };
+
         /**
          * Pointer to a static function of a derived class to iterate over container's GcPtr items.
          *
@@ -42,7 +157,41 @@ namespace sgc {
         void notifyGarbageCollectorAboutDestruction();
 
     private:
+        /**
+         * Returns the garbage collector of the container that is being modified by the current thread
+         * (see @ref ModificationGuard).
+         *
+         * @return `nullptr` if no container is being modified.
+         */
+        static GarbageCollector* getModifyingGarbageCollector();
+
+        /**
+         * Tells if the specified address belongs to an item that is being constructed by a container on
+         * the current thread (see @ref ItemConstructionGuard).
+         *
+         * @param pAddress Address to check.
+         *
+         * @return `true` if inside of the innermost item being constructed, `false` otherwise.
+         */
+        static bool isConstructingItem(const void* pAddress);
+
+        /**
+         * Called by GC pointers in their constructor to check if they are constructed in an item that is
+         * being constructed by a container on the current thread (see @ref ItemConstructionGuard).
+         *
+         * @param pGcPtr Constructed GC pointer.
+         *
+         * @return `true` if the GC pointer is a container item (not a root node), `false` otherwise.
+         */
+        static bool tryRegisteringConstructedItem(const GcPtrBase* pGcPtr);
+
         /** Pointer to a static function of a derived class to iterate over container's GcPtr items. */
         IterateOverContainerGcPtrItems const pIterateOverContainerGcPtrItems = nullptr;
+
+        /** Garbage collector of the innermost container that is being modified by the current thread. */
+        static thread_local GarbageCollector* pModifyingGarbageCollector;
+
+        /** Innermost item that is being constructed by the current thread (`nullptr` if none). */
+        static thread_local ItemConstructionGuard* pCurrentItemConstruction;
     };
 }
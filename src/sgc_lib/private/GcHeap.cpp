@@ -0,0 +1,396 @@
+#include "GcHeap.h"
+
+// Standard.
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+// Custom.
+#include "GcVirtualMemory.h"
+#include "GcInfoCallbacks.hpp"
+
+namespace sgc {
+
+    GcHeap::~GcHeap() {
+        for (const auto& pRegion : vRegions) {
+            GcVirtualMemory::freePages(pRegion->pStart, iRegionSize);
+        }
+    }
+
+    bool GcHeap::canAllocate(size_t iSizeInBytes, size_t iAlignment) {
+        return getRequiredSlotSize(iSizeInBytes, iAlignment) <= iMaxAllocationSize;
+    }
+
+    void* GcHeap::allocate(size_t iSizeInBytes, size_t iAlignment) {
+        // Find a page with free slots.
+        const auto iSizeClass = getSizeClassIndex(getRequiredSlotSize(iSizeInBytes, iAlignment));
+        auto& pagesWithFreeSlots = vPagesWithFreeSlots[iSizeClass];
+        auto pPage = pagesWithFreeSlots.pFirst;
+        if (pPage == nullptr) {
+            pPage = acquirePage(iSizeClass);
+            pagesWithFreeSlots.pushFront(pPage);
+        }
+
+        // Take a slot.
+        void* pSlot = nullptr;
+        if (pPage->pFreeSlots != nullptr) {
+            pSlot = pPage->pFreeSlots;
+            pPage->pFreeSlots = *reinterpret_cast<void**>(pSlot);
+        } else {
+            pSlot = pPage->pStart + pPage->iFirstUntouchedSlot * pPage->iSlotSize;
+            pPage->iFirstUntouchedSlot += 1;
+        }
+        pPage->iUsedSlotCount += 1;
+
+        // Full pages are not stored in the list.
+        if (pPage->iUsedSlotCount == pPage->iSlotCount) {
+            pagesWithFreeSlots.remove(pPage);
+        }
+
+        return pSlot;
+    }
+
+    void GcHeap::free(void* pMemory) {
+        // Find the page.
+        const auto pPage = findPage(pMemory);
+        if (pPage == nullptr || pPage->state != PageState::IN_USE) [[unlikely]] {
+            GcInfoCallbacks::getCriticalErrorCallback()(
+                "attempted to free memory that does not belong to the GC heap");
+            throw std::runtime_error("critical error");
+        }
+
+        auto& pagesWithFreeSlots = vPagesWithFreeSlots[pPage->iSizeClass];
+
+        // Full pages and evacuating pages are not stored in the list.
+        if (pPage->iUsedSlotCount == pPage->iSlotCount && !pPage->bEvacuating) {
+            pagesWithFreeSlots.pushFront(pPage);
+        }
+
+        // Return the slot.
+        pPage->pSlotOwners[(static_cast<char*>(pMemory) - pPage->pStart) / pPage->iSlotSize] = nullptr;
+        *reinterpret_cast<void**>(pMemory) = pPage->pFreeSlots;
+        pPage->pFreeSlots = pMemory;
+        pPage->iUsedSlotCount -= 1;
+
+        if (pPage->iUsedSlotCount != 0) {
+            return;
+        }
+
+        // The page is now empty, make it available for all size classes.
+        if (pPage->bEvacuating) {
+            pPage->bEvacuating = false;
+        } else {
+            pagesWithFreeSlots.remove(pPage);
+        }
+        pPage->pRegion->iUsedPageCount -= 1;
+        if (pPage->pRegion->iUsedPageCount == 0 && pPage->pRegion->bHugePages) {
+            unusedHugePageRegions.insert(pPage->pRegion);
+        }
+        pPage->state = PageState::EMPTY;
+        pPage->pFreeSlots = nullptr;
+        pPage->iFirstUntouchedSlot = 0;
+        pPage->iEmptySinceCollection = iGarbageCollectionCount;
+        emptyPages.pushFront(pPage);
+    }
+
+    void GcHeap::setOwner(void* pMemory, void* pOwner) {
+        const auto pPage = findPage(pMemory);
+        pPage->pSlotOwners[(static_cast<char*>(pMemory) - pPage->pStart) / pPage->iSlotSize] = pOwner;
+    }
+
+    void* GcHeap::findOwner(const void* pAddress) {
+        const auto pPage = findPage(pAddress);
+        if (pPage == nullptr || pPage->state != PageState::IN_USE) {
+            return nullptr;
+        }
+
+        // Slots are not used at the end of the page if the page size is not a multiple of the slot size.
+        const auto iSlotIndex =
+            static_cast<size_t>(static_cast<const char*>(pAddress) - pPage->pStart) / pPage->iSlotSize;
+        if (iSlotIndex >= pPage->iSlotCount) {
+            return nullptr;
+        }
+
+        return pPage->pSlotOwners[iSlotIndex];
+    }
+
+    void GcHeap::onGarbageCollectionFinished() {
+        // Empty pages are sorted from the most recently emptied one.
+        size_t iEmptyPageIndex = 0;
+        for (auto pPage = emptyPages.pFirst; pPage != nullptr; iEmptyPageIndex++) {
+            const auto pNextPage = pPage->pNext;
+
+            pPage->bCanDecommit =
+                iEmptyPageIndex >= decommitPolicy.iRetainedEmptyPageCount &&
+                iGarbageCollectionCount - pPage->iEmptySinceCollection >= decommitPolicy.iDecommitDelay;
+
+            // Decommitting single pages would split huge pages, only decommit whole regions of them.
+            if (pPage->bCanDecommit && !pPage->pRegion->bHugePages) {
+                emptyPages.remove(pPage);
+                decommitPage(pPage);
+            }
+
+            pPage = pNextPage;
+        }
+
+        for (auto regionIt = unusedHugePageRegions.begin(); regionIt != unusedHugePageRegions.end();) {
+            if (decommitRegionIfEmpty(*regionIt)) {
+                regionIt = unusedHugePageRegions.erase(regionIt);
+            } else {
+                ++regionIt;
+            }
+        }
+
+        iGarbageCollectionCount += 1;
+    }
+
+    bool GcHeap::beginCompaction() {
+        for (size_t iSizeClass = 0; iSizeClass < iSizeClassCount; iSizeClass++) {
+            // Collect pages with free slots (full pages are dense already).
+            std::vector<Page*> vPages;
+            size_t iFreeSlotCount = 0;
+            const auto& pagesWithFreeSlots = vPagesWithFreeSlots[iSizeClass];
+            for (auto pPage = pagesWithFreeSlots.pFirst; pPage != nullptr; pPage = pPage->pNext) {
+                vPages.push_back(pPage);
+                iFreeSlotCount += pPage->iSlotCount - pPage->iUsedSlotCount;
+            }
+            if (vPages.size() < 2) {
+                continue;
+            }
+
+            // Evacuate the sparsest pages while their objects fit into free slots of the other pages.
+            std::sort(vPages.begin(), vPages.end(), [](const Page* pFirst, const Page* pSecond) {
+                return pFirst->iUsedSlotCount < pSecond->iUsedSlotCount;
+            });
+            for (const auto& pPage : vPages) {
+                // Don't move objects from pages that are at least half full.
+                if (pPage->iUsedSlotCount * 2 >= pPage->iSlotCount) {
+                    break;
+                }
+
+                // Free slots of this page can't be used.
+                iFreeSlotCount -= pPage->iSlotCount - pPage->iUsedSlotCount;
+                if (pPage->iUsedSlotCount > iFreeSlotCount) {
+                    break;
+                }
+                iFreeSlotCount -= pPage->iUsedSlotCount;
+
+                vPagesWithFreeSlots[iSizeClass].remove(pPage);
+                pPage->bEvacuating = true;
+                vEvacuatingPages.push_back(pPage);
+            }
+        }
+
+        return !vEvacuatingPages.empty();
+    }
+
+    bool GcHeap::isEvacuating(void* pMemory) {
+        const auto pPage = findPage(pMemory);
+        return pPage != nullptr && pPage->bEvacuating;
+    }
+
+    void GcHeap::endCompaction() {
+        for (const auto& pPage : vEvacuatingPages) {
+            if (!pPage->bEvacuating) {
+                // Became empty.
+                continue;
+            }
+
+            pPage->bEvacuating = false;
+            vPagesWithFreeSlots[pPage->iSizeClass].pushFront(pPage);
+        }
+        vEvacuatingPages.clear();
+    }
+
+    void GcHeap::setDecommitPolicy(const GcDecommitPolicy& policy) { decommitPolicy = policy; }
+
+    GcDecommitPolicy GcHeap::getDecommitPolicy() const { return decommitPolicy; }
+
+    size_t GcHeap::getCommittedSize() const { return iCommittedPageCount * iPageSize; }
+
+    bool GcHeap::isEmpty() const {
+        return std::all_of(vRegions.begin(), vRegions.end(), [](const auto& pRegion) {
+            return pRegion->iUsedPageCount == 0;
+        });
+    }
+
+    bool GcHeap::setUseHugePages(bool bEnable) {
+        bUseHugePages = bEnable && GcVirtualMemory::areHugePagesSupported();
+
+        for (const auto& pRegion : vRegions) {
+            if (!setUseHugePages(pRegion.get(), bUseHugePages)) [[unlikely]] {
+                // Fallback to regular pages.
+                return setUseHugePages(false);
+            }
+        }
+
+        return bUseHugePages;
+    }
+
+    bool GcHeap::isUsingHugePages() const { return bUseHugePages; }
+
+    size_t GcHeap::getRequiredSlotSize(size_t iSizeInBytes, size_t iAlignment) {
+        constexpr size_t iMinSlotAlignment = 16; // NOLINT: all slot sizes are multiples of this value
+        if (iAlignment <= iMinSlotAlignment) {
+            return iSizeInBytes;
+        }
+
+        // Slots of power of 2 size classes are aligned to their size (pages are aligned to the page size).
+        return std::bit_ceil(std::max(iSizeInBytes, iAlignment));
+    }
+
+    size_t GcHeap::getSizeClassIndex(size_t iSlotSize) {
+        return static_cast<size_t>(
+            std::lower_bound(vSizeClasses.begin(), vSizeClasses.end(), iSlotSize) - vSizeClasses.begin());
+    }
+
+    GcHeap::Page* GcHeap::acquirePage(size_t iSizeClass) {
+        Page* pPage = nullptr;
+
+        if (emptyPages.pFirst != nullptr) {
+            // Reuse an empty page.
+            pPage = emptyPages.pFirst;
+            emptyPages.remove(pPage);
+        } else {
+            if (decommittedPages.pFirst == nullptr) {
+                // Reserve a new region.
+                auto pRegion = std::make_unique<Region>();
+                pRegion->pStart =
+                    reinterpret_cast<char*>(GcVirtualMemory::reservePages(iRegionSize, iRegionSize));
+
+                // Add pages in reverse order so that pages with lower addresses are used first.
+                for (size_t i = pRegion->vPages.size(); i > 0; i--) {
+                    auto& page = pRegion->vPages[i - 1];
+                    page.pStart = pRegion->pStart + (i - 1) * iPageSize;
+                    page.pRegion = pRegion.get();
+                    decommittedPages.pushFront(&page);
+                }
+
+                // Regions are aligned to their size so huge pages don't cross region boundaries.
+                if (bUseHugePages && !setUseHugePages(pRegion.get(), true)) [[unlikely]] {
+                    // Fallback to regular pages for new regions (older regions keep their huge pages).
+                    bUseHugePages = false;
+                }
+
+                regionsByAddress[reinterpret_cast<uintptr_t>(pRegion->pStart)] = pRegion.get();
+                vRegions.push_back(std::move(pRegion));
+            }
+
+            // Commit a page.
+            pPage = decommittedPages.pFirst;
+            GcVirtualMemory::commitPages(pPage->pStart, iPageSize);
+            decommittedPages.remove(pPage);
+            iCommittedPageCount += 1;
+        }
+
+        // Format the page.
+        if (pPage->pRegion->iUsedPageCount == 0) {
+            unusedHugePageRegions.erase(pPage->pRegion);
+        }
+        pPage->pRegion->iUsedPageCount += 1;
+        pPage->state = PageState::IN_USE;
+        pPage->iSizeClass = iSizeClass;
+        pPage->iSlotSize = vSizeClasses[iSizeClass];
+        pPage->iSlotCount = iPageSize / pPage->iSlotSize;
+        pPage->iUsedSlotCount = 0;
+        pPage->iFirstUntouchedSlot = 0;
+        pPage->pFreeSlots = nullptr;
+        pPage->pSlotOwners = std::make_unique<void*[]>(pPage->iSlotCount);
+
+        return pPage;
+    }
+
+    GcHeap::Page* GcHeap::findPage(const void* pMemory) {
+        const auto iAddress = reinterpret_cast<uintptr_t>(pMemory);
+
+        const auto regionIt = regionsByAddress.find(iAddress & ~(iRegionSize - 1));
+        if (regionIt == regionsByAddress.end()) {
+            return nullptr;
+        }
+
+        const auto pRegion = regionIt->second;
+        return &pRegion->vPages[(iAddress - reinterpret_cast<uintptr_t>(pRegion->pStart)) / iPageSize];
+    }
+
+    void GcHeap::decommitPage(Page* pPage) {
+        GcVirtualMemory::decommitPages(pPage->pStart, iPageSize, decommitPolicy.bLazyDecommit);
+
+        pPage->state = PageState::DECOMMITTED;
+        pPage->pSlotOwners = nullptr;
+        decommittedPages.pushFront(pPage);
+        iCommittedPageCount -= 1;
+    }
+
+    bool GcHeap::decommitRegionIfEmpty(Region* pRegion) {
+        // Make sure all empty pages can be decommitted.
+        size_t iEmptyPageCount = 0;
+        for (const auto& page : pRegion->vPages) {
+            if (page.state != PageState::EMPTY) {
+                continue;
+            }
+
+            if (!page.bCanDecommit) {
+                return false;
+            }
+            iEmptyPageCount += 1;
+        }
+
+        if (iEmptyPageCount == 0) {
+            return true;
+        }
+
+        GcVirtualMemory::decommitPages(pRegion->pStart, iRegionSize, decommitPolicy.bLazyDecommit);
+
+        for (auto& page : pRegion->vPages) {
+            if (page.state == PageState::EMPTY) {
+                emptyPages.remove(&page);
+                page.state = PageState::DECOMMITTED;
+                page.pSlotOwners = nullptr;
+                decommittedPages.pushFront(&page);
+            }
+        }
+        iCommittedPageCount -= iEmptyPageCount;
+
+        return true;
+    }
+
+    bool GcHeap::setUseHugePages(Region* pRegion, bool bEnable) {
+        const auto bAdvised = GcVirtualMemory::adviseHugePages(pRegion->pStart, iRegionSize, bEnable);
+        pRegion->bHugePages = bEnable && bAdvised;
+
+        // Empty pages of regions with regular pages are decommitted one by one.
+        if (pRegion->bHugePages && pRegion->iUsedPageCount == 0) {
+            unusedHugePageRegions.insert(pRegion);
+        } else {
+            unusedHugePageRegions.erase(pRegion);
+        }
+
+        return bAdvised || !bEnable;
+    }
+
+    void GcHeap::PageList::pushFront(Page* pPage) {
+        pPage->pPrevious = nullptr;
+        pPage->pNext = pFirst;
+
+        if (pFirst != nullptr) {
+            pFirst->pPrevious = pPage;
+        }
+        pFirst = pPage;
+    }
+
+    void GcHeap::PageList::remove(Page* pPage) {
+        if (pPage->pPrevious != nullptr) {
+            pPage->pPrevious->pNext = pPage->pNext;
+        } else {
+            pFirst = pPage->pNext;
+        }
+
+        if (pPage->pNext != nullptr) {
+            pPage->pNext->pPrevious = pPage->pPrevious;
+        }
+
+        pPage->pPrevious = nullptr;
+        pPage->pNext = nullptr;
+    }
+
+}
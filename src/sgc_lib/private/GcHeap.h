@@ -0,0 +1,401 @@
+#pragma once
+
+// Standard.
+#include <array>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstdint>
+
+// Custom.
+#include "GcDecommitPolicy.hpp"
+
+namespace sgc {
+    /**
+     * GC-owned heap for small objects.
+     *
+     * Memory is reserved from the OS in big regions which are split into pages, each page stores slots
+     * of a single size class. Pages that became empty after a garbage collection are returned to the OS
+     * according to the decommit policy.
+     *
+     * @remark Not thread-safe, used while the garbage collector's mutex is locked.
+     */
+    class GcHeap {
+    public:
+        /** Size in bytes of a heap page (all slots of a page have the same size). */
+        static constexpr size_t iPageSize = 64 * 1024; // NOLINT
+
+        /** Size in bytes of a region of pages reserved from the OS (regions are aligned to their size). */
+        static constexpr size_t iRegionSize = 4 * 1024 * 1024; // NOLINT
+
+        /** Size in bytes of a transparent huge page (regions are always aligned to this size). */
+        static constexpr size_t iHugePageSize = 2 * 1024 * 1024; // NOLINT
+
+        /** Maximum size in bytes of a memory block that can be allocated in the heap. */
+        static constexpr size_t iMaxAllocationSize = 8 * 1024; // NOLINT
+
+        GcHeap() = default;
+
+        /** Returns all regions to the OS. */
+        ~GcHeap();
+
+        GcHeap(const GcHeap&) = delete;
+        GcHeap& operator=(const GcHeap&) = delete;
+
+        GcHeap(GcHeap&&) noexcept = delete;
+        GcHeap& operator=(GcHeap&&) noexcept = delete;
+
+        /**
+         * Tells if a memory block of the specified size and alignment can be allocated in the heap.
+         *
+         * @param iSizeInBytes Size of the memory block.
+         * @param iAlignment   Alignment of the memory block (power of 2).
+         *
+         * @return `true` if can be allocated using @ref allocate, `false` otherwise.
+         */
+        static bool canAllocate(size_t iSizeInBytes, size_t iAlignment);
+
+        /**
+         * Allocates a memory block.
+         *
+         * @remark Throws `std::bad_alloc` if failed.
+         *
+         * @param iSizeInBytes Size of the memory block (see @ref canAllocate).
+         * @param iAlignment   Alignment of the memory block (see @ref canAllocate).
+         *
+         * @return Allocated memory.
+         */
+        void* allocate(size_t iSizeInBytes, size_t iAlignment);
+
+        /**
+         * Frees a memory block previously returned by @ref allocate.
+         *
+         * @param pMemory Allocated memory.
+         */
+        void free(void* pMemory);
+
+        /**
+         * Remembers an object (owner) that uses the specified memory block so that it can be found by
+         * an address of any byte of the memory block (see @ref findOwner).
+         *
+         * @param pMemory Memory returned by @ref allocate.
+         * @param pOwner  Owner of the memory block (forgotten when the memory block is freed).
+         */
+        void setOwner(void* pMemory, void* pOwner);
+
+        /**
+         * Looks for the owner of the memory block that contains the specified address in constant time.
+         *
+         * @param pAddress Address of any byte of a memory block.
+         *
+         * @return `nullptr` if the address does not belong to an allocated memory block (or the memory
+         * block has no owner), otherwise owner specified in @ref setOwner.
+         */
+        void* findOwner(const void* pAddress);
+
+        /**
+         * Must be called after the garbage collector finished its sweep phase to return memory of
+         * empty pages to the OS according to the decommit policy.
+         */
+        void onGarbageCollectionFinished();
+
+        /**
+         * Picks sparsely used pages which objects should be moved to other pages (see @ref
+         * isEvacuating), new memory blocks are not allocated in such pages until @ref endCompaction
+         * is called.
+         *
+         * @return `true` if some pages should be evacuated, `false` if the heap is dense enough.
+         */
+        bool beginCompaction();
+
+        /**
+         * Tells if the specified memory block is in a page that is being evacuated.
+         *
+         * @param pMemory Memory returned by @ref allocate.
+         *
+         * @return `true` if the memory block should be moved, `false` otherwise.
+         */
+        bool isEvacuating(void* pMemory);
+
+        /** Makes pages that were not fully evacuated (contain pinned objects) usable again. */
+        void endCompaction();
+
+        /**
+         * Sets a policy that defines when memory of empty pages is returned to the OS.
+         *
+         * @param policy Policy to use.
+         */
+        void setDecommitPolicy(const GcDecommitPolicy& policy);
+
+        /**
+         * Returns the policy that defines when memory of empty pages is returned to the OS.
+         *
+         * @return Policy.
+         */
+        GcDecommitPolicy getDecommitPolicy() const;
+
+        /**
+         * Returns the total size of pages that are committed (pages that store objects and empty pages that
+         * were not returned to the OS yet).
+         *
+         * @return Size in bytes.
+         */
+        size_t getCommittedSize() const;
+
+        /**
+         * Tells if the heap has no allocated objects.
+         *
+         * @return `true` if all pages are empty, `false` otherwise.
+         */
+        bool isEmpty() const;
+
+        /**
+         * Enables or disables backing of heap regions with transparent huge pages (fewer TLB misses when
+         * traversing big heaps). Applies to already reserved regions and to regions reserved later.
+         *
+         * @remark While enabled, empty pages are only returned to the OS when the whole region that they
+         * belong to can be returned (to not split huge pages) and the OS might commit more memory than
+         * reported by @ref getCommittedSize.
+         *
+         * @param bEnable `true` to use huge pages, `false` to use regular pages.
+         *
+         * @return `true` if huge pages are now used, `false` if disabled or huge pages are not available
+         * (in this case regular pages are used).
+         */
+        bool setUseHugePages(bool bEnable);
+
+        /**
+         * Tells if heap regions are backed with transparent huge pages.
+         *
+         * @return `true` if huge pages are used, `false` otherwise.
+         */
+        bool isUsingHugePages() const;
+
+    private:
+        /** State of a heap page. */
+        enum class PageState : unsigned char {
+            DECOMMITTED, ///< Page's memory is not committed.
+            IN_USE,      ///< Page is committed and formatted for some size class.
+            EMPTY        ///< Page is committed but has no used slots.
+        };
+
+        struct Region;
+
+        /** Describes a heap page. */
+        struct Page {
+            /** Start of the page's memory. */
+            char* pStart = nullptr;
+
+            /** Previous page in the list that this page is in. */
+            Page* pPrevious = nullptr;
+
+            /** Next page in the list that this page is in. */
+            Page* pNext = nullptr;
+
+            /** Singly linked list of freed slots (each free slot stores a pointer to the next one). */
+            void* pFreeSlots = nullptr;
+
+            /** Owners of slots (see @ref setOwner), allocated when the page is formatted. */
+            std::unique_ptr<void*[]> pSlotOwners;
+
+            /** Size in bytes of the page's slots. */
+            size_t iSlotSize = 0;
+
+            /** Total number of slots in the page. */
+            size_t iSlotCount = 0;
+
+            /** Number of allocated slots. */
+            size_t iUsedSlotCount = 0;
+
+            /** Index of the first slot that was never allocated since the page was formatted. */
+            size_t iFirstUntouchedSlot = 0;
+
+            /** Value of @ref iGarbageCollectionCount when the page became empty. */
+            size_t iEmptySinceCollection = 0;
+
+            /** Index of the page's size class. */
+            size_t iSizeClass = 0;
+
+            /** Region that the page belongs to. */
+            Region* pRegion = nullptr;
+
+            /** Current state of the page. */
+            PageState state = PageState::DECOMMITTED;
+
+            /** Used during a garbage collection to mark empty pages that can be returned to the OS. */
+            bool bCanDecommit = false;
+
+            /** `true` if the page is being evacuated during compaction (it's not in any list). */
+            bool bEvacuating = false;
+        };
+
+        /** Intrusive doubly linked list of pages. */
+        struct PageList {
+            /**
+             * Adds the specified page to the beginning of the list.
+             *
+             * @param pPage Page that is not in any list.
+             */
+            void pushFront(Page* pPage);
+
+            /**
+             * Removes the specified page from the list.
+             *
+             * @param pPage Page that is in this list.
+             */
+            void remove(Page* pPage);
+
+            /** First page in the list. */
+            Page* pFirst = nullptr;
+        };
+
+        /** Memory reserved from the OS. */
+        struct Region {
+            /** Start of the region's memory (aligned to @ref iRegionSize). */
+            char* pStart = nullptr;
+
+            /** Pages of the region. */
+            std::array<Page, iRegionSize / iPageSize> vPages;
+
+            /** Number of pages in the state @ref PageState::IN_USE. */
+            size_t iUsedPageCount = 0;
+
+            /**
+             * Whether the region's memory is advised to be backed with transparent huge pages (its pages
+             * are then only returned to the OS all at once).
+             */
+            bool bHugePages = false;
+        };
+        static_assert(iRegionSize % iHugePageSize == 0, "regions must consist of whole huge pages");
+
+        /** Total number of size classes. */
+        static constexpr size_t iSizeClassCount = 32; // NOLINT
+
+        /** Slot sizes of size classes (sorted). */
+        static constexpr std::array<size_t, iSizeClassCount> vSizeClasses = []() {
+            std::array<size_t, iSizeClassCount> vClasses{};
+            size_t iClassIndex = 0;
+
+            // Classes with 16 byte step up to 128 bytes.
+            constexpr size_t iSmallStep = 16; // NOLINT
+            constexpr size_t iSmallLimit = 128; // NOLINT
+            for (size_t iSize = iSmallStep; iSize <= iSmallLimit; iSize += iSmallStep) {
+                vClasses[iClassIndex] = iSize;
+                iClassIndex += 1;
+            }
+
+            // Then 4 classes per each power of 2.
+            for (size_t iBase = iSmallLimit; iBase < iMaxAllocationSize; iBase *= 2) {
+                for (size_t iStep = 1; iStep <= 4; iStep++) {
+                    vClasses[iClassIndex] = iBase + iBase / 4 * iStep;
+                    iClassIndex += 1;
+                }
+            }
+
+            return vClasses;
+        }();
+        static_assert(vSizeClasses.back() == iMaxAllocationSize, "update size class count");
+
+        /**
+         * Returns size of a slot that can store a memory block of the specified size and alignment.
+         *
+         * @param iSizeInBytes Size of the memory block.
+         * @param iAlignment   Alignment of the memory block (power of 2).
+         *
+         * @return Size of the slot in bytes (might be bigger than @ref iMaxAllocationSize).
+         */
+        static size_t getRequiredSlotSize(size_t iSizeInBytes, size_t iAlignment);
+
+        /**
+         * Returns index of the smallest size class that can store a slot of the specified size.
+         *
+         * @param iSlotSize Size of the slot (not bigger than @ref iMaxAllocationSize).
+         *
+         * @return Index of the size class.
+         */
+        static size_t getSizeClassIndex(size_t iSlotSize);
+
+        /**
+         * Takes an empty or a decommitted page (reserves a new region if needed) and formats it
+         * for the specified size class.
+         *
+         * @param iSizeClass Index of the size class.
+         *
+         * @return Page in the state @ref PageState::IN_USE that is not in any list.
+         */
+        Page* acquirePage(size_t iSizeClass);
+
+        /**
+         * Looks for a page that the specified memory belongs to.
+         *
+         * @param pMemory Memory to look for (any address in the page).
+         *
+         * @return `nullptr` if the memory does not belong to the heap, otherwise page.
+         */
+        Page* findPage(const void* pMemory);
+
+        /**
+         * Returns memory of the specified empty page to the OS.
+         *
+         * @param pPage Page that is not in any list.
+         */
+        void decommitPage(Page* pPage);
+
+        /**
+         * Returns memory of the specified region to the OS if all of its empty pages can be returned
+         * to the OS.
+         *
+         * @param pRegion Region without used pages.
+         *
+         * @return `true` if the region has no committed pages now, `false` otherwise.
+         */
+        bool decommitRegionIfEmpty(Region* pRegion);
+
+        /**
+         * Changes whether the specified region is backed with transparent huge pages.
+         *
+         * @param pRegion Region.
+         * @param bEnable `true` to use huge pages, `false` to use regular pages.
+         *
+         * @return `false` if failed to use huge pages (the region uses regular pages then), `true` otherwise.
+         */
+        bool setUseHugePages(Region* pRegion, bool bEnable);
+
+        /** Pages (per size class) that have free slots. */
+        std::array<PageList, iSizeClassCount> vPagesWithFreeSlots;
+
+        /** Committed pages without used slots (the first page is the most recently emptied one). */
+        PageList emptyPages;
+
+        /** Pages which memory is not committed. */
+        PageList decommittedPages;
+
+        /** Pages that are being evacuated during compaction. */
+        std::vector<Page*> vEvacuatingPages;
+
+        /** Regions reserved from the OS. */
+        std::vector<std::unique_ptr<Region>> vRegions;
+
+        /** Regions from @ref vRegions by their start address. */
+        std::unordered_map<uintptr_t, Region*> regionsByAddress;
+
+        /**
+         * Regions backed with huge pages that have no used pages but might have empty pages (only these
+         * regions are checked for decommit after a garbage collection).
+         */
+        std::unordered_set<Region*> unusedHugePageRegions;
+
+        /** Defines when empty pages are returned to the OS. */
+        GcDecommitPolicy decommitPolicy;
+
+        /** Number of pages in the states @ref PageState::IN_USE and @ref PageState::EMPTY. */
+        size_t iCommittedPageCount = 0;
+
+        /** Total number of garbage collections that were finished. */
+        size_t iGarbageCollectionCount = 0;
+
+        /** Whether new regions are backed with transparent huge pages or not. */
+        bool bUseHugePages = false;
+    };
+}
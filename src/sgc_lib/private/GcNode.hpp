@@ -1,34 +1,97 @@
 #pragma once
 
+// Standard.
+#include <cstdint>
+
+// Custom.
+#include "GarbageCollector.h"
+
 namespace sgc {
     /** Base class for GC pointers and GC containers. */
     class GcNode {
+        // Moves nodes of promoted objects to the shared garbage collector.
+        friend class GarbageCollector;
+
     public:
         virtual ~GcNode() = default;
 
+        /**
+         * Returns garbage collector that this node belongs to (garbage collector that was bound to the
+         * thread when the node was constructed or garbage collector of the GC pointer that this pointer
+         * was constructed from).
+         *
+         * @return Garbage collector.
+         */
+        inline GarbageCollector* getGarbageCollector() const {
+            return GarbageCollector::getById(iGarbageCollectorId);
+        }
+
     protected:
-        GcNode() = default;
+        /** Creates a node that belongs to the garbage collector bound to the current thread. */
+        GcNode() : GcNode(&GarbageCollector::get()) {}
+
+        /**
+         * Creates a node that belongs to the specified garbage collector.
+         *
+         * @param pGarbageCollector Garbage collector of the node.
+         */
+        explicit GcNode(GarbageCollector* pGarbageCollector)
+            : iGarbageCollectorId(pGarbageCollector->getId()), bIsRootNode(0), bIsScannedNode(0) {}
 
         /**
          * Sets if this GC node object belongs to some other object as a field.
          *
          * @param bIsRootNode `true` if root, `false` otherwise.
          */
-        inline void setIsRootNode(bool bIsRootNode) { this->bIsRootNode = bIsRootNode; }
+        inline void setIsRootNode(bool bIsRootNode) { this->bIsRootNode = bIsRootNode ? 1 : 0; }
 
         /**
          * Tells if this GC node object belongs to some other object as a field.
          *
          * @return `true` if root, `false` otherwise.
          */
-        inline bool isRootNode() const { return bIsRootNode; }
+        inline bool isRootNode() const { return bIsRootNode != 0; }
+
+        /**
+         * Marks this root GC node as a node that is found by scanning memory (a registered thread stack, see
+         * @ref GcThreadStack, or memory of a `GcTracingAllocator`) instead of being in the root set.
+         */
+        inline void setIsScannedNode() { bIsScannedNode = 1; }
+
+        /**
+         * Tells if this root GC node is found by scanning memory.
+         *
+         * @return `true` if not in the root set, `false` otherwise.
+         */
+        inline bool isScannedNode() const { return bIsScannedNode != 0; }
 
     private:
+        /**
+         * ID of the garbage collector that this node belongs to (see `GarbageCollector::getById`).
+         *
+         * @remark Nodes store a small ID instead of a pointer so that it fits into padding after the
+         * vtable pointer together with flags (GC pointers don't grow because of it). A node needs to know
+         * its garbage collector even when it does not reference an allocation (to lock the right mutex
+         * and to leave the root set it was added to).
+         *
+         * @remark Initialized in constructor, only changed when the object that this node belongs to is
+         * promoted from a thread-local garbage collector to its shared garbage collector (or when a
+         * region ends).
+         */
+        uint16_t iGarbageCollectorId : GarbageCollector::iIdBitCount;
+
         /**
          * Defines if this GC node object belongs to some other object as a field.
          *
          * @remark Initialized in constructor of the derived class and never changed later.
          */
-        bool bIsRootNode = false;
+        uint16_t bIsRootNode : 1;
+
+        /**
+         * Defines if this root GC node is not in the root set and is found by scanning memory.
+         *
+         * @remark Initialized in constructor of the derived class and never changed later.
+         */
+        uint16_t bIsScannedNode : 1;
     };
 }
@@ -0,0 +1,144 @@
+#include "GcNursery.h"
+
+// Standard.
+#include <new>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdint>
+
+// Custom.
+#include "GcInfoCallbacks.hpp"
+
+namespace sgc {
+
+    GcNursery::~GcNursery() {
+        for (const auto& pBlock : vBlocks) {
+            freeBlock(pBlock);
+        }
+    }
+
+    bool GcNursery::canAllocate(size_t iSizeInBytes, size_t iAlignment) {
+        return iSizeInBytes <= iMaxAllocationSize && iAlignment <= iGranularity;
+    }
+
+    void* GcNursery::allocate(size_t iSizeInBytes) {
+        const auto iSizeClass = (iSizeInBytes + iGranularity - 1) / iGranularity;
+        const auto iSlotSize = iSizeClass * iGranularity;
+
+        void* pMemory = nullptr;
+        if (vFreeSlots[iSizeClass] != nullptr) {
+            // Reuse memory of a deleted object.
+            const auto pSlot = vFreeSlots[iSizeClass];
+            vFreeSlots[iSizeClass] = pSlot->pNext;
+            pSlot->~FreeSlot();
+            pMemory = pSlot;
+        } else {
+            if (pCurrent == nullptr || pCurrent + iSlotSize > pEnd) {
+                // Take a new block.
+                vBlocks.reserve(vBlocks.size() + 1);
+                const auto pBlockMemory = ::operator new(iBlockSize, std::align_val_t{iBlockSize});
+                pCurrentBlock = new (pBlockMemory) Block();
+                vBlocks.push_back(pCurrentBlock);
+
+                pCurrent = reinterpret_cast<std::byte*>(pBlockMemory) + iFirstSlotOffset;
+                pEnd = reinterpret_cast<std::byte*>(pBlockMemory) + iBlockSize;
+            }
+
+            pMemory = pCurrent;
+            pCurrent += iSlotSize;
+        }
+
+        getBlock(pMemory)->iAliveCount += 1;
+        iAliveCount += 1;
+
+        return pMemory;
+    }
+
+    void GcNursery::free(void* pMemory, size_t iSizeInBytes) {
+        const auto pBlock = getBlock(pMemory);
+        if (pBlock->iAliveCount == 0) [[unlikely]] {
+            GcInfoCallbacks::getCriticalErrorCallback()(
+                "attempted to free more memory blocks than were allocated in a nursery block");
+            throw std::runtime_error("critical error");
+        }
+
+        // Keep the memory in the block until the garbage collection is finished (the whole block
+        // might be freed).
+        pBlock->pPendingFreeSlots = new (pMemory) FreeSlot{
+            .pNext = static_cast<FreeSlot*>(pBlock->pPendingFreeSlots),
+            .iSizeClass = (iSizeInBytes + iGranularity - 1) / iGranularity};
+
+        pBlock->iAliveCount -= 1;
+        iAliveCount -= 1;
+    }
+
+    void GcNursery::onGarbageCollectionFinished() {
+        bool bFreeListsReferenceEmptyBlocks = false;
+
+        for (const auto& pBlock : vBlocks) {
+            if (pBlock->iAliveCount == 0) {
+                // The whole block will be freed (or reused if it's the current block).
+                bFreeListsReferenceEmptyBlocks |= pBlock->bHasListedFreeSlots;
+                continue;
+            }
+
+            // Move freed memory to free lists.
+            auto pSlot = static_cast<FreeSlot*>(pBlock->pPendingFreeSlots);
+            while (pSlot != nullptr) {
+                const auto pNext = pSlot->pNext;
+                pSlot->pNext = vFreeSlots[pSlot->iSizeClass];
+                vFreeSlots[pSlot->iSizeClass] = pSlot;
+                pSlot = pNext;
+            }
+            if (pBlock->pPendingFreeSlots != nullptr) {
+                pBlock->pPendingFreeSlots = nullptr;
+                pBlock->bHasListedFreeSlots = true;
+            }
+        }
+
+        if (bFreeListsReferenceEmptyBlocks) {
+            // Remove memory of empty blocks from free lists.
+            for (auto& pFirstSlot : vFreeSlots) {
+                FreeSlot** ppSlot = &pFirstSlot;
+                while (*ppSlot != nullptr) {
+                    if (getBlock(*ppSlot)->iAliveCount == 0) {
+                        *ppSlot = (*ppSlot)->pNext;
+                    } else {
+                        ppSlot = &(*ppSlot)->pNext;
+                    }
+                }
+            }
+        }
+
+        // Free empty blocks (except for the current one which is reset).
+        std::erase_if(vBlocks, [this](Block* pBlock) {
+            if (pBlock->iAliveCount != 0) {
+                return false;
+            }
+
+            if (pBlock == pCurrentBlock) {
+                pBlock->pPendingFreeSlots = nullptr;
+                pBlock->bHasListedFreeSlots = false;
+                pCurrent = reinterpret_cast<std::byte*>(pBlock) + iFirstSlotOffset;
+                return false;
+            }
+
+            freeBlock(pBlock);
+            return true;
+        });
+    }
+
+    bool GcNursery::isEmpty() const { return iAliveCount == 0; }
+
+    size_t GcNursery::getReservedSize() const { return vBlocks.size() * iBlockSize; }
+
+    GcNursery::Block* GcNursery::getBlock(void* pMemory) {
+        return reinterpret_cast<Block*>(reinterpret_cast<uintptr_t>(pMemory) & ~(iBlockSize - 1));
+    }
+
+    void GcNursery::freeBlock(Block* pBlock) {
+        pBlock->~Block();
+        ::operator delete(pBlock, iBlockSize, std::align_val_t{iBlockSize});
+    }
+
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+// Standard.
+#include <array>
+#include <vector>
+#include <cstddef>
+
+namespace sgc {
+    /**
+     * Bump-pointer memory for new small objects of a garbage collector (when enabled using
+     * `GarbageCollector::setUseNursery`).
+     *
+     * Memory is taken from aligned blocks by moving a pointer. After a garbage collection blocks without
+     * alive objects are freed as a whole while memory of deleted objects from surviving blocks is moved
+     * to free lists (one per size class) that are used before moving the pointer.
+     *
+     * @remark Only provides memory: allocation records of objects in the nursery are created and tracked
+     * by the garbage collector like records of other objects (see `GarbageCollector::setUseNursery`).
+     *
+     * @remark Not thread-safe, used while the garbage collector's mutex is locked.
+     */
+    class GcNursery {
+    public:
+        /** Size in bytes of a block (blocks are aligned to their size). */
+        static constexpr size_t iBlockSize = 64 * 1024; // NOLINT
+
+        /** Maximum size in bytes of a memory block that can be allocated in the nursery. */
+        static constexpr size_t iMaxAllocationSize = 4 * 1024; // NOLINT
+
+        /** Sizes of allocated memory blocks are rounded up to a multiple of this value. */
+        static constexpr size_t iGranularity = 16; // NOLINT
+
+        GcNursery() = default;
+
+        /** Frees all blocks. */
+        ~GcNursery();
+
+        GcNursery(const GcNursery&) = delete;
+        GcNursery& operator=(const GcNursery&) = delete;
+
+        GcNursery(GcNursery&&) noexcept = delete;
+        GcNursery& operator=(GcNursery&&) noexcept = delete;
+
+        /**
+         * Tells if a memory block of the specified size and alignment can be allocated in the nursery.
+         *
+         * @param iSizeInBytes Size of the memory block.
+         * @param iAlignment   Alignment of the memory block (power of 2).
+         *
+         * @return `true` if can be allocated using @ref allocate, `false` otherwise.
+         */
+        static bool canAllocate(size_t iSizeInBytes, size_t iAlignment);
+
+        /**
+         * Allocates a memory block.
+         *
+         * @remark Throws `std::bad_alloc` if failed.
+         *
+         * @param iSizeInBytes Size of the memory block (see @ref canAllocate).
+         *
+         * @return Allocated memory (aligned to @ref iGranularity).
+         */
+        void* allocate(size_t iSizeInBytes);
+
+        /**
+         * Frees a memory block previously returned by @ref allocate (the memory is reused after the
+         * garbage collection finishes).
+         *
+         * @param pMemory      Allocated memory.
+         * @param iSizeInBytes Size that was passed to @ref allocate.
+         */
+        void free(void* pMemory, size_t iSizeInBytes);
+
+        /**
+         * Must be called after the garbage collector finished its sweep phase to free blocks without alive
+         * objects and make memory of deleted objects available for new allocations.
+         */
+        void onGarbageCollectionFinished();
+
+        /**
+         * Tells if the nursery has no alive memory blocks.
+         *
+         * @return `true` if all allocated memory blocks were freed, `false` otherwise.
+         */
+        bool isEmpty() const;
+
+        /**
+         * Returns the total size of blocks taken by the nursery.
+         *
+         * @return Size in bytes.
+         */
+        size_t getReservedSize() const;
+
+    private:
+        /** Header stored in the beginning of each block. */
+        struct Block {
+            /** Number of allocated memory blocks that were not freed yet. */
+            size_t iAliveCount = 0;
+
+            /** Freed memory of this block that was not yet moved to free lists. */
+            void* pPendingFreeSlots = nullptr;
+
+            /** Whether some memory of this block is stored in free lists. */
+            bool bHasListedFreeSlots = false;
+        };
+
+        /** Header stored in freed memory. */
+        struct FreeSlot {
+            /** Next freed memory block. */
+            FreeSlot* pNext = nullptr;
+
+            /** Index into @ref vFreeSlots. */
+            size_t iSizeClass = 0;
+        };
+
+        /** Number of size classes (one per @ref iGranularity step). */
+        static constexpr size_t iSizeClassCount = iMaxAllocationSize / iGranularity + 1;
+
+        /** Offset from the start of a block to its first memory block. */
+        static constexpr size_t iFirstSlotOffset =
+            (sizeof(Block) + iGranularity - 1) / iGranularity * iGranularity;
+
+        /**
+         * Returns block that the specified memory belongs to.
+         *
+         * @param pMemory Memory returned by @ref allocate.
+         *
+         * @return Block.
+         */
+        static Block* getBlock(void* pMemory);
+
+        /**
+         * Frees memory of the specified block.
+         *
+         * @param pBlock Block to free.
+         */
+        static void freeBlock(Block* pBlock);
+
+        /** Allocated blocks. */
+        std::vector<Block*> vBlocks;
+
+        /** Freed memory blocks of surviving blocks (index is a size class). */
+        std::array<FreeSlot*, iSizeClassCount> vFreeSlots{};
+
+        /** Block that new memory is taken from by moving @ref pCurrent. */
+        Block* pCurrentBlock = nullptr;
+
+        /** Start of the free memory in the current block. */
+        std::byte* pCurrent = nullptr;
+
+        /** End of the current block. */
+        std::byte* pEnd = nullptr;
+
+        /** Number of allocated memory blocks that were not freed yet. */
+        size_t iAliveCount = 0;
+    };
+}
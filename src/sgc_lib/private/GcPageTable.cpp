@@ -0,0 +1,158 @@
+#include "GcPageTable.h"
+
+// Standard.
+#include <bit>
+#include <stdexcept>
+
+// Custom.
+#include "GcInfoCallbacks.hpp"
+
+namespace sgc {
+
+    void GcPageTable::add(void* pMemory, size_t iSizeInBytes, void* pOwner) {
+        const auto iStart = reinterpret_cast<uintptr_t>(pMemory);
+        if (iStart % iGranularity != 0) [[unlikely]] {
+            GcInfoCallbacks::getCriticalErrorCallback()(
+                "memory block is not aligned to the granularity of the page table");
+            throw std::runtime_error("critical error");
+        }
+
+        // Add to the page where the memory block starts.
+        auto& startPage = getOrCreatePage(iStart);
+        const auto iGranule = iStart % iPageSize / iGranularity;
+        auto& iWord = startPage.vBlockStarts[iGranule / iBitsPerWord];
+        const auto iBit = uint64_t(1) << (iGranule % iBitsPerWord);
+        if ((iWord & iBit) != 0) [[unlikely]] {
+            GcInfoCallbacks::getCriticalErrorCallback()(
+                "memory block starts at the same address as another memory block in the page table");
+            throw std::runtime_error("critical error");
+        }
+        iWord |= iBit;
+        startPage.vStartingOwners.insert(
+            startPage.vStartingOwners.begin() +
+                static_cast<std::ptrdiff_t>(getStartingOwnerIndex(startPage, iGranule)),
+            pOwner);
+
+        // Mark other pages of the memory block.
+        const auto iLastPageStart = (iStart + iSizeInBytes - 1) & ~(iPageSize - 1);
+        for (auto iPageStart = (iStart & ~(iPageSize - 1)) + iPageSize; iPageStart <= iLastPageStart;
+             iPageStart += iPageSize) {
+            getOrCreatePage(iPageStart).pContinuingOwner = pOwner;
+        }
+    }
+
+    void GcPageTable::remove(void* pMemory, size_t iSizeInBytes) {
+        const auto iStart = reinterpret_cast<uintptr_t>(pMemory);
+
+        // Remove from the page where the memory block starts.
+        const auto pStartPage = findPage(iStart);
+        if (pStartPage == nullptr) [[unlikely]] {
+            return;
+        }
+        const auto iGranule = iStart % iPageSize / iGranularity;
+        auto& iWord = pStartPage->vBlockStarts[iGranule / iBitsPerWord];
+        const auto iBit = uint64_t(1) << (iGranule % iBitsPerWord);
+        if ((iWord & iBit) == 0) [[unlikely]] {
+            return;
+        }
+        pStartPage->vStartingOwners.erase(
+            pStartPage->vStartingOwners.begin() +
+            static_cast<std::ptrdiff_t>(getStartingOwnerIndex(*pStartPage, iGranule)));
+        iWord &= ~iBit;
+        freePageIfUnused(iStart);
+
+        // Unmark other pages of the memory block.
+        const auto iLastPageStart = (iStart + iSizeInBytes - 1) & ~(iPageSize - 1);
+        for (auto iPageStart = (iStart & ~(iPageSize - 1)) + iPageSize; iPageStart <= iLastPageStart;
+             iPageStart += iPageSize) {
+            const auto pPage = findPage(iPageStart);
+            if (pPage == nullptr) [[unlikely]] {
+                continue;
+            }
+
+            pPage->pContinuingOwner = nullptr;
+            freePageIfUnused(iPageStart);
+        }
+    }
+
+    void* GcPageTable::findOwner(const void* pAddress) const {
+        const auto iAddress = reinterpret_cast<uintptr_t>(pAddress);
+
+        const auto pPage = findPage(iAddress);
+        if (pPage == nullptr) {
+            return nullptr;
+        }
+
+        // Look for the closest memory block that starts at or before the address in the page.
+        const auto iGranule = iAddress % iPageSize / iGranularity;
+        auto iWordIndex = iGranule / iBitsPerWord;
+        auto iWord = pPage->vBlockStarts[iWordIndex] &
+                     (~uint64_t(0) >> (iBitsPerWord - 1 - iGranule % iBitsPerWord));
+        while (true) {
+            if (iWord != 0) {
+                const auto iStartGranule =
+                    iWordIndex * iBitsPerWord + (iBitsPerWord - 1 - std::countl_zero(iWord));
+                return pPage->vStartingOwners[getStartingOwnerIndex(*pPage, iStartGranule)];
+            }
+            if (iWordIndex == 0) {
+                break;
+            }
+            iWordIndex -= 1;
+            iWord = pPage->vBlockStarts[iWordIndex];
+        }
+
+        // The address might belong to a memory block from a previous page.
+        return pPage->pContinuingOwner;
+    }
+
+    size_t GcPageTable::getStartingOwnerIndex(const Page& page, size_t iGranule) {
+        const auto iWordIndex = iGranule / iBitsPerWord;
+
+        size_t iIndex = 0;
+        for (size_t i = 0; i < iWordIndex; i++) {
+            iIndex += static_cast<size_t>(std::popcount(page.vBlockStarts[i]));
+        }
+
+        const auto iLowerBits = (uint64_t(1) << (iGranule % iBitsPerWord)) - 1;
+        return iIndex + static_cast<size_t>(std::popcount(page.vBlockStarts[iWordIndex] & iLowerBits));
+    }
+
+    GcPageTable::Page& GcPageTable::getOrCreatePage(uintptr_t iAddress) {
+        auto& pLeaf = leavesByAddress[iAddress & ~(iLeafSize - 1)];
+        if (pLeaf == nullptr) {
+            pLeaf = std::make_unique<Leaf>();
+        }
+
+        auto& pPage = pLeaf->vPages[iAddress % iLeafSize / iPageSize];
+        if (pPage == nullptr) {
+            pPage = std::make_unique<Page>();
+            pLeaf->iUsedPageCount += 1;
+        }
+
+        return *pPage;
+    }
+
+    GcPageTable::Page* GcPageTable::findPage(uintptr_t iAddress) const {
+        const auto leafIt = leavesByAddress.find(iAddress & ~(iLeafSize - 1));
+        if (leafIt == leavesByAddress.end()) {
+            return nullptr;
+        }
+
+        return leafIt->second->vPages[iAddress % iLeafSize / iPageSize].get();
+    }
+
+    void GcPageTable::freePageIfUnused(uintptr_t iAddress) {
+        const auto leafIt = leavesByAddress.find(iAddress & ~(iLeafSize - 1));
+        auto& pPage = leafIt->second->vPages[iAddress % iLeafSize / iPageSize];
+        if (pPage->pContinuingOwner != nullptr || !pPage->vStartingOwners.empty()) {
+            return;
+        }
+
+        pPage = nullptr;
+        leafIt->second->iUsedPageCount -= 1;
+        if (leafIt->second->iUsedPageCount == 0) {
+            leavesByAddress.erase(leafIt);
+        }
+    }
+
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+// Standard.
+#include <array>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+
+namespace sgc {
+    /**
+     * Finds owners of memory blocks that are not in a GC heap (nursery, regions, large object space
+     * and other memory sources) by an address of any byte of the memory block.
+     *
+     * Memory is split into pages, each page stores a bitmap of granules where memory blocks start,
+     * owners of these memory blocks (ordered by address) and the owner of a memory block that starts
+     * in a previous page and continues in this page. Pages are grouped into leaves that are found by
+     * their start address (one leaf per @ref iLeafSize bytes of memory) so adding, removing and
+     * looking for a memory block takes constant time (adding and removing a memory block that spans
+     * multiple pages also updates each of its pages).
+     *
+     * @remark Not thread-safe, used while the garbage collector's mutex is locked.
+     */
+    class GcPageTable {
+    public:
+        /** Size in bytes of a page. */
+        static constexpr size_t iPageSize = 4 * 1024; // NOLINT: usual OS page size
+
+        /** Size in bytes of memory described by one leaf. */
+        static constexpr size_t iLeafSize = 2 * 1024 * 1024; // NOLINT
+
+        /** Memory blocks must start at addresses that are multiples of this value. */
+        static constexpr size_t iGranularity = 16; // NOLINT
+
+        GcPageTable() = default;
+
+        GcPageTable(const GcPageTable&) = delete;
+        GcPageTable& operator=(const GcPageTable&) = delete;
+
+        GcPageTable(GcPageTable&&) noexcept = delete;
+        GcPageTable& operator=(GcPageTable&&) noexcept = delete;
+
+        /**
+         * Remembers an owner of the specified memory block so that it can be found by an address of any
+         * byte of the memory block (see @ref findOwner).
+         *
+         * @remark Triggers a critical error if the memory block is not aligned to @ref iGranularity
+         * or if another memory block starts at the same address.
+         *
+         * @param pMemory      Start of the memory block.
+         * @param iSizeInBytes Size of the memory block.
+         * @param pOwner       Owner of the memory block.
+         */
+        void add(void* pMemory, size_t iSizeInBytes, void* pOwner);
+
+        /**
+         * Forgets the owner of a memory block previously specified in @ref add.
+         *
+         * @param pMemory      Start of the memory block.
+         * @param iSizeInBytes Size of the memory block.
+         */
+        void remove(void* pMemory, size_t iSizeInBytes);
+
+        /**
+         * Looks for the owner of the memory block that contains the specified address.
+         *
+         * @remark Memory blocks are expected to not overlap, the returned owner might not contain the
+         * address if the address does not belong to any memory block (the caller should check it).
+         *
+         * @param pAddress Address of any byte of a memory block.
+         *
+         * @return `nullptr` if there are no memory blocks at or before the address in its page,
+         * otherwise owner of the closest memory block that starts at or before the address.
+         */
+        void* findOwner(const void* pAddress) const;
+
+    private:
+        /** Number of granules in a page. */
+        static constexpr size_t iGranulesPerPage = iPageSize / iGranularity;
+
+        /** Number of bits in a word of bitmaps of pages. */
+        static constexpr size_t iBitsPerWord = 64; // NOLINT
+
+        /** Number of pages in a leaf. */
+        static constexpr size_t iPagesPerLeaf = iLeafSize / iPageSize;
+
+        /** Describes memory blocks of a page. */
+        struct Page {
+            /** Owner of a memory block that starts in a previous page and continues in this page. */
+            void* pContinuingOwner = nullptr;
+
+            /** Bits of granules where memory blocks start. */
+            std::array<uint64_t, iGranulesPerPage / iBitsPerWord> vBlockStarts{};
+
+            /** Owners of memory blocks that start in this page (ordered by address). */
+            std::vector<void*> vStartingOwners;
+        };
+
+        /** Pages of @ref iLeafSize bytes of memory. */
+        struct Leaf {
+            /** Pages that describe some memory blocks (`nullptr` otherwise). */
+            std::array<std::unique_ptr<Page>, iPagesPerLeaf> vPages;
+
+            /** Number of not `nullptr` pages in @ref vPages. */
+            size_t iUsedPageCount = 0;
+        };
+
+        /**
+         * Returns number of memory blocks that start in the specified page before the specified granule.
+         *
+         * @param page     Page.
+         * @param iGranule Index of a granule in the page.
+         *
+         * @return Index into @ref Page::vStartingOwners.
+         */
+        static size_t getStartingOwnerIndex(const Page& page, size_t iGranule);
+
+        /**
+         * Returns page that contains the specified address, creates the page if it does not exist.
+         *
+         * @param iAddress Address of any byte of the page.
+         *
+         * @return Page.
+         */
+        Page& getOrCreatePage(uintptr_t iAddress);
+
+        /**
+         * Returns page that contains the specified address.
+         *
+         * @param iAddress Address of any byte of the page.
+         *
+         * @return `nullptr` if the page does not exist.
+         */
+        Page* findPage(uintptr_t iAddress) const;
+
+        /**
+         * Frees the page that contains the specified address (and its leaf) if it describes no memory
+         * blocks.
+         *
+         * @param iAddress Address of any byte of an existing page.
+         */
+        void freePageIfUnused(uintptr_t iAddress);
+
+        /** Leaves by their start address (aligned to @ref iLeafSize). */
+        std::unordered_map<uintptr_t, std::unique_ptr<Leaf>> leavesByAddress;
+    };
+}
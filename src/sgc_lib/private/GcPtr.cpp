@@ -2,39 +2,70 @@
 
 // Standard.
 #include <stdexcept>
+#include <cstdint>
+#include <limits>
 
 // Custom.
 #include "GarbageCollector.h"
 #include "GcInfoCallbacks.hpp"
+#include "GcThreadStack.h"
+#include "GcContainerBase.h"
+#include "GcAllocationConstructionGuard.h"
 
 namespace sgc {
 
-    GcPtrBase::GcPtrBase(bool bCanBeRootNode) {
+    GcPtrBase::GcPtrBase(bool bCanBeRootNode) : GcPtrBase(bCanBeRootNode, &GarbageCollector::get()) {}
+
+    GcPtrBase::GcPtrBase(bool bCanBeRootNode, GarbageCollector* pGarbageCollector)
+        : GcNode(pGarbageCollector) {
         // Make sure we can be a root node.
         if (!bCanBeRootNode) {
             return;
         }
 
+        // Captures of callables (and similar items) are reported by their GC container.
+        if (GcContainerBase::tryRegisteringConstructedItem(this)) {
+            return;
+        }
+
+        // Local variables on a registered thread stack are found by scanning the stack (nodes of
+        // thread-local and region garbage collectors need to be in the root set to be moved to the shared
+        // garbage collector).
+        if (getGarbageCollector()->getSharedGarbageCollector() == nullptr &&
+            GcThreadStack::tryRegisteringScannedNode(this)) {
+            setIsRootNode(true);
+            setIsScannedNode();
+            return;
+        }
+
         // Notify garbage collector.
-        setIsRootNode(GarbageCollector::get().onGcNodeConstructed(this));
+        setIsRootNode(getGarbageCollector()->onGcNodeConstructed(this));
 
         SGC_DEBUG_LOG(std::format(
             "GcPtr {} is constructed (is root node: {})", reinterpret_cast<uintptr_t>(this), isRootNode()));
     }
 
     void GcPtrBase::onGcPtrBeingDestroyed() {
-        // Make sure no GcPtr will be destroyed while garbage collection is running
-        // otherwise GC might stumble upon deleted memory.
-        std::scoped_lock guard(*GarbageCollector::get().getGarbageCollectionMutex());
-
         SGC_DEBUG_LOG(std::format(
             "GcPtr {} is being destroyed (is root node: {})",
             reinterpret_cast<uintptr_t>(this),
             isRootNode()));
 
-        if (isRootNode()) {
+        // Pointers on registered stacks are not in the root set and only need to release the reference.
+        if (tryClearScannedNode()) {
+            return;
+        }
+
+        // Make sure no GcPtr will be destroyed while garbage collection is running
+        // otherwise GC might stumble upon deleted memory.
+        std::scoped_lock guard(*getGarbageCollector()->getGarbageCollectionMutex());
+
+        // Release the reference.
+        setAllocation(nullptr);
+
+        if (isRootNode() && !isScannedNode()) {
             // Notify garbage collector.
-            GarbageCollector::get().onGcRootNodeBeingDestroyed(this);
+            getGarbageCollector()->onGcRootNodeBeingDestroyed(this);
         }
     }
 
@@ -42,12 +73,16 @@ namespace sgc {
         // Prepare the error message in case we need it.
         static constexpr auto pNotGcPointerErrorMessage =
             "failed to set the specified raw pointer to a GC pointer because the specified object "
-            "(in the raw pointer) either: was previously not created from a \"make gc\" call or you tried "
-            "casting to a non-first parent in a type that uses multiple inheritance (which is not supported)";
+            "(in the raw pointer) either: was previously not created from a \"make gc\" call "
+            "or the object belongs to a different garbage collector";
+
+        if (pUserObject == nullptr && tryClearScannedNode()) {
+            return;
+        }
 
         // Acquire allocations data and make sure GC is not using node graph now.
-        std::scoped_lock guard(GarbageCollector::get().mtxGcData.first);
-        auto& allocationInfos = GarbageCollector::get().mtxGcData.second.allocationData.allocationInfoRefs;
+        std::scoped_lock guard(getGarbageCollector()->mtxGcData.first);
+        auto& allocationInfos = getGarbageCollector()->mtxGcData.second.allocationData.allocationInfoRefs;
 
         SGC_DEBUG_LOG(std::format(
             "GcPtr {} set user object {}",
@@ -57,7 +92,7 @@ namespace sgc {
         // Check if the specified pointer is valid.
         if (pUserObject == nullptr) {
             // Just clear the pointer (keep the GC mutex locked while changing the pointer).
-            pAllocation = nullptr;
+            setAllocation(nullptr);
             return;
         }
 
@@ -79,6 +114,26 @@ namespace sgc {
         // Find this allocation in the garbage collector's "database" to make sure the pointer is valid.
         const auto allocationInfoIt = allocationInfos.find(pNewAllocationInfo);
         if (allocationInfoIt == allocationInfos.end()) [[unlikely]] {
+            // Maybe a pointer inside of an object (for example to a non-primary base type).
+            const auto pContainingAllocation = getGarbageCollector()->findAllocationContaining(pUserObject);
+            if (pContainingAllocation != nullptr) {
+                setAllocation(pContainingAllocation, getUserObjectOffset(pContainingAllocation, pUserObject));
+                return;
+            }
+
+            // Maybe this is a thread-local object that escapes to our garbage collector.
+            const auto pGarbageCollector = getGarbageCollector();
+            auto pThreadLocalAllocation = pGarbageCollector->findThreadLocalAllocation(pNewAllocationInfo);
+            if (pThreadLocalAllocation == nullptr) {
+                pThreadLocalAllocation = pGarbageCollector->findThreadLocalAllocationContaining(pUserObject);
+            }
+            if (pThreadLocalAllocation != nullptr) {
+                getGarbageCollector()->promoteAllocation(pThreadLocalAllocation);
+                setAllocation(
+                    pThreadLocalAllocation, getUserObjectOffset(pThreadLocalAllocation, pUserObject));
+                return;
+            }
+
             // Not a valid GC object.
             SGC_DEBUG_LOG(std::format(
                 "failed to find user object {} for GcPtr {} to set",
@@ -89,16 +144,129 @@ namespace sgc {
         }
 
         // Save allocation.
-        pAllocation = allocationInfoIt->second;
+        setAllocation(allocationInfoIt->second);
+    }
+
+    void GcPtrBase::setAllocationFromOtherPointer(const GcPtrBase& pOther) {
+        if (pOther.pAllocation == nullptr && tryClearScannedNode()) {
+            return;
+        }
+
+        // Make sure GC is not using node graph now (stacks are not copied all at once so storing
+        // a reference into a scanned node without the lock might hide it from a garbage collection
+        // if the source pointer is cleared right after that).
+        std::scoped_lock guard(getGarbageCollector()->mtxGcData.first);
+
+        SGC_DEBUG_LOG(std::format(
+            "GcPtr {} copy allocation {} from GcPtr {}",
+            reinterpret_cast<uintptr_t>(this),
+            reinterpret_cast<uintptr_t>(pOther.pAllocation.get()),
+            reinterpret_cast<uintptr_t>(&pOther)));
+
+        getGarbageCollector()->onAllocationBeingReferenced(pOther.pAllocation);
+
+        setAllocation(pOther.pAllocation, pOther.iUserObjectOffset);
+    }
+
+    void GcPtrBase::moveAllocationFromOtherPointer(GcPtrBase& pOther) {
+        if (pOther.pAllocation == nullptr && tryClearScannedNode()) {
+            return;
+        }
+
+        // Make sure GC is not using node graph now (change both pointers under a single lock
+        // so that the GC will see the allocation in at least one of them).
+        std::scoped_lock guard(getGarbageCollector()->mtxGcData.first);
+
+        SGC_DEBUG_LOG(std::format(
+            "GcPtr {} move allocation {} from GcPtr {}",
+            reinterpret_cast<uintptr_t>(this),
+            reinterpret_cast<uintptr_t>(pOther.pAllocation.get()),
+            reinterpret_cast<uintptr_t>(&pOther)));
+
+        getGarbageCollector()->onAllocationBeingReferenced(pOther.pAllocation);
+
+        setAllocation(pOther.pAllocation, pOther.iUserObjectOffset);
+        pOther.setAllocation(nullptr);
+    }
+
+    void GcPtrBase::setAllocationFromKnownAllocation(GcAllocation* pKnownAllocation, void* pUserObject) {
+        // Make sure GC is not using node graph now.
+        std::scoped_lock guard(getGarbageCollector()->mtxGcData.first);
+
+        getGarbageCollector()->onAllocationBeingReferenced(pKnownAllocation);
+
+        setAllocation(pKnownAllocation, getUserObjectOffset(pKnownAllocation, pUserObject));
+    }
+
+    GcPtrBase::UserObjectOffset GcPtrBase::getUserObjectOffset(GcAllocation* pAllocation, void* pUserObject) {
+        const auto iOffset = static_cast<size_t>(
+            static_cast<char*>(pUserObject) - static_cast<char*>(pAllocation->getAllocatedObject()));
+        if (iOffset > std::numeric_limits<UserObjectOffset>::max()) [[unlikely]] {
+            GcInfoCallbacks::getCriticalErrorCallback()(
+                "a GC pointer points too far from the start of an object");
+            throw std::runtime_error("critical error");
+        }
+
+        return static_cast<UserObjectOffset>(iOffset);
+    }
+
+    bool GcPtrBase::tryClearScannedNode() {
+        if (!isScannedNode()) {
+            return false;
+        }
+
+        pAllocation.clearAtomically();
+        iUserObjectOffset = 0;
+
+        return true;
     }
 
-    void* GcPtrBase::getUserObject() const {
-        // Make sure allocation is valid.
+    void GcPtrBase::setAllocationPinned(bool bPin) {
+        std::scoped_lock guard(getGarbageCollector()->mtxGcData.first);
+
         if (pAllocation == nullptr) {
-            return nullptr;
+            return;
+        }
+
+        if (bPin) {
+            pAllocation->pin();
+        } else {
+            pAllocation->unpin();
+        }
+    }
+
+    GarbageCollector*
+    GcPtrBase::pickGarbageCollector(const void* pNewPointer, bool bCanBeRootNode, const GcPtrBase& pOther) {
+        const auto pOtherGarbageCollector = pOther.getGarbageCollector();
+        const auto pBoundGarbageCollector = &GarbageCollector::get();
+        if (pOtherGarbageCollector == pBoundGarbageCollector) [[likely]] {
+            return pOtherGarbageCollector;
+        }
+
+        // Fields of objects being constructed belong to the object's garbage collector.
+        if (const auto pOwner = GcAllocationConstructionGuard::getConstructingAllocation(pNewPointer)) {
+            return pOwner->getGarbageCollector();
+        }
+
+        // Items created by a container belong to the container's garbage collector (item-typed pointers
+        // created outside of a container, such as temporaries converted from a returned pointer, are
+        // checked when the container copies or moves them).
+        if (!bCanBeRootNode || GcContainerBase::isConstructingItem(pNewPointer)) {
+            if (const auto pContainerGarbageCollector = GcContainerBase::getModifyingGarbageCollector()) {
+                return pContainerGarbageCollector;
+            }
+        }
+
+        // Thread-local objects escape to the shared garbage collector once they are referenced from data
+        // of the shared garbage collector or from another thread (which might outlive the owning thread).
+        const auto pOtherSharedGarbageCollector = pOtherGarbageCollector->getSharedGarbageCollector();
+        if (pOtherSharedGarbageCollector != nullptr &&
+            (pOtherSharedGarbageCollector == GarbageCollector::pThreadGarbageCollector ||
+             !pOtherGarbageCollector->isOwnedByCurrentThread())) {
+            return pOtherSharedGarbageCollector;
         }
 
-        return pAllocation->getAllocatedObject();
+        return pOtherGarbageCollector;
     }
 
 }
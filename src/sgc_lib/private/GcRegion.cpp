@@ -0,0 +1,35 @@
+#include "GcRegion.h"
+
+// Standard.
+#include <stdexcept>
+
+// Custom.
+#include "GcRegionArena.h"
+#include "GcInfoCallbacks.hpp"
+
+namespace sgc {
+
+    GcRegion::GcRegion() : garbageCollector(getParentGarbageCollector()), scope(garbageCollector) {
+        // New small objects will use bump-pointer memory.
+        std::scoped_lock guard(garbageCollector.mtxGcData.first);
+        garbageCollector.mtxGcData.second.allocationData.pRegionArena = std::make_shared<GcRegionArena>();
+    }
+
+    GcRegion::~GcRegion() { garbageCollector.onRegionEnded(); }
+
+    GarbageCollector& GcRegion::getGarbageCollector() { return garbageCollector; }
+
+    GarbageCollector& GcRegion::getParentGarbageCollector() {
+        auto& parentGarbageCollector = GarbageCollector::get();
+
+        if (parentGarbageCollector.getSharedGarbageCollector() != nullptr) [[unlikely]] {
+            GcInfoCallbacks::getCriticalErrorCallback()(
+                "a GC region can't be created while another region or a thread-local garbage collector is "
+                "bound to the thread");
+            throw std::runtime_error("critical error");
+        }
+
+        return parentGarbageCollector;
+    }
+
+}
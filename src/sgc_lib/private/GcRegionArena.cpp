@@ -0,0 +1,53 @@
+#include "GcRegionArena.h"
+
+// Standard.
+#include <new>
+#include <stdexcept>
+
+// Custom.
+#include "GcInfoCallbacks.hpp"
+
+namespace sgc {
+
+    bool GcRegionArena::canAllocate(size_t iSizeInBytes, size_t iAlignment) {
+        // Worst case padding is `iAlignment - 1` since chunks are aligned to the default `new` alignment.
+        return iSizeInBytes + iAlignment <= iMaxAllocationSize;
+    }
+
+    void* GcRegionArena::allocate(size_t iSizeInBytes, size_t iAlignment) {
+        // Align the current position.
+        const auto iCurrent = reinterpret_cast<uintptr_t>(pCurrent);
+        const auto iAligned = (iCurrent + (iAlignment - 1)) & ~(iAlignment - 1);
+        auto pMemory = reinterpret_cast<std::byte*>(iAligned);
+
+        if (pCurrent == nullptr || pMemory + iSizeInBytes > pEnd) {
+            // Take a new chunk.
+            vChunks.push_back(std::make_unique_for_overwrite<std::byte[]>(iChunkSize));
+            pCurrent = vChunks.back().get();
+            pEnd = pCurrent + iChunkSize;
+
+            const auto iChunkStart = reinterpret_cast<uintptr_t>(pCurrent);
+            pMemory = reinterpret_cast<std::byte*>((iChunkStart + (iAlignment - 1)) & ~(iAlignment - 1));
+        }
+
+        pCurrent = pMemory + iSizeInBytes;
+        iAliveBlockCount += 1;
+
+        return pMemory;
+    }
+
+    void GcRegionArena::free(void* pMemory) {
+        if (iAliveBlockCount == 0) [[unlikely]] {
+            GcInfoCallbacks::getCriticalErrorCallback()(
+                "attempted to free more memory blocks than were allocated in the region");
+            throw std::runtime_error("critical error");
+        }
+
+        iAliveBlockCount -= 1;
+    }
+
+    bool GcRegionArena::isEmpty() const { return iAliveBlockCount == 0; }
+
+    size_t GcRegionArena::getReservedSize() const { return vChunks.size() * iChunkSize; }
+
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+// Standard.
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+namespace sgc {
+    /**
+     * Bump-pointer memory used by objects allocated inside of a @ref GcRegion.
+     *
+     * Memory is taken from big chunks by moving a pointer, freeing a memory block only decrements
+     * the number of alive blocks. Chunks are released all at once when the arena is destroyed.
+     *
+     * @remark Not thread-safe, used while the garbage collector's mutex is locked.
+     */
+    class GcRegionArena {
+    public:
+        /** Size in bytes of a chunk of memory that blocks are taken from. */
+        static constexpr size_t iChunkSize = 64 * 1024; // NOLINT
+
+        /** Maximum size in bytes of a memory block that can be allocated in the arena. */
+        static constexpr size_t iMaxAllocationSize = 8 * 1024; // NOLINT
+
+        GcRegionArena() = default;
+
+        GcRegionArena(const GcRegionArena&) = delete;
+        GcRegionArena& operator=(const GcRegionArena&) = delete;
+
+        GcRegionArena(GcRegionArena&&) noexcept = delete;
+        GcRegionArena& operator=(GcRegionArena&&) noexcept = delete;
+
+        /**
+         * Tells if a memory block of the specified size and alignment can be allocated in the arena.
+         *
+         * @param iSizeInBytes Size of the memory block.
+         * @param iAlignment   Alignment of the memory block (power of 2).
+         *
+         * @return `true` if can be allocated using @ref allocate, `false` otherwise.
+         */
+        static bool canAllocate(size_t iSizeInBytes, size_t iAlignment);
+
+        /**
+         * Allocates a memory block.
+         *
+         * @remark Throws `std::bad_alloc` if failed.
+         *
+         * @param iSizeInBytes Size of the memory block (see @ref canAllocate).
+         * @param iAlignment   Alignment of the memory block (see @ref canAllocate).
+         *
+         * @return Allocated memory.
+         */
+        void* allocate(size_t iSizeInBytes, size_t iAlignment);
+
+        /**
+         * Marks a memory block previously returned by @ref allocate as no longer used (the memory
+         * is not reused).
+         *
+         * @param pMemory Allocated memory.
+         */
+        void free(void* pMemory);
+
+        /**
+         * Tells if the arena has no alive memory blocks.
+         *
+         * @return `true` if all allocated blocks were freed, `false` otherwise.
+         */
+        bool isEmpty() const;
+
+        /**
+         * Returns the total size of chunks taken by the arena.
+         *
+         * @return Size in bytes.
+         */
+        size_t getReservedSize() const;
+
+    private:
+        /** Chunks of memory that blocks are taken from (the last one is the current chunk). */
+        std::vector<std::unique_ptr<std::byte[]>> vChunks;
+
+        /** Start of the free memory in the current chunk. */
+        std::byte* pCurrent = nullptr;
+
+        /** End of the current chunk. */
+        std::byte* pEnd = nullptr;
+
+        /** Number of allocated blocks that were not freed yet. */
+        size_t iAliveBlockCount = 0;
+    };
+}
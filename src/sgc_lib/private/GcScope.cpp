@@ -0,0 +1,15 @@
+#include "GcScope.h"
+
+// Custom.
+#include "GarbageCollector.h"
+
+namespace sgc {
+
+    GcScope::GcScope(GarbageCollector& garbageCollector)
+        : pPreviousGarbageCollector(GarbageCollector::pThreadGarbageCollector) {
+        GarbageCollector::pThreadGarbageCollector = &garbageCollector;
+    }
+
+    GcScope::~GcScope() { GarbageCollector::pThreadGarbageCollector = pPreviousGarbageCollector; }
+
+}
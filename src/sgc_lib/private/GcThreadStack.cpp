@@ -0,0 +1,158 @@
+#include "GcThreadStack.h"
+
+// Standard.
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+
+// Custom.
+#include "GcVirtualMemory.h"
+
+namespace sgc {
+
+    namespace {
+        /** Registration of the calling thread's stack (`nullptr` if not registered). */
+        thread_local GcThreadStack* pCurrentThreadStack = nullptr;
+
+        /** Size of memory copied at once when copying a stack. */
+        constexpr size_t iStackCopyChunkSize = 64 * 1024; // NOLINT: a few syscalls for a typical stack
+
+        /**
+         * Returns registered stacks of all threads.
+         *
+         * @return Registered stacks.
+         */
+        std::pair<std::mutex, std::vector<GcThreadStack*>>& getRegisteredStacks() {
+            static std::pair<std::mutex, std::vector<GcThreadStack*>> mtxRegisteredStacks;
+            return mtxRegisteredStacks;
+        }
+    }
+
+    GcThreadStack::GcThreadStack() {
+        if (pCurrentThreadStack != nullptr) {
+            // Already registered by an outer object.
+            return;
+        }
+
+        if (!GcVirtualMemory::canReadMemory()) [[unlikely]] {
+            // Stacks can't be copied, GC pointers will be registered as root nodes.
+            return;
+        }
+
+        GcVirtualMemory::getCurrentThreadStack(pStackLow, pStackHigh);
+        pScannedNodesLow.store(pStackHigh, std::memory_order_relaxed);
+        bRegistered = true;
+
+        auto& mtxRegisteredStacks = getRegisteredStacks();
+        std::scoped_lock guard(mtxRegisteredStacks.first);
+        mtxRegisteredStacks.second.push_back(this);
+        pCurrentThreadStack = this;
+    }
+
+    GcThreadStack::~GcThreadStack() {
+        if (!bRegistered) {
+            return;
+        }
+
+        // Wait for a garbage collection that might be scanning this stack.
+        auto& mtxRegisteredStacks = getRegisteredStacks();
+        std::scoped_lock guard(mtxRegisteredStacks.first);
+        std::erase(mtxRegisteredStacks.second, this);
+        pCurrentThreadStack = nullptr;
+    }
+
+    bool GcThreadStack::isOnCurrentThreadStack(const void* pAddress) {
+        const auto pThreadStack = pCurrentThreadStack;
+        if (pThreadStack == nullptr) {
+            return false;
+        }
+
+        const auto iAddress = reinterpret_cast<uintptr_t>(pAddress);
+        return iAddress >= reinterpret_cast<uintptr_t>(pThreadStack->pStackLow) &&
+               iAddress < reinterpret_cast<uintptr_t>(pThreadStack->pStackHigh);
+    }
+
+    bool GcThreadStack::tryRegisteringScannedNode(const void* pAddress) {
+        if (!isOnCurrentThreadStack(pAddress)) {
+            return false;
+        }
+
+        // Only the owning thread writes this value so a relaxed load and store are enough.
+        auto& pScannedNodesLow = pCurrentThreadStack->pScannedNodesLow;
+        if (reinterpret_cast<uintptr_t>(pAddress) <
+            reinterpret_cast<uintptr_t>(pScannedNodesLow.load(std::memory_order_relaxed))) {
+            pScannedNodesLow.store(static_cast<const std::byte*>(pAddress), std::memory_order_relaxed);
+        }
+
+        return true;
+    }
+
+    void GcThreadStack::forEachRegisteredStack(
+        const std::function<void(const std::byte*, size_t)>& onStack) {
+        constexpr auto iAlignmentMask = ~static_cast<uintptr_t>(15); // NOLINT: copies are aligned to 16
+
+        // Frames of our callers are above this variable (the rest of the current thread's stack is unused).
+        volatile std::byte currentFrameMarker{};
+        const auto iCurrentFrame = reinterpret_cast<uintptr_t>(&currentFrameMarker) & iAlignmentMask;
+
+        // Other threads keep running while we copy their stacks. This is safe because every mutation of a
+        // GC pointer that stores a reference locks the garbage collector's mutex (which our caller holds),
+        // only clearing a GC pointer on a registered stack is a lock-free atomic store (at worst we see the
+        // old reference and keep its object alive until the next collection). So a GC pointer that
+        // references an object stored the reference before we locked the mutex, and its constructor lowered
+        // `pScannedNodesLow` even earlier on the same thread (the mutex makes this store visible to us). GC
+        // pointers constructed below the value we read are still empty.
+
+        // Keep registered threads from unregistering (and exiting) while we read their stacks.
+        auto& mtxRegisteredStacks = getRegisteredStacks();
+        std::scoped_lock guard(mtxRegisteredStacks.first);
+
+        for (const auto& pThreadStack : mtxRegisteredStacks.second) {
+            const auto iStackHigh = reinterpret_cast<uintptr_t>(pThreadStack->pStackHigh);
+            const auto iScannedNodesLow =
+                reinterpret_cast<uintptr_t>(pThreadStack->pScannedNodesLow.load(std::memory_order_relaxed)) &
+                iAlignmentMask;
+            const auto iStackLow = pThreadStack == pCurrentThreadStack
+                                       ? std::max(iCurrentFrame, iScannedNodesLow)
+                                       : iScannedNodesLow;
+
+            // Not touched by the memory allocator until written so unused stack space costs nothing.
+            const auto iStackSize = static_cast<size_t>(iStackHigh - iStackLow);
+            const auto pCopy = std::make_unique_for_overwrite<std::byte[]>(iStackSize);
+
+            // Copy from the top of the stack until we reach pages that are not mapped (the stack of the main
+            // thread grows on demand).
+            auto iCopiedLow = iStackHigh;
+            while (iCopiedLow > iStackLow) {
+                const auto iChunkLow =
+                    iCopiedLow - std::min<uintptr_t>(iCopiedLow - iStackLow, iStackCopyChunkSize);
+                if (GcVirtualMemory::tryReadMemory(
+                        pCopy.get() + (iChunkLow - iStackLow),
+                        reinterpret_cast<const void*>(iChunkLow),
+                        static_cast<size_t>(iCopiedLow - iChunkLow))) {
+                    iCopiedLow = iChunkLow;
+                    continue;
+                }
+
+                // Find the last readable page of this chunk.
+                const auto iPageSize = static_cast<uintptr_t>(GcVirtualMemory::getPageSize());
+                while (iCopiedLow > iChunkLow) {
+                    const auto iPageLow = std::max((iCopiedLow - 1) & ~(iPageSize - 1), iChunkLow);
+                    if (!GcVirtualMemory::tryReadMemory(
+                            pCopy.get() + (iPageLow - iStackLow),
+                            reinterpret_cast<const void*>(iPageLow),
+                            static_cast<size_t>(iCopiedLow - iPageLow))) {
+                        break;
+                    }
+                    iCopiedLow = iPageLow;
+                }
+                break;
+            }
+
+            onStack(pCopy.get() + (iCopiedLow - iStackLow), static_cast<size_t>(iStackHigh - iCopiedLow));
+        }
+    }
+
+}
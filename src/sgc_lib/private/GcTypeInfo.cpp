@@ -2,6 +2,7 @@
 
 // Standard.
 #include <stdexcept>
+#include <algorithm>
 
 // Custom.
 #include "GcAllocation.h"
@@ -10,19 +11,74 @@
 
 namespace sgc {
 
-    GcTypeInfo::GcTypeInfo(size_t iTypeSize, GcTypeInfoInvokeDestructor pInvokeDestructor)
-        : pInvokeDestructor(pInvokeDestructor), iTypeSize(iTypeSize) {}
+    GcTypeInfo::GcTypeInfo(
+        size_t iTypeSize,
+        size_t iTypeAlignment,
+        GcTypeInfoInvokeDestructor pInvokeDestructor,
+        GcTypeInfoInvokeRelocate pInvokeRelocate)
+        : pInvokeDestructor(pInvokeDestructor), pInvokeRelocate(pInvokeRelocate), iTypeSize(iTypeSize),
+          iTypeAlignment(iTypeAlignment) {}
 
     size_t GcTypeInfo::getTypeSize() const { return iTypeSize; }
 
+    size_t GcTypeInfo::getTypeAlignment() const { return iTypeAlignment; }
+
     GcTypeInfo::GcTypeInfoInvokeDestructor GcTypeInfo::getInvokeDestructor() const {
         return pInvokeDestructor;
     }
 
+    GcTypeInfo::GcTypeInfoInvokeRelocate GcTypeInfo::getInvokeRelocate() const { return pInvokeRelocate; }
+
     const std::vector<GcTypeInfo::gcnode_field_offset_t>& GcTypeInfo::getGcPtrFieldOffsets() {
         return vGcPtrFieldOffsets;
     }
 
+    bool GcTypeInfo::isUsingFieldBitmap() const { return bIsUsingFieldBitmap; }
+
+    void GcTypeInfo::onAllGcNodeFieldOffsetsInitialized() {
+        if (bAllGcNodeFieldOffsetsInitialized) {
+            // Already initialized by some previously constructed object.
+            return;
+        }
+
+        // Prepare a lambda to set bits of field offsets.
+        const auto addToBitmap = [this](
+                                     const std::vector<gcnode_field_offset_t>& vFieldOffsets,
+                                     std::array<FieldBitmapWord, iFieldBitmapCapacity>& bitmap) -> bool {
+            constexpr auto iBitsPerWord = static_cast<size_t>(std::numeric_limits<FieldBitmapWord>::digits);
+
+            for (const auto& iFieldOffset : vFieldOffsets) {
+                // Bits describe pointer-sized words.
+                if (iFieldOffset % sizeof(void*) != 0) {
+                    return false;
+                }
+
+                // Make sure the bit fits into the inline bitmap.
+                const auto iWordIndex = static_cast<size_t>(iFieldOffset) / sizeof(void*);
+                if (iWordIndex >= iFieldBitmapCapacity * iBitsPerWord) {
+                    return false;
+                }
+
+                bitmap[iWordIndex / iBitsPerWord] |= FieldBitmapWord{1} << (iWordIndex % iBitsPerWord);
+                iFieldBitmapWordCount = std::max(iFieldBitmapWordCount, iWordIndex / iBitsPerWord + 1);
+            }
+
+            return true;
+        };
+
+        // Use bitmaps only if all fields can be described by them (otherwise use offset arrays).
+        bIsUsingFieldBitmap = addToBitmap(vGcPtrFieldOffsets, gcPtrFieldBitmap) &&
+                              addToBitmap(vGcContainerFieldOffsets, gcContainerFieldBitmap);
+
+        // Publish field information.
+        bAllGcNodeFieldOffsetsInitialized = true;
+    }
+
+    std::recursive_mutex& GcTypeInfo::getFieldOffsetsMutex() {
+        static std::recursive_mutex mtxFieldOffsets;
+        return mtxFieldOffsets;
+    }
+
     bool GcTypeInfo::tryRegisteringGcNodeFieldOffset(GcNode* pConstructedNode, GcAllocation* pAllocation) {
         // Don't check yet if offsets are initialized or not (check later).
 
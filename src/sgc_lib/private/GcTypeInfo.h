@@ -2,11 +2,22 @@
 
 // Standard.
 #include <vector>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <atomic>
+#include <new>
+#include <utility>
+#include <type_traits>
 
 namespace sgc {
     class GcAllocation;
     class GcTypeInfo;
     class GcNode;
+    class GcPtrBase;
+    class GcContainerBase;
 
     /** Stores information about a specific GC controlled type. */
     class GcTypeInfo {
@@ -27,6 +38,9 @@ namespace sgc {
         /** Signature of the function to invoke destructor. */
         using GcTypeInfoInvokeDestructor = void (*)(void* pObjectMemory) noexcept;
 
+        /** Signature of the function to move an object to new memory (and destroy the old object). */
+        using GcTypeInfoInvokeRelocate = void (*)(void* pNewObjectMemory, void* pOldObjectMemory) noexcept;
+
         GcTypeInfo() = delete;
 
         GcTypeInfo(const GcTypeInfo&) = delete;
@@ -39,9 +53,16 @@ namespace sgc {
          * Constructs a new type info.
          *
          * @param iTypeSize          Size of the type in bytes.
+         * @param iTypeAlignment     Alignment of the type in bytes.
          * @param pInvokeDestructor  Pointer to type's destructor.
+         * @param pInvokeRelocate    Pointer to the function to move an object (`nullptr` if the type can't
+         * be moved).
          */
-        GcTypeInfo(size_t iTypeSize, GcTypeInfoInvokeDestructor pInvokeDestructor);
+        GcTypeInfo(
+            size_t iTypeSize,
+            size_t iTypeAlignment,
+            GcTypeInfoInvokeDestructor pInvokeDestructor,
+            GcTypeInfoInvokeRelocate pInvokeRelocate);
 
         /**
          * Returns static type information.
@@ -59,6 +80,13 @@ namespace sgc {
          */
         size_t getTypeSize() const;
 
+        /**
+         * Returns alignment of the type in bytes.
+         *
+         * @return Alignment in bytes (power of 2).
+         */
+        size_t getTypeAlignment() const;
+
         /**
          * Returns pointer to to function to invoke type's destructor.
          *
@@ -66,6 +94,13 @@ namespace sgc {
          */
         GcTypeInfoInvokeDestructor getInvokeDestructor() const;
 
+        /**
+         * Returns pointer to to function that moves an object to new memory (used by heap compaction).
+         *
+         * @return `nullptr` if the type is not nothrow move constructible, otherwise function pointer.
+         */
+        GcTypeInfoInvokeRelocate getInvokeRelocate() const;
+
         /**
          * Returns offsets from type start to GC pointer fields.
          *
@@ -75,7 +110,75 @@ namespace sgc {
          */
         const std::vector<gcnode_field_offset_t>& getGcPtrFieldOffsets();
 
+        /**
+         * Tells if GC node fields of the type are described using inline bitmaps (fast path) or using
+         * offset arrays.
+         *
+         * @remark Used for automated tests.
+         *
+         * @return `true` if bitmaps are used, `false` otherwise.
+         */
+        bool isUsingFieldBitmap() const;
+
+        /**
+         * Calls the specified callbacks for each GC pointer field and each GC container field of an object
+         * of this type.
+         *
+         * @remark Field offsets must be initialized.
+         *
+         * @param pObject       Object of this type.
+         * @param onGcPtr       Callback that receives `GcPtrBase*`.
+         * @param onGcContainer Callback that receives `GcContainerBase*`.
+         */
+        template <typename OnGcPtr, typename OnGcContainer>
+        inline void
+        forEachGcNodeField(void* pObject, OnGcPtr&& onGcPtr, OnGcContainer&& onGcContainer) const {
+            const auto pObjectBytes = static_cast<char*>(pObject);
+
+            if (bIsUsingFieldBitmap) [[likely]] {
+                // Walk set bits, each bit is a pointer-sized word of the object.
+                for (size_t iBitmapWord = 0; iBitmapWord < iFieldBitmapWordCount; iBitmapWord++) {
+                    const auto pWordsStart = pObjectBytes + iBitmapWord * iFieldBitmapWordSizeInBytes;
+
+                    auto iGcPtrBits = gcPtrFieldBitmap[iBitmapWord];
+                    while (iGcPtrBits != 0) {
+                        const auto iBit = static_cast<size_t>(std::countr_zero(iGcPtrBits));
+                        iGcPtrBits &= iGcPtrBits - 1;
+                        onGcPtr(reinterpret_cast<GcPtrBase*>(pWordsStart + iBit * sizeof(void*)));
+                    }
+
+                    auto iGcContainerBits = gcContainerFieldBitmap[iBitmapWord];
+                    while (iGcContainerBits != 0) {
+                        const auto iBit = static_cast<size_t>(std::countr_zero(iGcContainerBits));
+                        iGcContainerBits &= iGcContainerBits - 1;
+                        onGcContainer(reinterpret_cast<GcContainerBase*>(pWordsStart + iBit * sizeof(void*)));
+                    }
+                }
+
+                return;
+            }
+
+            for (const auto& iGcPtrFieldOffset : vGcPtrFieldOffsets) {
+                onGcPtr(
+                    reinterpret_cast<GcPtrBase*>(pObjectBytes + static_cast<uintptr_t>(iGcPtrFieldOffset)));
+            }
+            for (const auto& iGcContainerFieldOffset : vGcContainerFieldOffsets) {
+                onGcContainer(reinterpret_cast<GcContainerBase*>(
+                    pObjectBytes + static_cast<uintptr_t>(iGcContainerFieldOffset)));
+            }
+        }
+
     private:
+        /** Type of a single word of field bitmaps. */
+        using FieldBitmapWord = uint64_t;
+
+        /** Number of words in inline field bitmaps (types up to 512 pointer-sized words use bitmaps). */
+        static constexpr size_t iFieldBitmapCapacity = 8; // NOLINT
+
+        /** Number of object bytes that a single bitmap word describes. */
+        static constexpr size_t iFieldBitmapWordSizeInBytes =
+            std::numeric_limits<FieldBitmapWord>::digits * sizeof(void*);
+
         /** Static "accessor" for GC controlled type information. */
         template <typename Type> struct GcTypeInfoStatic {
             /**
@@ -91,6 +194,32 @@ namespace sgc {
                 pObject->~Type();
             }
 
+            /**
+             * Move constructs an object in the specified memory and destroys the old object.
+             *
+             * @param pNewObjectMemory Memory for the new object.
+             * @param pOldObjectMemory Memory of the object to move.
+             */
+            static void invokeRelocate(void* pNewObjectMemory, void* pOldObjectMemory) noexcept {
+                auto pOldObject = reinterpret_cast<Type*>(pOldObjectMemory);
+
+                new (pNewObjectMemory) Type(std::move(*pOldObject));
+                pOldObject->~Type();
+            }
+
+            /**
+             * Returns function to move objects of the type.
+             *
+             * @return `nullptr` if the type is not nothrow move constructible, otherwise function pointer.
+             */
+            static constexpr GcTypeInfoInvokeRelocate pickInvokeRelocate() {
+                if constexpr (std::is_nothrow_move_constructible_v<Type>) {
+                    return invokeRelocate;
+                } else {
+                    return nullptr;
+                }
+            }
+
             /** Type information. */
             static GcTypeInfo info;
         };
@@ -108,6 +237,22 @@ namespace sgc {
          */
         bool tryRegisteringGcNodeFieldOffset(GcNode* pConstructedNode, GcAllocation* pAllocation);
 
+        /**
+         * Returns mutex that must be locked while constructing an object of a type which field offsets
+         * are not initialized yet (objects might be constructed by different garbage collectors in parallel).
+         *
+         * @return Mutex.
+         */
+        static std::recursive_mutex& getFieldOffsetsMutex();
+
+        /**
+         * Called after the first object of the type was constructed to mark field offsets as initialized
+         * and build field bitmaps.
+         *
+         * @remark Expects that mutex from @ref getFieldOffsetsMutex is locked.
+         */
+        void onAllGcNodeFieldOffsetsInitialized();
+
         /**
          * Offsets from GC controlled type start to each field that has a GC pointer type.
          *
@@ -126,19 +271,50 @@ namespace sgc {
          * `true` if @ref vGcPtrFieldOffsets and @ref vGcContainerFieldOffsets are fully initialized and all
          * offsets were added, `false` if the type information is still being gathered.
          */
-        bool bAllGcNodeFieldOffsetsInitialized = false;
+        std::atomic<bool> bAllGcNodeFieldOffsetsInitialized{false};
+
+        /**
+         * Bitmap over pointer-sized words of the type where set bits are GC pointer fields.
+         *
+         * @remark Only valid if @ref bIsUsingFieldBitmap is `true`.
+         */
+        std::array<FieldBitmapWord, iFieldBitmapCapacity> gcPtrFieldBitmap{};
+
+        /**
+         * Bitmap over pointer-sized words of the type where set bits are GC container fields.
+         *
+         * @remark Only valid if @ref bIsUsingFieldBitmap is `true`.
+         */
+        std::array<FieldBitmapWord, iFieldBitmapCapacity> gcContainerFieldBitmap{};
+
+        /** Number of used words in @ref gcPtrFieldBitmap and @ref gcContainerFieldBitmap. */
+        size_t iFieldBitmapWordCount = 0;
+
+        /**
+         * `true` if GC node fields are described by bitmaps, `false` if the type is too big for inline
+         * bitmaps (or has fields that are not aligned to pointer size) and offset arrays are used.
+         */
+        bool bIsUsingFieldBitmap = false;
 
         /** Pointer to the function to invoke type's destructor. */
         GcTypeInfoInvokeDestructor const pInvokeDestructor = nullptr;
 
+        /** Pointer to the function to move an object (`nullptr` if objects can't be moved). */
+        GcTypeInfoInvokeRelocate const pInvokeRelocate = nullptr;
+
         /** Size in bytes of the type. */
         size_t const iTypeSize = 0;
+
+        /** Alignment in bytes of the type. */
+        size_t const iTypeAlignment = 0;
     };
 
     /** Initializer for static type info. */
     template <typename T>
     GcTypeInfo GcTypeInfo::GcTypeInfoStatic<T>::info{
         sizeof(T),
+        alignof(T),
         GcTypeInfoStatic<T>::invokeDestructor,
+        GcTypeInfoStatic<T>::pickInvokeRelocate(),
     };
 }
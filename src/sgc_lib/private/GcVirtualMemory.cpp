@@ -0,0 +1,300 @@
+#include "GcVirtualMemory.h"
+
+// Standard.
+#include <new>
+#include <stdexcept>
+#include <fstream>
+#include <string>
+
+// Custom.
+#include "GcInfoCallbacks.hpp"
+
+#if defined(WIN32)
+#include <Windows.h>
+#elif __linux__
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace sgc {
+
+    size_t GcVirtualMemory::getPageSize() {
+        static const size_t iPageSize = []() -> size_t {
+#if defined(WIN32)
+            SYSTEM_INFO systemInfo{};
+            GetSystemInfo(&systemInfo);
+            return static_cast<size_t>(systemInfo.dwPageSize);
+#elif __linux__
+            return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#else
+            static_assert(false, "not implemented");
+#endif
+        }();
+
+        return iPageSize;
+    }
+
+    size_t GcVirtualMemory::roundUpToPageSize(size_t iSizeInBytes) {
+        const auto iPageSize = getPageSize();
+        return (iSizeInBytes + iPageSize - 1) & ~(iPageSize - 1);
+    }
+
+    void* GcVirtualMemory::allocatePages(size_t iSizeInBytes) {
+#if defined(WIN32)
+        const auto pPages = VirtualAlloc(nullptr, iSizeInBytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        if (pPages == nullptr) [[unlikely]] {
+            throw std::bad_alloc();
+        }
+#elif __linux__
+        const auto pPages =
+            mmap(nullptr, iSizeInBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (pPages == MAP_FAILED) [[unlikely]] {
+            throw std::bad_alloc();
+        }
+#else
+        static_assert(false, "not implemented");
+#endif
+
+        return pPages;
+    }
+
+    void GcVirtualMemory::freePages(void* pPages, size_t iSizeInBytes) {
+#if defined(WIN32)
+        const auto bFailed = VirtualFree(pPages, 0, MEM_RELEASE) == 0;
+#elif __linux__
+        const auto bFailed = munmap(pPages, iSizeInBytes) != 0;
+#else
+        static_assert(false, "not implemented");
+#endif
+
+        if (bFailed) [[unlikely]] {
+            GcInfoCallbacks::getWarningCallback()("failed to return GC memory pages to the OS");
+        }
+    }
+
+    void* GcVirtualMemory::reservePages(size_t iSizeInBytes, size_t iAlignment) {
+#if defined(WIN32)
+        // Reserve a bigger range to find an aligned address in it, then release it and reserve
+        // exactly at the aligned address (another thread might take this address in between, so retry).
+        for (size_t i = 0; i < 8; i++) { // NOLINT: seems like enough attempts
+            const auto pRange = VirtualAlloc(nullptr, iSizeInBytes + iAlignment, MEM_RESERVE, PAGE_NOACCESS);
+            if (pRange == nullptr) [[unlikely]] {
+                throw std::bad_alloc();
+            }
+
+            const auto iAlignedAddress =
+                (reinterpret_cast<uintptr_t>(pRange) + iAlignment - 1) & ~(iAlignment - 1);
+            VirtualFree(pRange, 0, MEM_RELEASE);
+
+            const auto pPages = VirtualAlloc(
+                reinterpret_cast<void*>(iAlignedAddress), iSizeInBytes, MEM_RESERVE, PAGE_NOACCESS);
+            if (pPages != nullptr) {
+                return pPages;
+            }
+        }
+
+        throw std::bad_alloc();
+#elif __linux__
+        // Map a bigger range (without reserving swap space) and unmap parts that are not aligned.
+        const auto iMappingSize = iSizeInBytes + iAlignment;
+        const auto pMapping = mmap(
+            nullptr,
+            iMappingSize,
+            PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+            -1,
+            0);
+        if (pMapping == MAP_FAILED) [[unlikely]] {
+            throw std::bad_alloc();
+        }
+
+        const auto iMappingStart = reinterpret_cast<uintptr_t>(pMapping);
+        const auto iAlignedStart = (iMappingStart + iAlignment - 1) & ~(iAlignment - 1);
+
+        const auto iHeadSize = iAlignedStart - iMappingStart;
+        if (iHeadSize != 0) {
+            munmap(pMapping, iHeadSize);
+        }
+
+        const auto iTailSize = iMappingSize - iHeadSize - iSizeInBytes;
+        if (iTailSize != 0) {
+            munmap(reinterpret_cast<void*>(iAlignedStart + iSizeInBytes), iTailSize);
+        }
+
+        return reinterpret_cast<void*>(iAlignedStart);
+#else
+        static_assert(false, "not implemented");
+#endif
+    }
+
+    void GcVirtualMemory::commitPages(void* pPages, size_t iSizeInBytes) {
+#if defined(WIN32)
+        if (VirtualAlloc(pPages, iSizeInBytes, MEM_COMMIT, PAGE_READWRITE) == nullptr) [[unlikely]] {
+            throw std::bad_alloc();
+        }
+#elif __linux__
+        // Nothing to do, reserved pages are committed by the kernel on first access.
+#else
+        static_assert(false, "not implemented");
+#endif
+    }
+
+    void GcVirtualMemory::decommitPages(void* pPages, size_t iSizeInBytes, bool bLazy) {
+#if defined(WIN32)
+        const auto bFailed = bLazy ? VirtualAlloc(pPages, iSizeInBytes, MEM_RESET, PAGE_READWRITE) == nullptr
+                                   : VirtualFree(pPages, iSizeInBytes, MEM_DECOMMIT) == 0;
+#elif __linux__
+        auto bFailed = false;
+        auto bDecommitNow = true;
+#if defined(MADV_FREE)
+        if (bLazy) {
+            if (madvise(pPages, iSizeInBytes, MADV_FREE) == 0) {
+                return;
+            }
+
+            // Fallback to the usual decommit only if the kernel does not support lazy freeing.
+            bFailed = errno != EINVAL;
+            bDecommitNow = !bFailed;
+        }
+#endif
+        if (bDecommitNow) {
+            bFailed = madvise(pPages, iSizeInBytes, MADV_DONTNEED) != 0;
+        }
+#else
+        static_assert(false, "not implemented");
+#endif
+
+        if (bFailed) [[unlikely]] {
+            GcInfoCallbacks::getWarningCallback()("failed to decommit GC memory pages");
+        }
+    }
+
+    bool GcVirtualMemory::areHugePagesSupported() {
+        static const bool bSupported = []() -> bool {
+#if defined(WIN32)
+            // Large pages on Windows are not transparent (require a privilege and can't be decommitted).
+            return false;
+#elif __linux__ && defined(MADV_HUGEPAGE)
+            // Contains something like "always [madvise] never" where the current mode is in brackets.
+            std::ifstream file("/sys/kernel/mm/transparent_hugepage/enabled");
+            if (!file.is_open()) {
+                return false;
+            }
+
+            std::string sMode;
+            std::getline(file, sMode);
+            return sMode.find("[never]") == std::string::npos;
+#elif __linux__
+            return false;
+#else
+            static_assert(false, "not implemented");
+#endif
+        }();
+
+        return bSupported;
+    }
+
+    bool GcVirtualMemory::adviseHugePages(void* pPages, size_t iSizeInBytes, bool bEnable) {
+        if (!areHugePagesSupported()) {
+            return false;
+        }
+
+#if __linux__ && defined(MADV_HUGEPAGE)
+        return madvise(pPages, iSizeInBytes, bEnable ? MADV_HUGEPAGE : MADV_NOHUGEPAGE) == 0;
+#else
+        return false;
+#endif
+    }
+
+    void GcVirtualMemory::getCurrentThreadStack(const std::byte*& pStackLow, const std::byte*& pStackHigh) {
+#if defined(WIN32)
+        ULONG_PTR iLowLimit = 0;
+        ULONG_PTR iHighLimit = 0;
+        GetCurrentThreadStackLimits(&iLowLimit, &iHighLimit);
+
+        pStackLow = reinterpret_cast<const std::byte*>(iLowLimit);
+        pStackHigh = reinterpret_cast<const std::byte*>(iHighLimit);
+#elif __linux__
+        pthread_attr_t attributes;
+        if (pthread_getattr_np(pthread_self(), &attributes) != 0) [[unlikely]] {
+            GcInfoCallbacks::getCriticalErrorCallback()("failed to query stack of the current thread");
+            throw std::runtime_error("critical error");
+        }
+
+        void* pStackAddress = nullptr;
+        size_t iStackSize = 0;
+        const auto bFailed = pthread_attr_getstack(&attributes, &pStackAddress, &iStackSize) != 0;
+        pthread_attr_destroy(&attributes);
+        if (bFailed) [[unlikely]] {
+            GcInfoCallbacks::getCriticalErrorCallback()("failed to query stack of the current thread");
+            throw std::runtime_error("critical error");
+        }
+
+        pStackLow = static_cast<const std::byte*>(pStackAddress);
+        pStackHigh = pStackLow + iStackSize;
+#else
+        static_assert(false, "not implemented");
+#endif
+    }
+
+    bool GcVirtualMemory::canReadMemory() {
+        static const bool bCanRead = []() -> bool {
+            const std::byte source{};
+            std::byte destination{};
+#if defined(WIN32)
+            const auto pProcess = GetCurrentProcess();
+            SIZE_T iReadSize = 0;
+            return ReadProcessMemory(pProcess, &source, &destination, sizeof(source), &iReadSize) != 0 &&
+                   iReadSize == sizeof(source);
+#elif __linux__
+            iovec destinationVector{.iov_base = &destination, .iov_len = sizeof(destination)};
+            iovec sourceVector{.iov_base = const_cast<std::byte*>(&source), .iov_len = sizeof(source)};
+            return process_vm_readv(getpid(), &destinationVector, 1, &sourceVector, 1, 0) ==
+                   static_cast<ssize_t>(sizeof(source));
+#else
+            static_assert(false, "not implemented");
+#endif
+        }();
+
+        return bCanRead;
+    }
+
+    bool GcVirtualMemory::tryReadMemory(void* pDestination, const void* pSource, size_t iSizeInBytes) {
+#if defined(WIN32)
+        SIZE_T iReadSize = 0;
+        if (ReadProcessMemory(GetCurrentProcess(), pSource, pDestination, iSizeInBytes, &iReadSize) != 0 &&
+            iReadSize == iSizeInBytes) {
+            return true;
+        }
+
+        // Memory that is not mapped (or readable) is reported as a partial copy.
+        const auto iError = GetLastError();
+        if (iReadSize != 0 || iError == ERROR_PARTIAL_COPY || iError == ERROR_NOACCESS) {
+            return false;
+        }
+#elif __linux__
+        // Let the kernel copy the memory (reports an error instead of faulting on unmapped pages).
+        iovec destination{.iov_base = pDestination, .iov_len = iSizeInBytes};
+        iovec source{.iov_base = const_cast<void*>(pSource), .iov_len = iSizeInBytes};
+        const auto iReadSize = process_vm_readv(getpid(), &destination, 1, &source, 1, 0);
+        if (iReadSize == static_cast<ssize_t>(iSizeInBytes)) {
+            return true;
+        }
+
+        // Memory that is not mapped (or readable) is reported as a partial read or `EFAULT`.
+        if (iReadSize >= 0 || errno == EFAULT) {
+            return false;
+        }
+#else
+        static_assert(false, "not implemented");
+#endif
+
+        // Other errors (for example the call is no longer permitted) say nothing about the memory.
+        GcInfoCallbacks::getCriticalErrorCallback()("failed to read memory of the current process");
+        throw std::runtime_error("critical error");
+    }
+
+}
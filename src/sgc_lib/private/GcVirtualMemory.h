@@ -0,0 +1,137 @@
+#pragma once
+
+// Standard.
+#include <cstddef>
+
+namespace sgc {
+    /** Provides static functions to work with pages of virtual memory (bypassing the process allocator). */
+    class GcVirtualMemory {
+    public:
+        GcVirtualMemory() = delete;
+
+        /**
+         * Returns size of a virtual memory page.
+         *
+         * @return Size in bytes (power of 2).
+         */
+        static size_t getPageSize();
+
+        /**
+         * Rounds up the specified size to be a multiple of the page size.
+         *
+         * @param iSizeInBytes Size to round up.
+         *
+         * @return Rounded size in bytes.
+         */
+        static size_t roundUpToPageSize(size_t iSizeInBytes);
+
+        /**
+         * Creates a new mapping of committed (readable and writable) zero-initialized pages.
+         *
+         * @remark Throws `std::bad_alloc` if failed.
+         *
+         * @param iSizeInBytes Size of the mapping, must be a multiple of the page size.
+         *
+         * @return Start of the mapping, aligned to the page size.
+         */
+        static void* allocatePages(size_t iSizeInBytes);
+
+        /**
+         * Removes a mapping previously created by @ref allocatePages (or a range reserved by @ref
+         * reservePages) and returns its memory to the OS.
+         *
+         * @param pPages       Start of the mapping.
+         * @param iSizeInBytes Size that was specified when the mapping was created.
+         */
+        static void freePages(void* pPages, size_t iSizeInBytes);
+
+        /**
+         * Reserves a range of virtual memory without committing it.
+         *
+         * @remark Throws `std::bad_alloc` if failed.
+         *
+         * @remark Use @ref commitPages before accessing the memory and @ref freePages to release the range.
+         *
+         * @param iSizeInBytes Size of the range, must be a multiple of the page size.
+         * @param iAlignment   Alignment of the start of the range (power of 2, multiple of the page size).
+         *
+         * @return Start of the range.
+         */
+        static void* reservePages(size_t iSizeInBytes, size_t iAlignment);
+
+        /**
+         * Commits pages from a range previously reserved by @ref reservePages.
+         *
+         * @remark Throws `std::bad_alloc` if failed.
+         *
+         * @param pPages       Start of the pages to commit (aligned to the page size).
+         * @param iSizeInBytes Size of the pages to commit, must be a multiple of the page size.
+         */
+        static void commitPages(void* pPages, size_t iSizeInBytes);
+
+        /**
+         * Returns physical memory of the specified committed pages to the OS while keeping the range
+         * reserved. Next access to the pages (after @ref commitPages) will see zeroed memory.
+         *
+         * @param pPages       Start of the pages to decommit (aligned to the page size).
+         * @param iSizeInBytes Size of the pages to decommit, must be a multiple of the page size.
+         * @param bLazy        `true` to allow the OS to reclaim the memory lazily (only under memory
+         * pressure, cheaper but RSS does not drop immediately, the memory content is undefined until written
+         * to), `false` to reclaim the memory right away.
+         */
+        static void decommitPages(void* pPages, size_t iSizeInBytes, bool bLazy);
+
+        /**
+         * Tells if the OS can back memory with transparent huge pages.
+         *
+         * @return `true` if huge pages can be requested using @ref adviseHugePages, `false` otherwise.
+         */
+        static bool areHugePagesSupported();
+
+        /**
+         * Asks the OS to back the specified range (or stop backing it) with transparent huge pages.
+         *
+         * @param pPages       Start of the range (aligned to the huge page size).
+         * @param iSizeInBytes Size of the range, must be a multiple of the huge page size.
+         * @param bEnable      `true` to request huge pages, `false` to use regular pages.
+         *
+         * @return `false` if the OS rejected the request (regular pages will be used), `true` otherwise.
+         */
+        static bool adviseHugePages(void* pPages, size_t iSizeInBytes, bool bEnable);
+
+        /**
+         * Returns the range of virtual memory reserved for the stack of the calling thread.
+         *
+         * @remark Parts of the range that the thread did not use yet might not be mapped.
+         *
+         * @param pStackLow  Lowest address of the stack.
+         * @param pStackHigh Address after the highest address of the stack.
+         */
+        static void getCurrentThreadStack(const std::byte*& pStackLow, const std::byte*& pStackHigh);
+
+        /**
+         * Tells if @ref tryReadMemory can be used (the OS might forbid the process to read its own memory
+         * this way, for example in a sandbox).
+         *
+         * @remark Checked on the first call, the result is cached.
+         *
+         * @return `true` if memory can be read, `false` otherwise.
+         */
+        static bool canReadMemory();
+
+        /**
+         * Copies memory of the current process that might not be mapped (or readable) without faulting.
+         *
+         * @remark Triggers a critical error if reading failed for a reason other than unreadable memory
+         * (see @ref canReadMemory).
+         *
+         * @param pDestination Memory to copy to.
+         * @param pSource      Memory to copy from.
+         * @param iSizeInBytes Number of bytes to copy.
+         *
+         * @return `false` if some part of the source memory is not readable (the content of the destination
+         * is undefined then), `true` if copied.
+         */
+        static bool tryReadMemory(void* pDestination, const void* pSource, size_t iSizeInBytes);
+    };
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+// Standard.
+#include <stdexcept>
+
+// Custom.
+#include "GcPtr.h"
+#include "GcAllocationRef.hpp"
+#include "GcAllocationConstructionGuard.h"
+#include "GcInfoCallbacks.hpp"
+
+namespace sgc {
+    /**
+     * Base type for objects that need GC pointers to themselves: @ref gcFromThis creates a GC pointer
+     * to the object using the allocation that was remembered while the object was constructed (unlike
+     * `GcPtr<Type>(this)` does not look for the allocation in the garbage collector's "database").
+     *
+     * @code
+     * class Node : public sgc::EnableGcFromThis<Node> {
+     * public:
+     *     void attach(Node& parent) { parent.vChildren.push_back(gcFromThis()); }
+     *
+     *     sgc::GcVector<sgc::GcPtr<Node>> vChildren;
+     * };
+     * @endcode
+     *
+     * @remark Can also be used in constructors of derived types and for objects that are fields of
+     * objects created using `makeGc` (the returned pointer then points inside of the outer object).
+     *
+     * @tparam Type Type that derives from this base.
+     */
+    template <typename Type> class EnableGcFromThis {
+    public:
+        /**
+         * Returns a GC pointer to this object.
+         *
+         * @remark Triggers a critical error if the object was not created using `makeGc` (and is not
+         * a field of such object).
+         *
+         * @return GC pointer to this object.
+         */
+        GcPtr<Type> gcFromThis() {
+            if (pSelfAllocation == nullptr) [[unlikely]] {
+                GcInfoCallbacks::getCriticalErrorCallback()(
+                    "unable to create a GC pointer to an object that was not created using `makeGc`");
+                throw std::runtime_error("critical error");
+            }
+
+            GcPtr<Type> pSelf;
+            pSelf.setAllocationFromKnownAllocation(pSelfAllocation.get(), static_cast<Type*>(this));
+
+            return pSelf;
+        }
+
+    protected:
+        /** Remembers the allocation of the object that is being constructed. */
+        EnableGcFromThis()
+            : pSelfAllocation(GcAllocationConstructionGuard::getConstructingAllocation(this)) {}
+
+        /** Remembers the allocation of the object being constructed (a copy is a different object). */
+        EnableGcFromThis(const EnableGcFromThis&) : EnableGcFromThis() {}
+
+        /**
+         * Keeps the remembered allocation (the object stays in its allocation).
+         *
+         * @return This.
+         */
+        EnableGcFromThis& operator=(const EnableGcFromThis&) { return *this; }
+
+        ~EnableGcFromThis() = default;
+
+    private:
+        /** Allocation of the object (`nullptr` if the object was not created using `makeGc`). */
+        GcAllocationRef pSelfAllocation;
+    };
+}
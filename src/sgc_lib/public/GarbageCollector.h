@@ -1,19 +1,45 @@
 #pragma once
 
 // Standard.
+#include <array>
 #include <mutex>
 #include <vector>
+#include <functional>
+#include <map>
+#include <memory>
+#include <memory_resource>
 #include <unordered_map>
 #include <unordered_set>
+#include <cstdint>
+#include <thread>
+
+// Custom.
+#include "GcDecommitPolicy.hpp"
+#include "GcScope.h"
 
 namespace sgc {
+    class GcHeap;
+    class GcRegionArena;
+    class GcNursery;
+    class GcPageTable;
     class GcNode;
     class GcPtrBase;
     class GcContainerBase;
     class GcAllocation;
     struct GcAllocationInfo;
 
-    /** Singleton that provides garbage management functionality. */
+    /**
+     * Provides garbage management functionality for a set of GC objects (a GC heap).
+     *
+     * @remark There is a default garbage collector but more garbage collectors can be created to keep
+     * disjoint object graphs (for example of different subsystems) in separate heaps that are collected
+     * independently (and possibly in parallel), use @ref GcScope or `makeGcIn` to allocate objects in
+     * a specific heap.
+     *
+     * @remark GC pointers and GC containers belong to the garbage collector that was bound to the thread
+     * (see @ref get) when they were constructed, they can't reference objects of other garbage collectors
+     * (except for thread-local garbage collectors, see @ref getThreadLocal).
+     */
     class GarbageCollector {
         // GC pointers and GC containers notify garbage collector in constructor/destructor.
         friend class GcPtrBase;
@@ -25,6 +51,18 @@ namespace sgc {
         // Allocations add/remove themselves and their info objects.
         friend class GcAllocation;
 
+        // Binds garbage collectors to threads.
+        friend class GcScope;
+
+        // Creates region garbage collectors and releases them.
+        friend class GcRegion;
+
+        // Allocates memory that we scan for GC pointers.
+        template <typename> friend class GcTracingAllocator;
+
+        // Stores our ID.
+        friend class GcNode;
+
     public:
         /** Groups various GC root nodes. */
         struct RootNodes {
@@ -41,12 +79,107 @@ namespace sgc {
         GarbageCollector(GarbageCollector&&) noexcept = delete;
         GarbageCollector& operator=(GarbageCollector&&) noexcept = delete;
 
+        /** Creates a new garbage collector with an empty heap. */
+        GarbageCollector();
+
+        /**
+         * Creates a new thread-local garbage collector (see @ref getThreadLocal) for the specified shared
+         * garbage collector.
+         *
+         * @remark Objects are promoted to the shared garbage collector once a GC pointer to them is created
+         * on another thread.
+         *
+         * @warning The thread-local garbage collector must only be used by the creating thread and must be
+         * destroyed before the shared garbage collector.
+         *
+         * @param sharedGarbageCollector Garbage collector that objects will be promoted to once they
+         * become reachable from its objects.
+         */
+        explicit GarbageCollector(GarbageCollector& sharedGarbageCollector);
+
         /**
-         * Returns garbage collector singleton.
+         * Collects garbage and frees the heap.
          *
-         * @return Garbage collector singleton.
+         * @remark A thread-local garbage collector promotes objects that are still alive (and moves its
+         * GC pointers and GC containers that are still alive) to the shared garbage collector, for example
+         * when a thread exits while its objects are referenced from other threads.
+         *
+         * @warning All GC pointers and GC containers of this garbage collector must be destroyed before
+         * the garbage collector is destroyed, otherwise a warning is triggered.
          */
-        static GarbageCollector& get();
+        ~GarbageCollector();
+
+        /**
+         * Returns garbage collector that is bound to the calling thread using @ref GcScope or
+         * the default garbage collector if no garbage collector is bound.
+         *
+         * @remark Defined in the header so that creating GC pointers does not need a function call.
+         *
+         * @return Garbage collector.
+         */
+        static inline GarbageCollector& get() {
+            const auto pBoundGarbageCollector = pThreadGarbageCollector;
+            if (pBoundGarbageCollector != nullptr) [[unlikely]] {
+                return *pBoundGarbageCollector;
+            }
+
+            return getDefault();
+        }
+
+        /**
+         * Returns default garbage collector (a singleton).
+         *
+         * @return Default garbage collector.
+         */
+        static inline GarbageCollector& getDefault() {
+            static GarbageCollector garbageCollector;
+            return garbageCollector;
+        }
+
+        /**
+         * Returns thread-local garbage collector of the calling thread (created on the first call and
+         * destroyed when the thread exits) which shared garbage collector is the default garbage collector.
+         *
+         * Objects of a thread-local garbage collector are allocated and collected by the owning thread
+         * without locking (or stopping) other threads. Once such an object is stored in a GC pointer or
+         * a GC container of the shared garbage collector (becomes reachable from data of other threads)
+         * the object and all thread-local objects reachable from it are promoted to the shared garbage
+         * collector.
+         *
+         * Example:
+         * @code
+         * sgc::GcScope scope(sgc::GarbageCollector::getThreadLocal());
+         * auto pTemp = sgc::makeGc<Foo>();   // thread-local object
+         * pSharedObject->pFoo = pTemp;       // `pTemp` is now promoted to the shared garbage collector
+         * @endcode
+         *
+         * @remark GC pointers that are created on other threads (for example when a GC pointer is passed
+         * to another thread) promote thread-local objects too, objects that are still alive when the thread
+         * exits are promoted to the shared garbage collector.
+         *
+         * @remark Thread-local objects can reference objects of the shared garbage collector, the shared
+         * garbage collector scans its thread-local garbage collectors while collecting garbage (this briefly
+         * blocks their threads).
+         *
+         * @return Thread-local garbage collector.
+         */
+        static GarbageCollector& getThreadLocal();
+
+        /**
+         * Returns shared garbage collector of a thread-local garbage collector.
+         *
+         * @return `nullptr` if this garbage collector is not thread-local, otherwise shared garbage
+         * collector.
+         */
+        GarbageCollector* getSharedGarbageCollector() const;
+
+        /**
+         * Tells if the calling thread is the thread that created this garbage collector (the only thread
+         * that is allowed to use a thread-local garbage collector).
+         *
+         * @return `true` if called by the creating thread, `false` otherwise.
+         */
+        bool isOwnedByCurrentThread() const;
 
         /**
          * Runs garbage collection which might cause some no longer references objects to be destroyed.
@@ -63,6 +196,212 @@ namespace sgc {
          */
         size_t getAliveAllocationCount();
 
+        /**
+         * Sets the minimum size of a GC allocation (size of the user object plus some GC data) to be
+         * placed into the large object space.
+         *
+         * @remark Each object in the large object space gets its own page-aligned mapping (bypassing the
+         * process allocator) and this memory is returned to the OS as soon as the object is deleted
+         * (freed), this keeps large frees from fragmenting the memory used by small objects.
+         *
+         * @remark Only affects new allocations.
+         *
+         * @param iSizeInBytes Size in bytes.
+         */
+        void setLargeObjectThreshold(size_t iSizeInBytes);
+
+        /**
+         * Sets a memory resource that will be used to allocate memory for new GC objects instead of
+         * the GC heap, the large object space and the process allocator.
+         *
+         * @warning The memory resource must stay valid until all objects allocated from it are deleted.
+         *
+         * @remark Only affects new allocations, objects that were already allocated are freed using the
+         * memory resource they were allocated from.
+         *
+         * @param pMemoryResource Memory resource to use or `nullptr` to use the default memory sources.
+         */
+        void setMemoryResource(std::pmr::memory_resource* pMemoryResource);
+
+        /**
+         * Returns the memory resource that is used to allocate memory for new GC objects.
+         *
+         * @return `nullptr` if default memory sources are used, otherwise memory resource.
+         */
+        std::pmr::memory_resource* getMemoryResource();
+
+        /**
+         * Returns the minimum size of a GC allocation to be placed into the large object space.
+         *
+         * @return Size in bytes.
+         */
+        size_t getLargeObjectThreshold();
+
+        /**
+         * Returns the total size of memory mapped for objects in the large object space.
+         *
+         * @remark Used for automated tests and debugging.
+         *
+         * @return Size in bytes.
+         */
+        size_t getLargeObjectSpaceSize();
+
+        /**
+         * Sets a policy that defines when memory of GC heap pages that became empty after a garbage
+         * collection is returned to the OS.
+         *
+         * @param policy Policy to use.
+         */
+        void setHeapDecommitPolicy(const GcDecommitPolicy& policy);
+
+        /**
+         * Returns the policy that defines when memory of empty GC heap pages is returned to the OS.
+         *
+         * @return Policy.
+         */
+        GcDecommitPolicy getHeapDecommitPolicy();
+
+        /**
+         * Returns the total size of committed memory of the GC heap that stores small objects (pages
+         * that store objects and empty pages that were not returned to the OS yet).
+         *
+         * @remark Used for automated tests and debugging.
+         *
+         * @return Size in bytes.
+         */
+        size_t getCommittedHeapSize();
+
+        /**
+         * Enables or disables backing of the GC heap (that stores small objects) with transparent huge pages
+         * which reduces TLB misses when the garbage collector traverses big heaps.
+         *
+         * @remark While enabled, empty heap pages are only returned to the OS when the whole 4 MB region
+         * that they belong to is empty (to not split huge pages).
+         *
+         * @param bEnable `true` to use huge pages, `false` to use regular pages.
+         *
+         * @return `true` if huge pages are now used, `false` if disabled or huge pages are not available
+         * (for example transparent huge pages are disabled in the OS or not supported on this platform),
+         * in this case regular pages are used.
+         */
+        bool setUseHugePagesForHeap(bool bEnable);
+
+        /**
+         * Tells if the GC heap is backed with transparent huge pages.
+         *
+         * @return `true` if huge pages are used, `false` otherwise.
+         */
+        bool isHeapUsingHugePages();
+
+        /**
+         * Enables or disables heap compaction: after sweeping, objects from sparsely used heap pages are
+         * moved to other pages (GC pointers reference objects through their allocations so they stay
+         * valid) which returns fragmented pages to the OS and restores locality.
+         *
+         * @remark Only nothrow move constructible objects are moved (using their move constructor),
+         * objects pinned with @ref GcPin are not moved.
+         *
+         * @warning While enabled, raw pointers and references to GC objects (returned by `GcPtr::get`,
+         * `GcPtr::operator->` or `this`) are only valid until the next garbage collection unless the
+         * object is pinned. Other threads must not access GC objects through raw pointers while garbage
+         * is collected.
+         *
+         * @param bEnable `true` to compact the heap on garbage collection, `false` to never move objects.
+         */
+        void setCompactHeap(bool bEnable);
+
+        /**
+         * Tells if heap compaction is enabled.
+         *
+         * @return `true` if objects might be moved during garbage collection, `false` otherwise.
+         */
+        bool isCompactingHeap();
+
+        /**
+         * Enables or disables the nursery: new small objects are bump-allocated into blocks owned by this
+         * garbage collector (use a thread-local garbage collector from @ref getThreadLocal to have
+         * thread-owned blocks). After a garbage collection blocks without alive objects are freed as a whole
+         * and memory of deleted objects in surviving blocks is reused for new objects.
+         *
+         * @remark Objects allocated in the nursery are never moved by heap compaction. Disabling the nursery
+         * only affects new allocations.
+         *
+         * @remark Only the memory of objects comes from the nursery: each object still gets its own
+         * allocation record and is added to the set of existing allocations (that garbage collection sweeps),
+         * finding an object by a raw pointer (for example `GcPtr` assignment from a raw pointer) uses the
+         * page table instead of a hash lookup.
+         *
+         * @param bEnable `true` to allocate new small objects in the nursery, `false` to use the heap.
+         */
+        void setUseNursery(bool bEnable);
+
+        /**
+         * Tells if new small objects are allocated in the nursery.
+         *
+         * @return `true` if the nursery is used, `false` otherwise.
+         */
+        bool isUsingNursery();
+
+        /**
+         * Returns the total size of nursery blocks of this garbage collector.
+         *
+         * @return Size in bytes.
+         */
+        size_t getNurserySize();
+
+        /**
+         * Enables or disables deferred reference counting: GC pointers that are fields of GC objects (or
+         * items of GC containers) maintain reference counts of the objects they reference while references
+         * from root GC pointers are not counted. Objects which count drops to zero are collected in a table
+         * that is processed after some number of new objects were created (or when
+         * @ref collectUnreferencedObjects is called): objects from the table that are not referenced by root
+         * GC pointers are deleted right away (together with objects that were only referenced by them).
+         * This keeps memory usage close to the live size between garbage collections, @ref collectGarbage
+         * is still needed to delete cycles.
+         *
+         * @remark Reference counts are recalculated on each @ref collectGarbage. Unreferenced objects are not
+         * deleted while this garbage collector has thread-local garbage collectors.
+         *
+         * @warning While enabled, creating a new GC object might delete objects that are only referenced
+         * by raw pointers (not by GC pointers).
+         *
+         * @param bEnable `true` to maintain reference counts, `false` to only delete objects in
+         * @ref collectGarbage.
+         */
+        void setUseReferenceCounting(bool bEnable);
+
+        /**
+         * Tells if deferred reference counting is enabled.
+         *
+         * @return `true` if reference counts are maintained, `false` otherwise.
+         */
+        bool isUsingReferenceCounting();
+
+        /**
+         * Deletes objects which reference count dropped to zero and that are not referenced by root GC
+         * pointers (only if reference counting is enabled, see @ref setUseReferenceCounting).
+         *
+         * @return Number of deleted objects.
+         */
+        size_t collectUnreferencedObjects();
+
+        /**
+         * Deletes garbage cycles reachable from objects that lost a reference recently without tracing
+         * the whole heap (only if reference counting is enabled, see @ref setUseReferenceCounting).
+         *
+         * Objects which reference count was decremented (but did not drop to zero) are remembered as
+         * possible roots of garbage cycles. This function runs trial deletion on objects reachable from
+         * them: references between these objects are subtracted from their counts, objects that still
+         * have references (or are referenced by root GC pointers) and objects reachable from them are
+         * alive, other objects are garbage cycles and are deleted. Also called automatically once enough
+         * possible roots were remembered.
+         *
+         * @remark Not done while this garbage collector has thread-local garbage collectors.
+         *
+         * @return Number of deleted objects.
+         */
+        size_t collectUnreferencedCycles();
+
         /**
          * Returns pointer to read-only data of the garbage collector's internal root node set.
          *
@@ -86,8 +425,31 @@ namespace sgc {
         std::recursive_mutex* getGarbageCollectionMutex();
 
     private:
+        /** Number of bits of IDs of garbage collectors (see @ref getById). */
+        static constexpr size_t iIdBitCount = 14;
+
+        /** Maximum number of garbage collectors that can exist at the same time. */
+        static constexpr size_t iMaxGarbageCollectorCount = size_t(1) << iIdBitCount;
+
+        /** Memory allocated by a `GcTracingAllocator` that is scanned for GC pointers. */
+        struct TracedMemoryBlock {
+            /** Size of the memory in bytes. */
+            size_t iSizeInBytes = 0;
+
+            /** Allocation of the object that owns the memory (`nullptr` if the memory is a root). */
+            GcAllocation* pOwner = nullptr;
+        };
+
         /** Groups data about GC allocations. */
         struct AllocationData {
+            /**
+             * Creates data with default values.
+             *
+             * @remark Defined in the .cpp file because default member initializers of a nested class can't
+             * be used before the enclosing class is complete (and @ref mtxGcData needs the constructor).
+             */
+            AllocationData();
+
             /**
              * All not deleted (in-use) allocations allocated by the garbage collector.
              *
@@ -98,12 +460,105 @@ namespace sgc {
             /**
              * Used for quickly checking if some allocation info pointer is valid.
              *
-             * @remark GC allocation objects add themselves to this array in their constructor.
+             * @remark GC allocation objects add themselves to this array in their constructor (except for
+             * objects in the nursery that are found using @ref pPageTable instead).
              *
              * @remark Info objects here are owned by allocations from @ref
              * existingAllocations.
              */
             std::unordered_map<GcAllocationInfo*, GcAllocation*> allocationInfoRefs;
+
+            /**
+             * Allocations which memory is not in a GC heap by their memory, used to find an allocation by
+             * a pointer to any byte of its object (objects in GC heaps are found using owners of heap slots).
+             *
+             * @remark GC allocation objects add themselves to this table in their constructor.
+             *
+             * @remark Initialized in garbage collector's constructor.
+             */
+            std::unique_ptr<GcPageTable> pPageTable;
+
+            /** Minimum size in bytes of a GC allocation to be placed into the large object space. */
+            size_t iLargeObjectThreshold = 64 * 1024; // NOLINT: seems like a good default
+
+            /** Total size in bytes of memory mapped for objects in the large object space. */
+            size_t iLargeObjectSpaceSize = 0;
+
+            /**
+             * GC-owned heap for small objects.
+             *
+             * @remark Initialized in garbage collector's constructor.
+             */
+            std::shared_ptr<GcHeap> pHeap;
+
+            /**
+             * Heaps of thread-local garbage collectors that have promoted objects to this garbage collector
+             * (promoted objects are freed to the heap they were allocated from).
+             */
+            std::vector<std::shared_ptr<GcHeap>> vAdoptedHeaps;
+
+            /**
+             * Bump-pointer memory for small objects if this is a garbage collector of a @ref GcRegion
+             * (`nullptr` otherwise, regions create it themselves).
+             */
+            std::shared_ptr<GcRegionArena> pRegionArena = nullptr;
+
+            /**
+             * Memory of ended regions that still stores objects that escaped from those regions
+             * to this garbage collector.
+             */
+            std::vector<std::shared_ptr<GcRegionArena>> vAdoptedRegionArenas;
+
+            /** Bump-pointer blocks for new small objects (`nullptr` if the nursery was never enabled). */
+            std::shared_ptr<GcNursery> pNursery = nullptr;
+
+            /**
+             * Nurseries of thread-local garbage collectors that have promoted objects to this garbage
+             * collector (promoted objects are freed to the nursery they were allocated from).
+             */
+            std::vector<std::shared_ptr<GcNursery>> vAdoptedNurseries;
+
+            /** Defines whether new small objects are allocated in @ref pNursery. */
+            bool bUseNursery = false;
+
+            /** User-specified memory resource for new allocations (`nullptr` to use default sources). */
+            std::pmr::memory_resource* pMemoryResource = nullptr;
+
+            /** Defines whether objects are moved out of sparsely used heap pages after sweeping. */
+            bool bCompactHeap = false;
+
+            /** Defines whether GC pointers maintain reference counts of referenced allocations. */
+            bool bUseReferenceCounting = false;
+
+            /**
+             * `true` while objects are deleted or moved by the garbage collection (reference counts are
+             * recalculated after that).
+             */
+            bool bIgnoreReferenceCountChanges = false;
+
+            /** `true` while @ref vZeroCountAllocations is processed. */
+            bool bCollectingUnreferencedObjects = false;
+
+            /** Allocations which reference count is zero (might be referenced by root GC pointers). */
+            std::vector<GcAllocation*> vZeroCountAllocations;
+
+            /** Size of @ref vZeroCountAllocations after it was processed last time. */
+            size_t iRetainedZeroCountAllocationCount = 0;
+
+            /**
+             * Allocations which reference count was decremented to a non-zero value since the last
+             * trial deletion (possible roots of garbage cycles).
+             */
+            std::vector<GcAllocation*> vPossibleCycleRoots;
+
+            /** Allocations referenced by root GC pointers while @ref vZeroCountAllocations is processed. */
+            std::unordered_set<GcAllocation*> rootReferencedAllocations;
+
+            /** Memory allocated by `GcTracingAllocator`s (sorted by start address). */
+            std::map<std::byte*, TracedMemoryBlock> tracedMemoryBlocks;
+
+            /** Memory from @ref tracedMemoryBlocks (that has an owner) by owner. */
+            std::unordered_map<GcAllocation*, std::vector<std::byte*>> ownedTracedMemoryBlocks;
         };
 
         /** Groups mutex guarded data used by GC. */
@@ -113,9 +568,10 @@ namespace sgc {
 
             /** Info about allocations. */
             AllocationData allocationData;
-        };
 
-        GarbageCollector();
+            /** Thread-local garbage collectors that use this garbage collector as a shared one. */
+            std::vector<GarbageCollector*> vThreadLocalGarbageCollectors;
+        };
 
         /**
          * Called by GC pointers or GC containers in their constructor to check that node (pointer or a
@@ -136,6 +592,305 @@ namespace sgc {
          */
         void onGcRootNodeBeingDestroyed(GcNode* pRootNode);
 
+        /**
+         * Called by GC pointers (that belong to this garbage collector) before they start referencing
+         * the specified allocation, promotes thread-local allocations if needed.
+         *
+         * @remark Triggers a critical error if the allocation can't be referenced by this garbage
+         * collector's nodes.
+         *
+         * @warning Expects that the mutex of this garbage collector is locked.
+         *
+         * @param pAllocation Allocation that will be referenced (might be `nullptr`).
+         */
+        void onAllocationBeingReferenced(GcAllocation* pAllocation);
+
+        /**
+         * Looks for an allocation (by its info) in thread-local garbage collectors of this garbage collector.
+         *
+         * @warning Expects that the mutex of this garbage collector is locked.
+         *
+         * @param pAllocationInfo Allocation info to look for.
+         *
+         * @return `nullptr` if not found, otherwise allocation.
+         */
+        GcAllocation* findThreadLocalAllocation(GcAllocationInfo* pAllocationInfo);
+
+        /**
+         * Looks for an allocation of this garbage collector which object contains the specified address
+         * (an interior pointer, for example a pointer to a non-primary base or a field of the object).
+         *
+         * @remark Takes constant time for objects in GC heaps and for objects that are bigger than a page,
+         * otherwise proportional to the number of small objects that share a page.
+         *
+         * @warning Expects that the mutex of this garbage collector is locked.
+         *
+         * @param pAddress Address of any byte of an object.
+         *
+         * @return `nullptr` if not found, otherwise allocation.
+         */
+        GcAllocation* findAllocationContaining(const void* pAddress);
+
+        /**
+         * Looks for an allocation which object contains the specified address in thread-local garbage
+         * collectors of this garbage collector.
+         *
+         * @warning Expects that the mutex of this garbage collector is locked.
+         *
+         * @param pAddress Address of any byte of an object.
+         *
+         * @return `nullptr` if not found, otherwise allocation.
+         */
+        GcAllocation* findThreadLocalAllocationContaining(const void* pAddress);
+
+        /**
+         * Moves the specified allocation of a thread-local garbage collector and all allocations of that
+         * thread-local garbage collector reachable from it to this garbage collector.
+         *
+         * @warning Expects that the mutex of this garbage collector is locked.
+         *
+         * @param pAllocation Allocation of a thread-local garbage collector of this garbage collector.
+         */
+        void promoteAllocation(GcAllocation* pAllocation);
+
+        /**
+         * Moves root nodes of this thread-local (or region) garbage collector that are still alive to the
+         * shared garbage collector and promotes objects that are reachable from them.
+         *
+         * @warning Expects that mutexes of this and the shared garbage collector are locked.
+         */
+        void moveRootNodesToSharedGarbageCollector();
+
+        /**
+         * Called by a @ref GcRegion (that uses this garbage collector) when it ends to move escaping
+         * objects (referenced from GC nodes that outlive the region) to the shared garbage collector
+         * and delete the rest of the region's objects.
+         */
+        void onRegionEnded();
+
+        /**
+         * Moves objects out of sparsely used pages of our heap.
+         *
+         * @warning Expects that the mutex of this garbage collector is locked.
+         *
+         * @return Number of moved objects.
+         */
+        size_t compactHeap();
+
+        /**
+         * Called by GC pointers (that belong to this garbage collector) when reference counting is enabled
+         * before they start referencing a different allocation (or are destroyed).
+         *
+         * @warning Expects that the mutex of this garbage collector is locked.
+         *
+         * @param pGcPtr         GC pointer that changes its allocation.
+         * @param pOldAllocation Currently referenced allocation (might be `nullptr`).
+         * @param pNewAllocation Allocation that will be referenced (might be `nullptr`).
+         */
+        void onReferenceChanged(
+            const GcPtrBase* pGcPtr, GcAllocation* pOldAllocation, GcAllocation* pNewAllocation);
+
+        /**
+         * Called by GC pointers when reference counting is enabled after a new object was constructed
+         * (the object is referenced by the root GC pointer created in `makeGc`).
+         *
+         * @remark Might delete unreferenced objects.
+         *
+         * @warning Expects that the mutex of this garbage collector is locked.
+         *
+         * @param pAllocation New allocation.
+         */
+        void onAllocationConstructed(GcAllocation* pAllocation);
+
+        /**
+         * Recalculates reference counts of our allocations and fills the table of zero count allocations.
+         *
+         * @warning Expects that the mutex of this garbage collector is locked.
+         */
+        void recalculateReferenceCounts();
+
+        /**
+         * Deletes allocations from the table of zero count allocations that are not referenced by root
+         * GC pointers.
+         *
+         * @warning Expects that the mutex of this garbage collector is locked.
+         *
+         * @return Number of deleted allocations.
+         */
+        size_t deleteUnreferencedAllocations();
+
+        /**
+         * Runs trial deletion on allocations reachable from @ref AllocationData::vPossibleCycleRoots and
+         * deletes garbage cycles.
+         *
+         * @warning Expects that the mutex of this garbage collector is locked.
+         *
+         * @return Number of deleted allocations.
+         */
+        size_t deleteUnreferencedCycles();
+
+        /**
+         * Tells if unreferenced allocations can be deleted now (see @ref deleteUnreferencedAllocations).
+         *
+         * @warning Expects that the mutex of this garbage collector is locked.
+         *
+         * @return `false` if this garbage collector has thread-local garbage collectors, objects are being
+         * constructed or unreferenced objects are already being deleted.
+         */
+        bool canDeleteUnreferencedAllocations();
+
+        /**
+         * Collects allocations referenced by our root GC pointers (including GC pointers on registered
+         * thread stacks) into @ref AllocationData::rootReferencedAllocations.
+         *
+         * @warning Expects that the mutex of this garbage collector is locked.
+         */
+        void findRootReferencedAllocations();
+
+        /**
+         * Scans thread stacks registered using @ref GcThreadStack for GC pointers of this garbage collector
+         * (that are not in the root set) and returns allocations that they reference.
+         *
+         * @warning Expects that the mutex of this garbage collector is locked.
+         *
+         * @return Referenced allocations (might contain duplicates).
+         */
+        std::vector<GcAllocation*> findStackReferencedAllocations();
+
+        /**
+         * Deletes the specified allocations (without updating reference counts of objects that they
+         * reference).
+         *
+         * @remark All allocations are removed from our "database" and pins on them are dropped before
+         * destructors of their objects are called and memory is freed only after all destructors finished
+         * (so destructors of garbage objects can safely unpin other garbage, see `GcAtomicPtr`).
+         *
+         * @warning Expects that the mutex of this garbage collector is locked.
+         *
+         * @param vAllocations Allocations to delete.
+         */
+        void deleteAllocations(const std::vector<GcAllocation*>& vAllocations);
+
+        /**
+         * Looks for the allocation of the specified object to own memory of a `GcTracingAllocator`.
+         *
+         * @param pOwnerObject Object of the user-specified type.
+         *
+         * @return `nullptr` if the object was not allocated by this garbage collector, otherwise allocation.
+         */
+        GcAllocation* findTracedMemoryOwner(const void* pOwnerObject);
+
+        /**
+         * Allocates zero-initialized memory for a `GcTracingAllocator`. GC pointers constructed in this
+         * memory are found by scanning it (they are not root nodes).
+         *
+         * @remark Throws `std::bad_alloc` if failed.
+         *
+         * @param iSizeInBytes Size of the memory.
+         * @param iAlignment   Alignment of the memory.
+         * @param pOwner       Allocation of the object that owns the memory (`nullptr` if the memory is a
+         * root).
+         *
+         * @return Allocated memory.
+         */
+        void* allocateTracedMemory(size_t iSizeInBytes, size_t iAlignment, GcAllocation* pOwner);
+
+        /**
+         * Frees memory returned by @ref allocateTracedMemory.
+         *
+         * @param pMemory      Memory to free.
+         * @param iSizeInBytes Size that was specified in @ref allocateTracedMemory.
+         * @param iAlignment   Alignment that was specified in @ref allocateTracedMemory.
+         */
+        void freeTracedMemory(void* pMemory, size_t iSizeInBytes, size_t iAlignment) noexcept;
+
+        /**
+         * Makes memory of `GcTracingAllocator`s owned by the specified allocation a root (memory that is not
+         * freed by the owner's destructor stays a root).
+         *
+         * @warning Expects that the mutex of this garbage collector is locked.
+         *
+         * @param pAllocation Allocation that is about to be deleted.
+         */
+        void onTracedMemoryOwnerBeingDeleted(GcAllocation* pAllocation);
+
+        /**
+         * Calls the specified callback for each GC pointer of this garbage collector (that is not in the
+         * root set) found in the specified traced memory block.
+         *
+         * @warning Expects that the mutex of this garbage collector is locked.
+         *
+         * @param pBlock       Start of a block from @ref AllocationData::tracedMemoryBlocks.
+         * @param iSizeInBytes Size of the block.
+         * @param onGcPtr      Callback.
+         */
+        void forEachGcPtrInTracedMemory(
+            const std::byte* pBlock,
+            size_t iSizeInBytes,
+            const std::function<void(const GcPtrBase*)>& onGcPtr);
+
+        /**
+         * Calls the specified callback for each GC pointer field and each GC pointer item of GC container
+         * fields of the object of the specified allocation (including GC pointers in memory of
+         * `GcTracingAllocator`s owned by the object).
+         *
+         * @warning Expects that the mutex of this garbage collector is locked.
+         *
+         * @param pAllocation Allocation.
+         * @param onGcPtr     Callback.
+         */
+        void forEachGcPtrOfAllocation(
+            GcAllocation* pAllocation, const std::function<void(const GcPtrBase*)>& onGcPtr);
+
+        /**
+         * Returns garbage collector by its ID (see @ref getId).
+         *
+         * @remark Defined in the header so that GC nodes find their garbage collector without a function
+         * call.
+         *
+         * @param iId ID of an existing garbage collector.
+         *
+         * @return Garbage collector.
+         */
+        static inline GarbageCollector* getById(uint16_t iId) { return vGarbageCollectorsById[iId]; }
+
+        /**
+         * Returns ID of this garbage collector that GC nodes store to reference it (IDs of destroyed
+         * garbage collectors are reused).
+         *
+         * @return ID.
+         */
+        inline uint16_t getId() const { return iId; }
+
+        /**
+         * Picks a free ID for a new garbage collector and registers it under this ID.
+         *
+         * @remark Triggers a critical error if too many garbage collectors exist.
+         *
+         * @param pGarbageCollector New garbage collector.
+         *
+         * @return ID.
+         */
+        static uint16_t registerGarbageCollector(GarbageCollector* pGarbageCollector);
+
+        /**
+         * Makes the ID of a destroyed garbage collector free to use.
+         *
+         * @param iId ID returned by @ref registerGarbageCollector.
+         */
+        static void unregisterGarbageCollector(uint16_t iId);
+
+        /**
+         * Tells if allocations of the specified garbage collector are traced by this garbage collector.
+         *
+         * @param pGarbageCollector Garbage collector of some allocation.
+         *
+         * @return `true` if this garbage collector or its thread-local garbage collector, `false` otherwise.
+         */
+        inline bool isTracing(const GarbageCollector* pGarbageCollector) const {
+            return pGarbageCollector == this || pGarbageCollector->pSharedGarbageCollector == this;
+        }
+
         /** Used by GC data */
         std::pair<std::recursive_mutex, GarbageCollectionData> mtxGcData;
 
@@ -166,5 +921,30 @@ namespace sgc {
          * not scanned for inner GcPtr fields yet.
          */
         std::vector<GcAllocation*> vGrayAllocations;
+
+        /** `nullptr` for usual garbage collectors, otherwise garbage collector of a thread-local one. */
+        GarbageCollector* const pSharedGarbageCollector = nullptr;
+
+        /** Thread that created this garbage collector. */
+        const std::thread::id owningThreadId = std::this_thread::get_id();
+
+        /** ID that GC nodes store to reference this garbage collector (see @ref getById). */
+        const uint16_t iId = 0;
+
+        /**
+         * Existing garbage collectors by their IDs.
+         *
+         * @remark An entry is written when a garbage collector is created (before its nodes can exist) so
+         * reading it does not need a lock.
+         */
+        static inline std::array<GarbageCollector*, iMaxGarbageCollectorCount> vGarbageCollectorsById{};
+
+        /**
+         * Garbage collector bound to the current thread using @ref GcScope (`nullptr` if not bound).
+         *
+         * @remark Constant-initialized in the header so that other translation units access it directly
+         * (without a call to a thread-local wrapper function).
+         */
+        static inline thread_local GarbageCollector* pThreadGarbageCollector = nullptr;
     };
 }
@@ -0,0 +1,354 @@
+#pragma once
+
+// Standard.
+#include <atomic>
+#include <mutex>
+
+// Custom.
+#include "GcPtr.h"
+#include "gccontainers/GcVector.hpp"
+
+namespace sgc {
+    /**
+     * GC pointer that can be read and modified by multiple threads without an external mutex, works
+     * similar to `std::atomic<std::shared_ptr>`.
+     *
+     * Modifications (`store`, `exchange`, `compare_exchange_*`) lock the mutex of the garbage collector
+     * (like modifications of a `GcPtr` do) and then publish the new object using the specified memory
+     * order, readers can get the published object without locking using @ref read:
+     * @code
+     * sgc::GcAtomicPtr<Config> pConfig(sgc::makeGc<Config>());
+     *
+     * // Writer thread.
+     * auto pNewConfig = sgc::makeGc<Config>(*pConfig.load());
+     * pNewConfig->iValue = 2;
+     * pConfig.store(pNewConfig, std::memory_order_release);
+     *
+     * // Reader thread.
+     * const auto iValue = pConfig.read(std::memory_order_acquire)->iValue;
+     * @endcode
+     *
+     * @remark Objects that are replaced while readers exist are kept alive (and pinned) until a
+     * modification sees no readers, so readers that never stop overlapping keep all replaced objects alive.
+     *
+     * @remark Like `GcPtr` it's a root node when used as a local variable and a traced field when used
+     * as a field of an object created using `makeGc`.
+     *
+     * @tparam Type Type of the object that the pointer references.
+     */
+    template <typename Type> class GcAtomicPtr {
+    public:
+        /** Creates an empty pointer. */
+        GcAtomicPtr() = default;
+
+        /**
+         * Creates a pointer to the specified object.
+         *
+         * @param pDesired Object to reference.
+         */
+        GcAtomicPtr(const GcPtr<Type>& pDesired) { store(pDesired); }
+
+        /** Releases the referenced object. */
+        ~GcAtomicPtr() {
+            std::scoped_lock guard(*getGarbageCollectionMutex());
+
+            pTarget.setAllocationPinned(false);
+            releaseRetiredTargets();
+        }
+
+        GcAtomicPtr(const GcAtomicPtr&) = delete;
+        GcAtomicPtr& operator=(const GcAtomicPtr&) = delete;
+
+        GcAtomicPtr(GcAtomicPtr&&) noexcept = delete;
+        GcAtomicPtr& operator=(GcAtomicPtr&&) noexcept = delete;
+
+        /**
+         * RAII-style object returned by @ref read that gives access to the object that was referenced when
+         * the guard was created, the object stays alive (and in place) until the guard is destroyed even if
+         * it's replaced.
+         */
+        class ReadGuard {
+        public:
+            ReadGuard() = delete;
+
+            /**
+             * Registers a reader and loads the referenced object.
+             *
+             * @param pAtomicPtr Atomic pointer to read.
+             * @param order      Memory order of the load.
+             */
+            ReadGuard(const GcAtomicPtr* pAtomicPtr, std::memory_order order) noexcept
+                : pAtomicPtr(pAtomicPtr) {
+                pAtomicPtr->iReaderCount.fetch_add(1, std::memory_order_relaxed);
+
+                // Either a writer sees us or we see its object (pairs with the fence in `replaceTarget`).
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+
+                pObject = pAtomicPtr->pPublishedObject.load(order);
+            }
+
+            /** Unregisters the reader. */
+            ~ReadGuard() { pAtomicPtr->iReaderCount.fetch_sub(1, std::memory_order_release); }
+
+            ReadGuard(const ReadGuard&) = delete;
+            ReadGuard& operator=(const ReadGuard&) = delete;
+
+            ReadGuard(ReadGuard&&) noexcept = delete;
+            ReadGuard& operator=(ReadGuard&&) noexcept = delete;
+
+            /**
+             * Returns the object.
+             *
+             * @return `nullptr` if the atomic pointer was empty.
+             */
+            inline Type* get() const { return pObject; }
+
+            /**
+             * Returns the object.
+             *
+             * @return Object.
+             */
+            inline Type* operator->() const { return pObject; }
+
+            /**
+             * Returns the object.
+             *
+             * @return Object.
+             */
+            inline Type& operator*() const { return *pObject; }
+
+        private:
+            /** Atomic pointer that is being read. */
+            const GcAtomicPtr* const pAtomicPtr = nullptr;
+
+            /** Object that was referenced when the guard was created. */
+            Type* pObject = nullptr;
+        };
+
+        /**
+         * Returns the referenced object without locking and keeps it alive while the returned guard exists.
+         *
+         * @remark Costs an atomic increment and decrement of a reader counter shared by all readers of this
+         * pointer (but no locking).
+         *
+         * @param order Memory order of the load, use `std::memory_order_acquire` (or stronger) to see
+         * modifications of the object that were made before it was stored.
+         *
+         * @return Guard that gives access to the object.
+         */
+        inline ReadGuard read(std::memory_order order = std::memory_order_seq_cst) const noexcept {
+            return ReadGuard(this, order);
+        }
+
+        /**
+         * Returns the referenced object without locking.
+         *
+         * @remark The referenced object is pinned (not moved by heap compaction) so the returned pointer
+         * stays valid while this atomic pointer references the object.
+         *
+         * @warning Nothing protects the object once it's replaced: the returned pointer is only valid until
+         * the next garbage collection (or right until the replacement if reference counting is enabled)
+         * unless the object is referenced by a GC pointer, use @ref read (or @ref load to get a GC pointer)
+         * if the object might be replaced while it's used.
+         *
+         * @param order Memory order of the load, use `std::memory_order_acquire` (or stronger) to see
+         * modifications of the object that were made before it was stored.
+         *
+         * @return Referenced object (`nullptr` if empty).
+         */
+        inline Type* loadRaw(std::memory_order order = std::memory_order_seq_cst) const noexcept {
+            return pPublishedObject.load(order);
+        }
+
+        /**
+         * Returns a GC pointer to the referenced object.
+         *
+         * @remark Always locks the garbage collector's mutex (creating a GC pointer requires it) which makes
+         * the load sequentially consistent with all modifications whatever memory order is specified, use
+         * @ref read to avoid locking.
+         *
+         * @param order Ignored, exists for compatibility with `std::atomic`.
+         *
+         * @return GC pointer (`nullptr` if empty).
+         */
+        inline GcPtr<Type> load([[maybe_unused]] std::memory_order order = std::memory_order_seq_cst) const {
+            std::scoped_lock guard(*getGarbageCollectionMutex());
+
+            return pTarget;
+        }
+
+        /**
+         * Replaces the referenced object.
+         *
+         * @param pDesired Object to reference.
+         * @param order    Memory order used to publish the object to @ref loadRaw.
+         */
+        inline void store(const GcPtr<Type>& pDesired, std::memory_order order = std::memory_order_seq_cst) {
+            std::scoped_lock guard(*getGarbageCollectionMutex());
+
+            replaceTarget(pDesired, order);
+        }
+
+        /**
+         * Replaces the referenced object.
+         *
+         * @param pDesired Object to reference.
+         * @param order    Memory order used to publish the object to @ref loadRaw.
+         *
+         * @return Previously referenced object.
+         */
+        inline GcPtr<Type>
+        exchange(const GcPtr<Type>& pDesired, std::memory_order order = std::memory_order_seq_cst) {
+            std::scoped_lock guard(*getGarbageCollectionMutex());
+
+            GcPtr<Type> pPrevious = pTarget;
+            replaceTarget(pDesired, order);
+
+            return pPrevious;
+        }
+
+        /**
+         * Replaces the referenced object if it's the expected one, otherwise loads the referenced object
+         * into the expected one.
+         *
+         * @param pExpected Object that is expected to be referenced, receives the referenced object on
+         * failure.
+         * @param pDesired  Object to reference.
+         * @param order     Memory order used to publish the object to @ref loadRaw on success.
+         *
+         * @return `true` if replaced, `false` otherwise.
+         */
+        inline bool compare_exchange_strong( // NOLINT: use name style as STL
+            GcPtr<Type>& pExpected,
+            const GcPtr<Type>& pDesired,
+            std::memory_order order = std::memory_order_seq_cst) {
+            std::scoped_lock guard(*getGarbageCollectionMutex());
+
+            if (pTarget != pExpected) {
+                pExpected = pTarget;
+                return false;
+            }
+
+            replaceTarget(pDesired, order);
+
+            return true;
+        }
+
+        /**
+         * Replaces the referenced object if it's the expected one, otherwise loads the referenced object
+         * into the expected one.
+         *
+         * @param pExpected Object that is expected to be referenced (for example returned by
+         * @ref loadRaw), receives the referenced object on failure.
+         * @param pDesired  Object to reference.
+         * @param order     Memory order used to publish the object to @ref loadRaw on success.
+         *
+         * @return `true` if replaced, `false` otherwise.
+         */
+        inline bool compare_exchange_strong( // NOLINT: use name style as STL
+            Type*& pExpected,
+            const GcPtr<Type>& pDesired,
+            std::memory_order order = std::memory_order_seq_cst) {
+            std::scoped_lock guard(*getGarbageCollectionMutex());
+
+            if (pTarget.get() != pExpected) {
+                pExpected = pTarget.get();
+                return false;
+            }
+
+            replaceTarget(pDesired, order);
+
+            return true;
+        }
+
+        /**
+         * Same as @ref compare_exchange_strong (never fails spuriously).
+         *
+         * @param pExpected Object that is expected to be referenced, receives the referenced object on
+         * failure.
+         * @param pDesired  Object to reference.
+         * @param order     Memory order used to publish the object to @ref loadRaw on success.
+         *
+         * @return `true` if replaced, `false` otherwise.
+         */
+        template <typename Expected>
+        inline bool compare_exchange_weak( // NOLINT: use name style as STL
+            Expected& pExpected,
+            const GcPtr<Type>& pDesired,
+            std::memory_order order = std::memory_order_seq_cst) {
+            return compare_exchange_strong(pExpected, pDesired, order);
+        }
+
+    private:
+        /**
+         * Returns mutex of the garbage collector of the referenced object.
+         *
+         * @return Garbage collection mutex.
+         */
+        inline std::recursive_mutex* getGarbageCollectionMutex() const {
+            return pTarget.getGarbageCollector()->getGarbageCollectionMutex();
+        }
+
+        /**
+         * Makes @ref pTarget reference the specified object and publishes it.
+         *
+         * @warning Expects that the garbage collection mutex is locked.
+         *
+         * @param pDesired Object to reference.
+         * @param order    Memory order used to publish the object.
+         */
+        inline void replaceTarget(const GcPtr<Type>& pDesired, std::memory_order order) {
+            GcPtr<Type> pReplaced = pTarget;
+            pTarget = pDesired;
+            pTarget.setAllocationPinned(true);
+
+            pPublishedObject.store(pTarget.get(), order);
+
+            // Readers that registered before the store might still use the replaced object (pairs with the
+            // fence in `ReadGuard`).
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (iReaderCount.load(std::memory_order_acquire) != 0) {
+                if (pReplaced != nullptr) {
+                    // Stays pinned.
+                    vRetiredTargets.push_back(pReplaced);
+                }
+                return;
+            }
+
+            // Readers that exist from now on only see the new object.
+            pReplaced.setAllocationPinned(false);
+            releaseRetiredTargets();
+        }
+
+        /**
+         * Unpins and releases objects that were kept alive for readers.
+         *
+         * @warning Expects that the garbage collection mutex is locked.
+         */
+        inline void releaseRetiredTargets() {
+            if (vRetiredTargets.empty()) [[likely]] {
+                return;
+            }
+
+            for (auto& pRetiredTarget : vRetiredTargets) {
+                pRetiredTarget.setAllocationPinned(false);
+            }
+            vRetiredTargets.clear();
+        }
+
+        /** Referenced object (traced by the garbage collector), modified under garbage collection mutex. */
+        GcPtr<Type> pTarget;
+
+        /**
+         * Replaced objects (pinned) that readers registered by @ref ReadGuard might still use, modified under
+         * garbage collection mutex.
+         */
+        GcVector<GcPtr<Type>> vRetiredTargets;
+
+        /** Object of @ref pTarget for readers that don't lock. */
+        std::atomic<Type*> pPublishedObject{nullptr};
+
+        /** Number of existing @ref ReadGuard objects. */
+        mutable std::atomic<size_t> iReaderCount{0};
+    };
+}
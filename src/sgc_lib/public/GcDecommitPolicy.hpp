@@ -0,0 +1,34 @@
+#pragma once
+
+// Standard.
+#include <cstddef>
+
+namespace sgc {
+    /**
+     * Defines when memory of GC heap pages that became empty (after garbage collection) is returned
+     * to the OS.
+     *
+     * @remark Empty pages are reused for new allocations as long as they are not returned to the OS,
+     * returning memory too eagerly makes allocations after a collection more expensive.
+     */
+    struct GcDecommitPolicy {
+        /**
+         * Number of garbage collections that a page should stay empty before its memory is returned
+         * to the OS, `0` to return memory of empty pages right after the collection that emptied them.
+         */
+        size_t iDecommitDelay = 1;
+
+        /**
+         * Number of most recently emptied pages that are never returned to the OS (kept for new
+         * allocations).
+         */
+        size_t iRetainedEmptyPageCount = 16; // NOLINT: 1 MB of 64 KB pages
+
+        /**
+         * `true` to let the OS reclaim memory lazily (`MADV_FREE`, memory is only reclaimed under memory
+         * pressure, cheaper but RSS does not drop right away), `false` to reclaim memory right away
+         * (`MADV_DONTNEED`).
+         */
+        bool bLazyDecommit = false;
+    };
+}
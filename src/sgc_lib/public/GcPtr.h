@@ -1,9 +1,13 @@
 #pragma once
 
+// Standard.
+#include <cstdint>
+
 // Custom.
 #include "GarbageCollector.h"
 #include "GcTypeInfo.h"
 #include "GcAllocation.h"
+#include "GcAllocationRef.hpp"
 #include "GcNode.hpp"
 #include "DebugLogger.hpp"
 
@@ -16,6 +20,18 @@ namespace sgc {
         // Garbage collector inspects referenced allocation.
         friend class GarbageCollector;
 
+        // Pins referenced allocation.
+        template <typename> friend class GcPin;
+
+        // Pins referenced allocation while it's published to readers that don't lock.
+        template <typename> friend class GcAtomicPtr;
+
+        // Creates pointers to objects from their allocation.
+        template <typename> friend class EnableGcFromThis;
+
+        // Stores a tag in low bits of the referenced allocation.
+        template <typename, size_t> friend class GcTaggedPtr;
+
     public:
         GcPtrBase() = delete;
 
@@ -32,7 +48,15 @@ namespace sgc {
          * @return `nullptr` if this GC pointer is empty (just like a usual pointer), otherwise valid
          * pointer.
          */
-        void* getUserObject() const;
+        inline void* getUserObject() const {
+            // Make sure allocation is valid.
+            const auto pReferencedAllocation = pAllocation.get();
+            if (pReferencedAllocation == nullptr) {
+                return nullptr;
+            }
+
+            return static_cast<char*>(pReferencedAllocation->getAllocatedObject()) + iUserObjectOffset;
+        }
 
     protected:
         /**
@@ -43,6 +67,35 @@ namespace sgc {
          */
         explicit GcPtrBase(bool bCanBeRootNode);
 
+        /**
+         * Constructor for pointers that are created from other pointers.
+         *
+         * @param bCanBeRootNode    `true` if this pointer can be a root node in the GC graph, `false`
+         * otherwise.
+         * @param pGarbageCollector Garbage collector that the pointer will belong to (garbage collector of
+         * the pointer to copy/move from).
+         */
+        GcPtrBase(bool bCanBeRootNode, GarbageCollector* pGarbageCollector);
+
+        /**
+         * Picks a garbage collector for a pointer that is created from another pointer.
+         *
+         * @remark A pointer created inside of a GC object that is being constructed or inside of a GC
+         * container belongs to the owner's garbage collector (so referencing an object of a different
+         * garbage collector triggers a critical error just like an assignment does). Returns the garbage
+         * collector bound to the current thread if the other pointer belongs to its thread-local garbage
+         * collector (for example when thread-local objects are added to a GC container of the shared
+         * garbage collector), otherwise garbage collector of the other pointer.
+         *
+         * @param pNewPointer    Memory of the pointer being constructed.
+         * @param bCanBeRootNode `false` if the new pointer is an item of a GC container.
+         * @param pOther         Pointer to copy/move from.
+         *
+         * @return Garbage collector for the new pointer.
+         */
+        static GarbageCollector*
+        pickGarbageCollector(const void* pNewPointer, bool bCanBeRootNode, const GcPtrBase& pOther);
+
         /** Must be called by derived types in their destructor. */
         void onGcPtrBeingDestroyed();
 
@@ -57,14 +110,19 @@ namespace sgc {
         template <typename Type, typename... ConstructorArgs>
         inline void* initializeFromNewAllocation(ConstructorArgs&&... constructorArgs) {
             // Make sure we are not running a garbage collection while creating a new allocation.
-            std::scoped_lock guard(*GarbageCollector::get().getGarbageCollectionMutex());
+            std::scoped_lock guard(*getGarbageCollector()->getGarbageCollectionMutex());
 
             SGC_DEBUG_LOG(
                 std::format("GcPtr {} started creating a new allocation", reinterpret_cast<uintptr_t>(this)));
 
             // Create a new allocation (it's added to the GC "database" in allocation's constructor).
             pAllocation = GcAllocation::registerNewAllocationWithInfo<Type>(
-                std::forward<ConstructorArgs>(constructorArgs)...);
+                getGarbageCollector(), std::forward<ConstructorArgs>(constructorArgs)...);
+            iUserObjectOffset = 0;
+
+            if (getGarbageCollector()->mtxGcData.second.allocationData.bUseReferenceCounting) [[unlikely]] {
+                getGarbageCollector()->onAllocationConstructed(pAllocation);
+            }
 
             SGC_DEBUG_LOG(std::format(
                 "GcPtr {} finished creating a new allocation with user object {}",
@@ -78,6 +136,10 @@ namespace sgc {
          * Looks for an allocation info object near the specified pointer to the user object
          * and makes this GC pointer to point to a different GC allocation info.
          *
+         * @remark The pointer can also point inside of an object created using `makeGc` (for example
+         * a pointer to a non-primary base type), in this case the allocation is found using the garbage
+         * collector's page table.
+         *
          * @warning If the pointer to the specified object was not previously created using `makeGc`
          * an error will be triggered.
          *
@@ -86,13 +148,117 @@ namespace sgc {
          */
         void setAllocationFromUserObject(void* pUserObject);
 
+        /**
+         * Makes this GC pointer to point to the same allocation as the specified GC pointer.
+         *
+         * @remark Unlike @ref setAllocationFromUserObject does not look for the allocation in the garbage
+         * collector's "database" since the specified pointer already references a valid allocation.
+         *
+         * @param pOther GC pointer to copy the allocation from.
+         */
+        void setAllocationFromOtherPointer(const GcPtrBase& pOther);
+
+        /**
+         * Makes this GC pointer to point to the same allocation as the specified GC pointer and clears
+         * the specified GC pointer.
+         *
+         * @remark Unlike @ref setAllocationFromUserObject does not look for the allocation in the garbage
+         * collector's "database" since the specified pointer already references a valid allocation.
+         *
+         * @param pOther GC pointer to move the allocation from.
+         */
+        void moveAllocationFromOtherPointer(GcPtrBase& pOther);
+
+        /**
+         * Makes this GC pointer to point to an object of the specified allocation.
+         *
+         * @remark Unlike @ref setAllocationFromUserObject does not look for the allocation in the garbage
+         * collector's "database" since the allocation is known.
+         *
+         * @param pKnownAllocation Allocation to reference.
+         * @param pUserObject      Pointer to the allocated object (or to a part of it, for example to a
+         * non-primary base type).
+         */
+        void setAllocationFromKnownAllocation(GcAllocation* pKnownAllocation, void* pUserObject);
+
     private:
+#if defined(SGC_COMPRESSED_REFERENCES)
+        /**
+         * Type of @ref iUserObjectOffset (small enough to keep the size of compressed GC pointers).
+         *
+         * @warning Limits interior pointers to parts of objects that start within the first 64 KB of the
+         * object.
+         */
+        using UserObjectOffset = uint16_t;
+#else
+        /** Type of @ref iUserObjectOffset (fits into padding of the base type). */
+        using UserObjectOffset = uint32_t;
+#endif
+
+        /**
+         * Returns offset of the specified object from the start of the object of the specified allocation.
+         *
+         * @remark Triggers a critical error if the offset does not fit into @ref UserObjectOffset.
+         *
+         * @param pAllocation Allocation that contains the object.
+         * @param pUserObject Pointer to the allocated object (or to a part of it).
+         *
+         * @return Offset in bytes.
+         */
+        static UserObjectOffset getUserObjectOffset(GcAllocation* pAllocation, void* pUserObject);
+
+        /**
+         * Makes this GC pointer reference the specified allocation (updates reference counts if enabled).
+         *
+         * @warning Expects that the mutex of the pointer's garbage collector is locked.
+         *
+         * @param pNewAllocation        Allocation to reference (might be `nullptr`).
+         * @param iNewUserObjectOffset  Offset in bytes of the referenced object from the start of the
+         * allocated object (see @ref iUserObjectOffset).
+         */
+        inline void setAllocation(GcAllocation* pNewAllocation, UserObjectOffset iNewUserObjectOffset = 0) {
+            if (getGarbageCollector()->mtxGcData.second.allocationData.bUseReferenceCounting) [[unlikely]] {
+                getGarbageCollector()->onReferenceChanged(this, pAllocation, pNewAllocation);
+            }
+
+            pAllocation = pNewAllocation;
+            iUserObjectOffset = iNewUserObjectOffset;
+        }
+
+        /**
+         * Forbids (or allows again) moving the referenced object during heap compaction.
+         *
+         * @param bPin `true` to pin, `false` to undo a previous pin.
+         */
+        void setAllocationPinned(bool bPin);
+
+        /**
+         * Clears this GC pointer without locking the mutex of its garbage collector if it's found by
+         * scanning thread stacks.
+         *
+         * @remark The garbage collector only reads such pointers while copying registered thread stacks so
+         * the copy sees either the previous reference (the object survives one more garbage collection)
+         * or no reference, references from root nodes are not counted so reference counts don't change.
+         *
+         * @return `true` if cleared, `false` if this is not a scanned node (lock the mutex and use
+         * @ref setAllocation instead).
+         */
+        bool tryClearScannedNode();
+
+        /**
+         * Offset in bytes of the object that this pointer is pointing to from the start of the allocated
+         * object (not zero when pointing to a non-primary base type of the allocated object).
+         *
+         * @remark Declared before @ref pAllocation to fit into padding of the base type.
+         */
+        UserObjectOffset iUserObjectOffset = 0;
+
         /**
          * Allocation that this pointer is pointing to.
          *
          * @remark Can be `nullptr` if this GC pointer is empty (just like a usual pointer).
          */
-        GcAllocation* pAllocation = nullptr;
+        GcAllocationRef pAllocation;
     };
 
     /**
@@ -141,8 +307,9 @@ namespace sgc {
          *
          * @param pOther GC pointer to copy.
          */
-        GcPtr(const GcPtr<Type, bCanBeRootNode>& pOther) : GcPtrBase(bCanBeRootNode) {
-            updateInternalPointers(pOther.get());
+        GcPtr(const GcPtr<Type, bCanBeRootNode>& pOther)
+            : GcPtrBase(bCanBeRootNode, pickGarbageCollector(this, bCanBeRootNode, pOther)) {
+            copyInternalPointers(pOther);
         }
 
         /**
@@ -150,7 +317,8 @@ namespace sgc {
          *
          * @param pOther GC pointer to move.
          */
-        GcPtr(GcPtr<Type, bCanBeRootNode>&& pOther) noexcept : GcPtrBase(bCanBeRootNode) {
+        GcPtr(GcPtr<Type, bCanBeRootNode>&& pOther) noexcept
+            : GcPtrBase(bCanBeRootNode, pickGarbageCollector(this, bCanBeRootNode, pOther)) {
             *this = std::move(pOther);
         };
 
@@ -159,8 +327,9 @@ namespace sgc {
          *
          * @param pOther GC pointer to copy.
          */
-        template <bool bOther> GcPtr(const GcPtr<Type, bOther>& pOther) : GcPtrBase(bCanBeRootNode) {
-            updateInternalPointers(pOther.get());
+        template <bool bOther> GcPtr(const GcPtr<Type, bOther>& pOther)
+            : GcPtrBase(bCanBeRootNode, pickGarbageCollector(this, bCanBeRootNode, pOther)) {
+            copyInternalPointers(pOther);
         }
 
         /**
@@ -168,7 +337,8 @@ namespace sgc {
          *
          * @param pOther GC pointer to move.
          */
-        template <bool bOther> GcPtr(GcPtr<Type, bOther>&& pOther) noexcept : GcPtrBase(bCanBeRootNode) {
+        template <bool bOther> GcPtr(GcPtr<Type, bOther>&& pOther) noexcept
+            : GcPtrBase(bCanBeRootNode, pickGarbageCollector(this, bCanBeRootNode, pOther)) {
             *this = std::move(pOther);
         };
 
@@ -179,7 +349,8 @@ namespace sgc {
          */
         template <typename ChildType>
             requires std::derived_from<ChildType, Type> && (!std::same_as<ChildType, Type>)
-        GcPtr(const GcPtr<ChildType, bCanBeRootNode>& pOther) : GcPtrBase(bCanBeRootNode) {
+        GcPtr(const GcPtr<ChildType, bCanBeRootNode>& pOther)
+            : GcPtrBase(bCanBeRootNode, pickGarbageCollector(this, bCanBeRootNode, pOther)) {
             updateInternalPointers(pOther.get());
         }
 
@@ -190,7 +361,8 @@ namespace sgc {
          */
         template <typename ChildType>
             requires std::derived_from<ChildType, Type> && (!std::same_as<ChildType, Type>)
-        GcPtr(GcPtr<ChildType, bCanBeRootNode>&& pOther) noexcept : GcPtrBase(bCanBeRootNode) {
+        GcPtr(GcPtr<ChildType, bCanBeRootNode>&& pOther) noexcept
+            : GcPtrBase(bCanBeRootNode, pickGarbageCollector(this, bCanBeRootNode, pOther)) {
             *this = std::move(pOther);
         };
 
@@ -201,7 +373,8 @@ namespace sgc {
          */
         template <typename ChildType, bool bOther>
             requires std::derived_from<ChildType, Type> && (!std::same_as<ChildType, Type>)
-        GcPtr(const GcPtr<ChildType, bOther>& pOther) : GcPtrBase(bCanBeRootNode) {
+        GcPtr(const GcPtr<ChildType, bOther>& pOther)
+            : GcPtrBase(bCanBeRootNode, pickGarbageCollector(this, bCanBeRootNode, pOther)) {
             updateInternalPointers(pOther.get());
         }
 
@@ -212,7 +385,8 @@ namespace sgc {
          */
         template <typename ChildType, bool bOther>
             requires std::derived_from<ChildType, Type> && (!std::same_as<ChildType, Type>)
-        GcPtr(GcPtr<ChildType, bOther>&& pOther) noexcept : GcPtrBase(bCanBeRootNode) {
+        GcPtr(GcPtr<ChildType, bOther>&& pOther) noexcept
+            : GcPtrBase(bCanBeRootNode, pickGarbageCollector(this, bCanBeRootNode, pOther)) {
             *this = std::move(pOther);
         };
 
@@ -238,7 +412,7 @@ namespace sgc {
          * @return This.
          */
         GcPtr& operator=(const GcPtr& pOther) {
-            updateInternalPointers(pOther.get());
+            copyInternalPointers(pOther);
             return *this;
         };
 
@@ -254,11 +428,8 @@ namespace sgc {
                 return *this;
             }
 
-            // "Move" data into self.
-            updateInternalPointers(pOther.get());
-
-            // Clear moved object.
-            pOther.updateInternalPointers(nullptr);
+            // Move data into self and clear moved object.
+            moveInternalPointers(pOther);
 
             return *this;
         };
@@ -271,7 +442,7 @@ namespace sgc {
          * @return This.
          */
         template <bool bOther> GcPtr& operator=(const GcPtr<Type, bOther>& pOther) {
-            updateInternalPointers(pOther.get());
+            copyInternalPointers(pOther);
             return *this;
         };
 
@@ -287,11 +458,8 @@ namespace sgc {
                 return *this;
             }
 
-            // "Move" data into self.
-            updateInternalPointers(pOther.get());
-
-            // Clear moved object.
-            pOther.updateInternalPointers(nullptr);
+            // Move data into self and clear moved object.
+            moveInternalPointers(pOther);
 
             return *this;
         };
@@ -485,6 +653,43 @@ namespace sgc {
 #endif
         }
 
+        /**
+         * Makes this GC pointer to point to the same object as the specified GC pointer of the same type.
+         *
+         * @remark Copies the referenced allocation directly (no lookup in the garbage collector's
+         * "database"). Not used for pointers to child types since the user object of the parent type
+         * is not guaranteed to start at the same address.
+         *
+         * @param pOther GC pointer to copy.
+         */
+        template <bool bOther> inline void copyInternalPointers(const GcPtr<Type, bOther>& pOther) {
+            setAllocationFromOtherPointer(pOther);
+
+#if defined(DEBUG)
+            // Save pointer to the object for debugging.
+            pDebugPtr = pOther.pDebugPtr;
+#endif
+        }
+
+        /**
+         * Makes this GC pointer to point to the same object as the specified GC pointer of the same type
+         * and clears the specified GC pointer.
+         *
+         * @remark Moves the referenced allocation directly (no lookup in the garbage collector's
+         * "database"), this makes moving `GcPtr`s (for example when `GcVector` grows) cheap.
+         *
+         * @param pOther GC pointer to move.
+         */
+        template <bool bOther> inline void moveInternalPointers(GcPtr<Type, bOther>& pOther) {
+            moveAllocationFromOtherPointer(pOther);
+
+#if defined(DEBUG)
+            // Save pointer to the object for debugging.
+            pDebugPtr = pOther.pDebugPtr;
+            pOther.pDebugPtr = nullptr;
+#endif
+        }
+
 #if defined(DEBUG)
         /**
          * Object that this pointer is pointing to.
@@ -495,6 +700,16 @@ namespace sgc {
 #endif
     };
 
+    // Make sure fields of GC pointers fit into padding after the virtual table pointer.
+#if defined(SGC_COMPRESSED_REFERENCES)
+    static_assert(sizeof(GcPtrBase) == sizeof(void*) + 8, "unexpected size of GC pointers"); // NOLINT
+#else
+    static_assert(sizeof(GcPtrBase) == 2 * sizeof(void*) + 8, "unexpected size of GC pointers"); // NOLINT
+#endif
+#if !defined(DEBUG)
+    static_assert(sizeof(GcPtr<int>) == sizeof(GcPtrBase), "GC pointers should not add fields");
+#endif
+
     /**
      * Allocates a new object of the specified type, similar to how `std::make_shared` works.
      *
@@ -518,4 +733,73 @@ namespace sgc {
 
         return pGcPtr;
     }
+
+    /**
+     * Allocates a new object of the specified type in the specified garbage collector's heap.
+     *
+     * @remark Same as `makeGc` called inside of a @ref GcScope with the specified garbage collector,
+     * the returned pointer also belongs to the specified garbage collector.
+     *
+     * @param garbageCollector Garbage collector to allocate the object in.
+     * @param constructorArgs  Arguments that will be passed to the type's constructor.
+     *
+     * @return GC smart pointer to the allocated object.
+     */
+    template <typename Type, typename... ConstructorArgs>
+    inline GcPtr<Type> makeGcIn(GarbageCollector& garbageCollector, ConstructorArgs&&... constructorArgs) {
+        GcScope scope(garbageCollector);
+        return makeGc<Type>(std::forward<ConstructorArgs>(constructorArgs)...);
+    }
+
+    /**
+     * RAII-style object that keeps a GC object alive and prevents it from being moved by heap compaction
+     * (see `GarbageCollector::setCompactHeap`) so that raw pointers to it stay valid while the pin exists.
+     *
+     * Example:
+     * @code
+     * auto pBuffer = sgc::makeGc<Buffer>();
+     * {
+     *     sgc::GcPin<Buffer> pin(pBuffer);
+     *     writeAsync(pin->data()); // raw pointer stays valid even if garbage is collected
+     * }
+     * @endcode
+     */
+    template <typename Type> class GcPin {
+    public:
+        GcPin() = delete;
+
+        /**
+         * Pins the object referenced by the specified pointer.
+         *
+         * @param pObject Pointer to the object to pin (might be `nullptr`).
+         */
+        explicit GcPin(const GcPtr<Type>& pObject) : pPinned(pObject) { pPinned.setAllocationPinned(true); }
+
+        /** Unpins the object. */
+        ~GcPin() { pPinned.setAllocationPinned(false); }
+
+        GcPin(const GcPin&) = delete;
+        GcPin& operator=(const GcPin&) = delete;
+
+        GcPin(GcPin&&) noexcept = delete;
+        GcPin& operator=(GcPin&&) noexcept = delete;
+
+        /**
+         * Returns pinned object.
+         *
+         * @return Raw pointer to the object that is valid while this pin exists.
+         */
+        inline Type* get() const { return pPinned.get(); }
+
+        /**
+         * Accesses pinned object.
+         *
+         * @return Raw pointer to the object that is valid while this pin exists.
+         */
+        inline Type* operator->() const { return pPinned.get(); }
+
+    private:
+        /** Keeps the pinned object alive. */
+        GcPtr<Type> pPinned;
+    };
 }
@@ -0,0 +1,70 @@
+#pragma once
+
+// Custom.
+#include "GarbageCollector.h"
+
+namespace sgc {
+    /**
+     * RAII-style scope for short-lived object graphs (for example per-request scratch data): objects
+     * created by `makeGc` inside of the scope are allocated from bump-pointer memory and when the scope
+     * ends everything except escaped objects is deleted and the memory is released all at once.
+     *
+     * Objects escape when they are stored in GC pointers or GC containers of the garbage collector that
+     * was bound to the thread when the region was created (the parent garbage collector) or are referenced
+     * by GC pointers or GC containers that outlive the region. Escaped objects (and objects reachable from
+     * them) are moved to the parent garbage collector, only they are traced when the region ends.
+     *
+     * Example:
+     * @code
+     * sgc::GcPtr<Response> pResponse;
+     * {
+     *     sgc::GcRegion region;
+     *     auto pScratch = sgc::makeGc<ParseTree>(request); // allocated in the region
+     *     pResponse = pScratch->buildResponse();           // `Response` escapes
+     * } // `ParseTree` and all other temporary objects are deleted here
+     * @endcode
+     *
+     * @remark Region objects can reference objects of the parent garbage collector (the region acts like
+     * a thread-local garbage collector, see `GarbageCollector::getThreadLocal`).
+     *
+     * @warning Must be destroyed on the thread that created it (in reverse order of other @ref GcScope
+     * objects). Regions can't be nested and can't be created while a thread-local garbage collector is
+     * bound to the thread.
+     */
+    class GcRegion {
+    public:
+        /** Creates a region for the garbage collector bound to the current thread and binds the region. */
+        GcRegion();
+
+        /** Deletes objects that did not escape and restores previously bound garbage collector. */
+        ~GcRegion();
+
+        GcRegion(const GcRegion&) = delete;
+        GcRegion& operator=(const GcRegion&) = delete;
+
+        GcRegion(GcRegion&&) noexcept = delete;
+        GcRegion& operator=(GcRegion&&) noexcept = delete;
+
+        /**
+         * Returns garbage collector that manages objects of this region.
+         *
+         * @return Garbage collector of the region.
+         */
+        GarbageCollector& getGarbageCollector();
+
+    private:
+        /**
+         * Returns garbage collector bound to the current thread and makes sure a region can be created
+         * for it.
+         *
+         * @return Parent garbage collector for a new region.
+         */
+        static GarbageCollector& getParentGarbageCollector();
+
+        /** Manages objects allocated inside of the region. */
+        GarbageCollector garbageCollector;
+
+        /** Binds @ref garbageCollector to the current thread. */
+        GcScope scope;
+    };
+}
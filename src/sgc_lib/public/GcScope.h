@@ -0,0 +1,47 @@
+#pragma once
+
+namespace sgc {
+    class GarbageCollector;
+
+    /**
+     * RAII-style object that binds the specified garbage collector to the current thread so that
+     * `GarbageCollector::get()`, `makeGc` and newly constructed GC pointers and GC containers use this
+     * garbage collector (until the scope object is destroyed).
+     *
+     * Example:
+     * @code
+     * sgc::GarbageCollector subsystemGc;
+     * {
+     *     sgc::GcScope scope(subsystemGc);
+     *     auto pObject = sgc::makeGc<Foo>(); // allocated in `subsystemGc`
+     * }
+     * subsystemGc.collectGarbage(); // only collects objects of `subsystemGc`
+     * @endcode
+     *
+     * @remark Scopes can be nested, destroying a scope restores the previously bound garbage collector.
+     */
+    class GcScope {
+    public:
+        GcScope() = delete;
+
+        /**
+         * Binds the specified garbage collector to the current thread.
+         *
+         * @param garbageCollector Garbage collector to bind.
+         */
+        explicit GcScope(GarbageCollector& garbageCollector);
+
+        /** Restores garbage collector that was bound to the current thread before this scope. */
+        ~GcScope();
+
+        GcScope(const GcScope&) = delete;
+        GcScope& operator=(const GcScope&) = delete;
+
+        GcScope(GcScope&&) noexcept = delete;
+        GcScope& operator=(GcScope&&) noexcept = delete;
+
+    private:
+        /** Garbage collector that was bound to the current thread before this scope (might be `nullptr`). */
+        GarbageCollector* const pPreviousGarbageCollector = nullptr;
+    };
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+// Standard.
+#include <cstddef>
+#include <mutex>
+#include <utility>
+
+// Custom.
+#include "GcPtr.h"
+#include "GcAllocationRef.hpp"
+
+namespace sgc {
+    /**
+     * GC pointer that stores a small user-defined tag (flags) in low bits of the reference to the
+     * allocation (which are always zero since allocations are aligned) so that objects don't need
+     * a separate flags field next to their GC pointers:
+     * @code
+     * class TreeNode {
+     * public:
+     *     sgc::GcTaggedPtr<TreeNode, 1> pLeft; // tag stores node color
+     *     sgc::GcTaggedPtr<TreeNode, 1> pRight;
+     * };
+     *
+     * pNode->pLeft = pChild;
+     * pNode->pLeft.setTag(1);
+     * @endcode
+     *
+     * @remark Behaves like `GcPtr` (the garbage collector masks off the tag when it follows the pointer),
+     * the tag is independent of the referenced object: assigning a different object (or `nullptr`)
+     * keeps the tag, copying (or moving) a tagged pointer copies (or moves) the tag too.
+     *
+     * @remark Comparison operators compare referenced objects and ignore tags.
+     *
+     * @tparam Type         Type of the object that the pointer references.
+     * @tparam iTagBitCount Number of bits in the tag, up to 3 (up to 2 if `SGC_COMPRESSED_REFERENCES`
+     * is defined).
+     */
+    template <typename Type, size_t iTagBitCount> class GcTaggedPtr : public GcPtr<Type> {
+        static_assert(
+            iTagBitCount > 0 && iTagBitCount <= GcAllocationRef::iTagBitCount,
+            "the tag does not fit into low bits of references to allocations");
+
+    public:
+        /** Largest tag that can be stored. */
+        static constexpr size_t iMaxTag = (size_t(1) << iTagBitCount) - 1;
+
+        // Assigning a GC pointer, a raw pointer or `nullptr` keeps the tag.
+        using GcPtr<Type>::operator=;
+
+        virtual ~GcTaggedPtr() override = default;
+
+        /** Constructs an empty (`nullptr`) pointer with zero tag. */
+        GcTaggedPtr() = default;
+
+        /** Constructs an empty (`nullptr`) pointer with zero tag. */
+        GcTaggedPtr(std::nullptr_t) {}
+
+        /**
+         * Constructs a tagged pointer from a raw pointer.
+         *
+         * @warning If the pointer to the specified target object was not previously created using `makeGc`
+         * an error will be triggered.
+         *
+         * @param pTargetObject Object to point to.
+         * @param iTag          Tag to store.
+         */
+        GcTaggedPtr(Type* pTargetObject, size_t iTag = 0) : GcPtr<Type>(pTargetObject) {
+            if (iTag != 0) {
+                setTag(iTag);
+            }
+        }
+
+        /**
+         * Constructs a tagged pointer from a GC pointer.
+         *
+         * @param pOther GC pointer to copy.
+         * @param iTag   Tag to store.
+         */
+        GcTaggedPtr(const GcPtr<Type>& pOther, size_t iTag = 0) : GcPtr<Type>(pOther) {
+            if (iTag != 0) {
+                setTag(iTag);
+            }
+        }
+
+        /**
+         * Constructs a tagged pointer from a GC pointer.
+         *
+         * @param pOther GC pointer to move.
+         * @param iTag   Tag to store.
+         */
+        GcTaggedPtr(GcPtr<Type>&& pOther, size_t iTag = 0) : GcPtr<Type>(std::move(pOther)) {
+            if (iTag != 0) {
+                setTag(iTag);
+            }
+        }
+
+        /**
+         * Copy constructor.
+         *
+         * @param pOther Tagged pointer to copy (with its tag).
+         */
+        GcTaggedPtr(const GcTaggedPtr& pOther) : GcTaggedPtr(pOther, pOther.getTag()) {}
+
+        /**
+         * Move constructor.
+         *
+         * @param pOther Tagged pointer to move (with its tag), becomes empty with zero tag.
+         */
+        GcTaggedPtr(GcTaggedPtr&& pOther) noexcept : GcTaggedPtr(std::move(pOther), pOther.getTag()) {
+            pOther.setTag(0);
+        }
+
+        /**
+         * Copy assignment operator.
+         *
+         * @param pOther Tagged pointer to copy (with its tag).
+         *
+         * @return This.
+         */
+        GcTaggedPtr& operator=(const GcTaggedPtr& pOther) {
+            GcPtr<Type>::operator=(pOther);
+            setTag(pOther.getTag());
+
+            return *this;
+        }
+
+        /**
+         * Move assignment operator.
+         *
+         * @param pOther Tagged pointer to move (with its tag), becomes empty with zero tag.
+         *
+         * @return This.
+         */
+        GcTaggedPtr& operator=(GcTaggedPtr&& pOther) noexcept {
+            if (this == &pOther) {
+                return *this;
+            }
+
+            const auto iTag = pOther.getTag();
+            GcPtr<Type>::operator=(std::move(pOther));
+            pOther.setTag(0);
+            setTag(iTag);
+
+            return *this;
+        }
+
+        /**
+         * Returns the stored tag.
+         *
+         * @return Tag (0 if never set).
+         */
+        inline size_t getTag() const { return this->pAllocation.getTag(); }
+
+        /**
+         * Stores the specified tag.
+         *
+         * @remark Locks the garbage collector's mutex (like modifications of the referenced object do)
+         * since the garbage collector reads the reference that stores the tag.
+         *
+         * @param iTag Tag, only the lowest `iTagBitCount` bits are stored.
+         */
+        inline void setTag(size_t iTag) {
+            std::scoped_lock guard(*this->getGarbageCollector()->getGarbageCollectionMutex());
+
+            this->pAllocation.setTag(iTag & iMaxTag);
+        }
+    };
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+// Standard.
+#include <atomic>
+#include <cstddef>
+#include <functional>
+
+namespace sgc {
+    /**
+     * RAII-style object that registers the stack of the current thread for conservative scanning (until
+     * the object is destroyed).
+     *
+     * While the stack is registered GC pointers that are local variables on it are not added to the root
+     * set of their garbage collector (creating and destroying them does not touch the root set), instead
+     * the garbage collector finds them by scanning registered stacks when collecting garbage.
+     *
+     * Example:
+     * @code
+     * void threadMain() {
+     *     sgc::GcThreadStack threadStack;
+     *     auto pObject = sgc::makeGc<Foo>(); // not added to the root set
+     *     sgc::GarbageCollector::get().collectGarbage(); // `pObject` is found on the stack
+     * }
+     * @endcode
+     *
+     * @remark Only affects GC pointers of garbage collectors that are not thread-local (or region)
+     * garbage collectors, GC containers and GC pointers that are not on the stack (for example in heap
+     * memory of a `std::vector`) are registered as root nodes as usual.
+     *
+     * @remark Registrations can be nested, only the outermost one registers the stack.
+     *
+     * @remark Does nothing if the OS does not allow the process to read its own memory (GC pointers are
+     * registered as root nodes as usual then).
+     *
+     * @warning The registration must outlive GC pointers that were created on the stack while it existed
+     * (create it at the top of the thread's function). Stacks that are switched in user space (fibers or
+     * coroutines with their own stacks) are not supported.
+     */
+    class GcThreadStack {
+        // Scans registered stacks.
+        friend class GarbageCollector;
+
+        // Records GC pointers constructed on the registered stack.
+        friend class GcPtrBase;
+
+    public:
+        /** Registers the stack of the current thread (if not registered yet). */
+        GcThreadStack();
+
+        /** Unregisters the stack of the current thread if it was registered by this object. */
+        ~GcThreadStack();
+
+        GcThreadStack(const GcThreadStack&) = delete;
+        GcThreadStack& operator=(const GcThreadStack&) = delete;
+
+        GcThreadStack(GcThreadStack&&) noexcept = delete;
+        GcThreadStack& operator=(GcThreadStack&&) noexcept = delete;
+
+        /**
+         * Tells if the specified address belongs to the registered stack of the current thread.
+         *
+         * @param pAddress Address to check.
+         *
+         * @return `true` if the current thread's stack is registered and contains the address, `false`
+         * otherwise.
+         */
+        static bool isOnCurrentThreadStack(const void* pAddress);
+
+    private:
+        /**
+         * Tells if the specified address of a GC pointer being constructed belongs to the registered stack
+         * of the current thread and if so lowers @ref pScannedNodesLow of the stack.
+         *
+         * @param pAddress Address of a GC pointer being constructed.
+         *
+         * @return `true` if the GC pointer will be found by scanning the stack, `false` otherwise.
+         */
+        static bool tryRegisteringScannedNode(const void* pAddress);
+
+        /**
+         * Copies readable memory of all registered stacks that might contain GC pointers (from
+         * @ref pScannedNodesLow, for the current thread only the part used by its callers) and calls the
+         * specified callback for each copy.
+         *
+         * @remark Must be called while the garbage collector's mutex is locked (see the implementation
+         * for why this makes @ref pScannedNodesLow of other threads up to date).
+         *
+         * @remark Copies start at an address aligned to 16 bytes.
+         *
+         * @param onStack Callback that receives a copy of a stack and its size in bytes.
+         */
+        static void forEachRegisteredStack(const std::function<void(const std::byte*, size_t)>& onStack);
+
+        /** Lowest address of the registered stack. */
+        const std::byte* pStackLow = nullptr;
+
+        /** Address after the highest address of the registered stack. */
+        const std::byte* pStackHigh = nullptr;
+
+        /**
+         * Lowest address of a GC pointer that was constructed on the registered stack (@ref pStackHigh if
+         * none), only lowered (by the thread that owns the stack) so memory below it never contains GC
+         * pointers that need to be scanned.
+         */
+        std::atomic<const std::byte*> pScannedNodesLow{nullptr};
+
+        /** `true` if this object registered the stack, `false` if it's a nested registration. */
+        bool bRegistered = false;
+    };
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+// Standard.
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+// Custom.
+#include "GarbageCollector.h"
+
+namespace sgc {
+    class GcAllocation;
+
+    /**
+     * Allocator for standard containers (`std::vector`, `std::unordered_map`, `std::list` and so on) that
+     * store `GcPtr`s (or objects with `GcPtr` fields) so that these `GcPtr`s are found by scanning the
+     * container's memory instead of being root nodes.
+     *
+     * A container that is a field of a GC object should use an allocator created with the object (the
+     * container's items are then traced when the object is reachable, cycles through the container are
+     * collected):
+     * @code
+     * class Node {
+     * public:
+     *     using Allocator = sgc::GcTracingAllocator<sgc::GcPtr<Node>>;
+     *
+     *     std::vector<sgc::GcPtr<Node>, Allocator> vChildren{Allocator(this)};
+     * };
+     * @endcode
+     *
+     * @remark A default-constructed allocator is not owned by an object: `GcPtr`s in its memory are
+     * treated as root nodes (like `GcPtr`s in memory of `std::allocator`) but are not added to the
+     * root set. Memory of a container is only traced by garbage collectors that are not thread-local
+     * (or region) garbage collectors, otherwise the allocator works like `std::allocator`.
+     *
+     * @remark Containers with allocators of different owners never exchange their memory (assigning or
+     * swapping them copies or moves items) and a copy-constructed container uses a default-constructed
+     * allocator, specify an owned allocator in the copy constructor of your type if needed.
+     *
+     * @warning A container with an owned allocator must not outlive its owner object (for example when
+     * move-constructed into a local variable), its items are only traced while the owner is reachable.
+     *
+     * @tparam Type Type of items to allocate.
+     */
+    template <typename Type> class GcTracingAllocator {
+        // Allow allocators of other types to copy our state.
+        template <typename> friend class GcTracingAllocator;
+
+    public:
+        using value_type = Type;
+
+        using propagate_on_container_copy_assignment = std::false_type;
+        using propagate_on_container_move_assignment = std::false_type;
+        using propagate_on_container_swap = std::false_type;
+        using is_always_equal = std::false_type;
+
+        /** Creates an allocator which memory is treated as a root (not owned by an object). */
+        GcTracingAllocator() : pGarbageCollector(pickGarbageCollector()) {}
+
+        /**
+         * Creates an allocator which memory is traced when the specified GC object is reachable.
+         *
+         * @remark If the specified object was not created using `makeGc` (for example it's a local
+         * variable) memory of the allocator is treated as a root.
+         *
+         * @param pOwnerObject GC object (usually `this` in a constructor or a field initializer of the
+         * object) that owns the container that will use this allocator.
+         */
+        explicit GcTracingAllocator(const void* pOwnerObject) : pGarbageCollector(pickGarbageCollector()) {
+            if (pGarbageCollector != nullptr) {
+                pOwner = pGarbageCollector->findTracedMemoryOwner(pOwnerObject);
+            }
+        }
+
+        /**
+         * Creates an allocator that shares the state of an allocator of another type.
+         *
+         * @param other Allocator to copy.
+         */
+        template <typename OtherType>
+        GcTracingAllocator(const GcTracingAllocator<OtherType>& other) noexcept // NOLINT: used by containers
+            : pGarbageCollector(other.pGarbageCollector), pOwner(other.pOwner) {}
+
+        /**
+         * Allocates memory for the specified number of items.
+         *
+         * @param iCount Number of items.
+         *
+         * @return Allocated (zero-initialized) memory.
+         */
+        Type* allocate(size_t iCount) {
+            if (pGarbageCollector == nullptr) {
+                return static_cast<Type*>(
+                    ::operator new(iCount * sizeof(Type), std::align_val_t(alignof(Type))));
+            }
+
+            return static_cast<Type*>(
+                pGarbageCollector->allocateTracedMemory(iCount * sizeof(Type), alignof(Type), pOwner));
+        }
+
+        /**
+         * Frees memory returned by @ref allocate.
+         *
+         * @param pMemory Memory to free.
+         * @param iCount  Number of items that was specified in @ref allocate.
+         */
+        void deallocate(Type* pMemory, size_t iCount) noexcept {
+            if (pGarbageCollector == nullptr) {
+                ::operator delete(pMemory, iCount * sizeof(Type), std::align_val_t(alignof(Type)));
+                return;
+            }
+
+            pGarbageCollector->freeTracedMemory(pMemory, iCount * sizeof(Type), alignof(Type));
+        }
+
+        /**
+         * Returns allocator for a container that is copy-constructed from a container that uses this
+         * allocator.
+         *
+         * @return Allocator which memory is treated as a root.
+         */
+        GcTracingAllocator select_on_container_copy_construction() const { return GcTracingAllocator(); }
+
+        /**
+         * Tells if memory allocated by one allocator can be freed by another.
+         *
+         * @param other Allocator to compare with.
+         *
+         * @return `true` if allocators use the same garbage collector and have the same owner.
+         */
+        template <typename OtherType> bool operator==(const GcTracingAllocator<OtherType>& other) const {
+            return pGarbageCollector == other.pGarbageCollector && pOwner == other.pOwner;
+        }
+
+    private:
+        /**
+         * Returns garbage collector that will trace memory of a new allocator.
+         *
+         * @return `nullptr` if the garbage collector bound to the current thread does not trace memory of
+         * containers, otherwise garbage collector.
+         */
+        static GarbageCollector* pickGarbageCollector() {
+            auto& garbageCollector = GarbageCollector::get();
+            return garbageCollector.getSharedGarbageCollector() == nullptr ? &garbageCollector : nullptr;
+        }
+
+        /** Garbage collector that traces our memory (`nullptr` to work like `std::allocator`). */
+        GarbageCollector* pGarbageCollector = nullptr;
+
+        /** Allocation of the object that owns our memory (`nullptr` if our memory is a root). */
+        GcAllocation* pOwner = nullptr;
+    };
+}
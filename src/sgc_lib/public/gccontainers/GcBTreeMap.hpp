@@ -0,0 +1,1166 @@
+#pragma once
+
+// Standard.
+#include <array>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <type_traits>
+#include <concepts>
+
+// Custom.
+#include "GcContainerBase.h"
+#include "GarbageCollector.h"
+#include "GcPtr.h"
+
+namespace sgc {
+    /**
+     * Ordered map (a B+ tree with wide nodes) for storing `GcPtr<InnerType>` values.
+     *
+     * Each leaf stores up to `iNodeCapacity` keys and values in contiguous arrays and leaves are linked
+     * in key order, so range scans and marking (the garbage collector walks values leaf by leaf) touch
+     * much less memory than a tree that allocates a node per item (like `std::map`).
+     *
+     * @remark Iterators are forward iterators and are invalidated by any insertion or erasure.
+     *
+     * @tparam Key           Type of keys (keys are stored in node arrays so it should be cheap to default
+     * construct and move).
+     * @tparam OuterType     `GcPtr`.
+     * @tparam InnerType     Type that `GcPtr`s of this container will store.
+     * @tparam Compare       Function object to compare keys.
+     * @tparam iNodeCapacity Maximum number of keys in a node.
+     */
+    template <
+        typename Key,
+        typename OuterType,
+        typename InnerType = typename OuterType::element_type,
+        typename Compare = std::less<Key>,
+        size_t iNodeCapacity = 32> // NOLINT: a few cache lines of keys per node
+        requires(std::same_as<OuterType, GcPtr<InnerType, true>> ||   // only GcPtr values are supported
+                 std::same_as<OuterType, GcPtr<InnerType, false>>) && //
+                (!std::derived_from<InnerType, GcContainerBase>) &&   // inner containers not supported
+                (!std::derived_from<Key, GcNode>) &&                  // GC pointers as keys not supported
+                std::default_initializable<Key> && std::copyable<Key> && (iNodeCapacity >= 4)
+    class GcBTreeMap : public GcContainerBase {
+        /** Base part of tree nodes. */
+        struct Node {
+            /**
+             * Creates an empty node.
+             *
+             * @param bIsLeaf `true` if this is a leaf node, `false` if inner node.
+             */
+            explicit Node(bool bIsLeaf) : bIsLeaf(bIsLeaf) {}
+
+            /** Number of used keys. */
+            size_t iCount = 0;
+
+            /** `true` if this is @ref LeafNode, `false` if @ref InnerNode. */
+            const bool bIsLeaf = false;
+        };
+
+        /** Node that stores keys with their values. */
+        struct LeafNode : Node {
+            LeafNode() : Node(true) {}
+
+            /** Sorted keys, only first @ref iCount are used. */
+            std::array<Key, iNodeCapacity> vKeys;
+
+            /** Values of @ref vKeys, only first @ref iCount are used. */
+            std::array<GcPtr<InnerType, false>, iNodeCapacity> vValues;
+
+            /** Next leaf in key order (`nullptr` if this is the last leaf). */
+            LeafNode* pNext = nullptr;
+        };
+
+        /** Node that routes lookups to child nodes. */
+        struct InnerNode : Node {
+            InnerNode() : Node(false) {}
+
+            /**
+             * Sorted separator keys, only first @ref iCount are used: keys of child `i` are less than
+             * `vKeys[i]` and keys of child `i + 1` are not less than `vKeys[i]`.
+             */
+            std::array<Key, iNodeCapacity> vKeys;
+
+            /** Child nodes, only first `iCount + 1` are used. */
+            std::array<Node*, iNodeCapacity + 1> vChildren{};
+        };
+
+        /** Minimum number of keys in a node (except for the root node). */
+        static constexpr size_t iMinNodeCount = (iNodeCapacity - 1) / 2;
+
+    public:
+        /** Type of the values that we store. */
+        using map_value_t = sgc::GcPtr<InnerType, false>;
+
+        /**
+         * Forward iterator over items in key order.
+         *
+         * @tparam bIsConst `true` if values can't be modified through the iterator.
+         */
+        template <bool bIsConst> class IteratorBase {
+            // Map creates iterators.
+            friend class GcBTreeMap;
+
+            // Const iterators are created from mutable ones.
+            template <bool> friend class IteratorBase;
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using difference_type = std::ptrdiff_t;
+            using value_type = std::pair<const Key, map_value_t>;
+            using reference =
+                std::pair<const Key&, std::conditional_t<bIsConst, const map_value_t&, map_value_t&>>;
+
+            IteratorBase() = default;
+
+            /**
+             * Converts a mutable iterator to a const one.
+             *
+             * @param other Iterator to convert.
+             */
+            template <bool bIsOtherConst>
+                requires(bIsConst && !bIsOtherConst)
+            IteratorBase(const IteratorBase<bIsOtherConst>& other)
+                : pLeaf(other.pLeaf), iIndex(other.iIndex) {}
+
+            /**
+             * Returns the key and the value of the item.
+             *
+             * @return Pair of references.
+             */
+            reference operator*() const { return reference(pLeaf->vKeys[iIndex], pLeaf->vValues[iIndex]); }
+
+            /**
+             * Returns the key of the item.
+             *
+             * @return Key.
+             */
+            const Key& key() const { return pLeaf->vKeys[iIndex]; }
+
+            /**
+             * Returns the value of the item.
+             *
+             * @return Value.
+             */
+            std::conditional_t<bIsConst, const map_value_t&, map_value_t&> value() const {
+                return pLeaf->vValues[iIndex];
+            }
+
+            /**
+             * Moves to the next item.
+             *
+             * @return This.
+             */
+            IteratorBase& operator++() {
+                iIndex += 1;
+                if (iIndex == pLeaf->iCount) {
+                    pLeaf = pLeaf->pNext;
+                    iIndex = 0;
+                }
+                return *this;
+            }
+
+            /**
+             * Moves to the next item.
+             *
+             * @return Iterator before the move.
+             */
+            IteratorBase operator++(int) {
+                auto previous = *this;
+                ++(*this);
+                return previous;
+            }
+
+            /**
+             * Compares iterators.
+             *
+             * @param other Iterator to compare with.
+             *
+             * @return `true` if both point to the same item.
+             */
+            bool operator==(const IteratorBase& other) const = default;
+
+        private:
+            /**
+             * Creates an iterator to an item.
+             *
+             * @param pLeaf  Leaf of the item (`nullptr` for end iterator).
+             * @param iIndex Index of the item in the leaf.
+             */
+            IteratorBase(LeafNode* pLeaf, size_t iIndex) : pLeaf(pLeaf), iIndex(iIndex) {}
+
+            /** Leaf of the item (`nullptr` for end iterator). */
+            LeafNode* pLeaf = nullptr;
+
+            /** Index of the item in the leaf. */
+            size_t iIndex = 0;
+        };
+
+        /** Iterator that allows modifying values. */
+        using iterator = IteratorBase<false>;
+
+        /** Iterator that does not allow modifying values. */
+        using const_iterator = IteratorBase<true>;
+
+        virtual ~GcBTreeMap() override {
+            notifyGarbageCollectorAboutDestruction();
+
+            destroyNode(pRoot);
+        }
+
+        /** Creates an empty container. */
+        GcBTreeMap() : GcContainerBase(iterateOverGcPtrItems) {}
+
+        /**
+         * Copy constructor.
+         *
+         * @param other Container to copy.
+         */
+        GcBTreeMap(const GcBTreeMap& other) : GcContainerBase(iterateOverGcPtrItems) {
+            // Make sure the GC is not currently iterating over this container since we modify the container.
+            ModificationGuard guard(this);
+
+            copyFrom(other);
+        }
+
+        /**
+         * Move constructor.
+         *
+         * @param other Container to move.
+         */
+        GcBTreeMap(GcBTreeMap&& other) noexcept : GcContainerBase(iterateOverGcPtrItems) {
+            // Make sure the GC is not currently iterating over this container since we modify the container.
+            ModificationGuard guard(this);
+
+            moveFrom(other);
+        }
+
+        /**
+         * Copy assignment operator.
+         *
+         * @param other Container to copy.
+         *
+         * @return This.
+         */
+        GcBTreeMap& operator=(const GcBTreeMap& other) {
+            if (this == &other) {
+                return *this;
+            }
+
+            // Make sure the GC is not currently iterating over this container since we modify the container.
+            ModificationGuard guard(this);
+
+            destroyTree();
+            copyFrom(other);
+
+            return *this;
+        }
+
+        /**
+         * Move assignment operator.
+         *
+         * @param other Container to move.
+         *
+         * @return This.
+         */
+        GcBTreeMap& operator=(GcBTreeMap&& other) noexcept {
+            if (this == &other) {
+                return *this;
+            }
+
+            // Make sure the GC is not currently iterating over this container since we modify the container.
+            ModificationGuard guard(this);
+
+            destroyTree();
+            moveFrom(other);
+
+            return *this;
+        }
+
+        /**
+         * Returns an iterator to the item with the smallest key.
+         *
+         * @return Iterator (equal to @ref end if the container is empty).
+         */
+        iterator begin() noexcept { return iterator(getFirstLeaf(), 0); }
+
+        /**
+         * Returns an iterator that follows the last item.
+         *
+         * @return Iterator.
+         */
+        iterator end() noexcept { return iterator(); }
+
+        /**
+         * Returns an iterator to the item with the smallest key.
+         *
+         * @return Iterator (equal to @ref end if the container is empty).
+         */
+        const_iterator begin() const noexcept { return const_iterator(getFirstLeaf(), 0); }
+
+        /**
+         * Returns an iterator that follows the last item.
+         *
+         * @return Iterator.
+         */
+        const_iterator end() const noexcept { return const_iterator(); }
+
+        /**
+         * Returns an iterator to the item with the smallest key.
+         *
+         * @return Iterator (equal to @ref cend if the container is empty).
+         */
+        const_iterator cbegin() const noexcept { return begin(); }
+
+        /**
+         * Returns an iterator that follows the last item.
+         *
+         * @return Iterator.
+         */
+        const_iterator cend() const noexcept { return end(); }
+
+        /**
+         * Checks whether the container is empty.
+         *
+         * @return `true` if empty, `false` otherwise.
+         */
+        bool empty() const noexcept { return iSize == 0; }
+
+        /**
+         * Returns the number of items in the container.
+         *
+         * @return Size.
+         */
+        size_t size() const noexcept { return iSize; }
+
+        /**
+         * Returns an iterator to the item with the specified key.
+         *
+         * @param key Key to look for.
+         *
+         * @return Iterator to the item or @ref end if not found.
+         */
+        iterator find(const Key& key) {
+            const auto [pLeaf, iIndex] = findItem(key);
+            return iterator(pLeaf, iIndex);
+        }
+
+        /**
+         * Returns an iterator to the item with the specified key.
+         *
+         * @param key Key to look for.
+         *
+         * @return Iterator to the item or @ref end if not found.
+         */
+        const_iterator find(const Key& key) const {
+            const auto [pLeaf, iIndex] = findItem(key);
+            return const_iterator(pLeaf, iIndex);
+        }
+
+        /**
+         * Checks if the container has an item with the specified key.
+         *
+         * @param key Key to look for.
+         *
+         * @return `true` if found, `false` otherwise.
+         */
+        bool contains(const Key& key) const { return findItem(key).first != nullptr; }
+
+        /**
+         * Returns the number of items with the specified key.
+         *
+         * @param key Key to look for.
+         *
+         * @return 0 or 1.
+         */
+        size_t count(const Key& key) const { return contains(key) ? 1 : 0; }
+
+        /**
+         * Returns an iterator to the first item which key is not less than the specified key.
+         *
+         * @param key Key to compare with.
+         *
+         * @return Iterator (@ref end if all keys are less).
+         */
+        iterator lower_bound(const Key& key) { // NOLINT: use name style as STL
+            const auto [pLeaf, iIndex] = findBound(key, false);
+            return iterator(pLeaf, iIndex);
+        }
+
+        /**
+         * Returns an iterator to the first item which key is not less than the specified key.
+         *
+         * @param key Key to compare with.
+         *
+         * @return Iterator (@ref end if all keys are less).
+         */
+        const_iterator lower_bound(const Key& key) const { // NOLINT: use name style as STL
+            const auto [pLeaf, iIndex] = findBound(key, false);
+            return const_iterator(pLeaf, iIndex);
+        }
+
+        /**
+         * Returns an iterator to the first item which key is greater than the specified key.
+         *
+         * @param key Key to compare with.
+         *
+         * @return Iterator (@ref end if no key is greater).
+         */
+        iterator upper_bound(const Key& key) { // NOLINT: use name style as STL
+            const auto [pLeaf, iIndex] = findBound(key, true);
+            return iterator(pLeaf, iIndex);
+        }
+
+        /**
+         * Returns an iterator to the first item which key is greater than the specified key.
+         *
+         * @param key Key to compare with.
+         *
+         * @return Iterator (@ref end if no key is greater).
+         */
+        const_iterator upper_bound(const Key& key) const { // NOLINT: use name style as STL
+            const auto [pLeaf, iIndex] = findBound(key, true);
+            return const_iterator(pLeaf, iIndex);
+        }
+
+        /**
+         * Returns a reference to the value of the item with the specified key, with bounds checking.
+         *
+         * @param key Key of the item.
+         *
+         * @return Value.
+         */
+        map_value_t& at(const Key& key) {
+            const auto [pLeaf, iIndex] = findItem(key);
+            if (pLeaf == nullptr) {
+                throw std::out_of_range("the specified key was not found");
+            }
+
+            return pLeaf->vValues[iIndex];
+        }
+
+        /**
+         * Returns a reference to the value of the item with the specified key, inserts an empty value if
+         * the key was not found.
+         *
+         * @param key Key of the item.
+         *
+         * @return Value.
+         */
+        map_value_t& operator[](const Key& key) {
+            // Make sure the GC is not currently iterating over this container since we modify the container.
+            ModificationGuard guard(this);
+
+            return insertKey(key).first.value();
+        }
+
+        /**
+         * Inserts an item if the container does not have an item with the specified key.
+         *
+         * @param key   Key of the item.
+         * @param value Value of the item.
+         *
+         * @return Iterator to the item with the key and `true` if inserted, `false` if already existed.
+         */
+        std::pair<iterator, bool> insert(const Key& key, const map_value_t& value) {
+            // Make sure the GC is not currently iterating over this container since we modify the container.
+            ModificationGuard guard(this);
+
+            auto result = insertKey(key);
+            if (result.second) {
+                result.first.value() = value;
+            }
+
+            return result;
+        }
+
+        /**
+         * Inserts an item or assigns the value of the existing item with the specified key.
+         *
+         * @param key   Key of the item.
+         * @param value Value of the item.
+         *
+         * @return Iterator to the item with the key and `true` if inserted, `false` if assigned.
+         */
+        std::pair<iterator, bool> insert_or_assign(const Key& key, const map_value_t& value) { // NOLINT
+            // Make sure the GC is not currently iterating over this container since we modify the container.
+            ModificationGuard guard(this);
+
+            auto result = insertKey(key);
+            result.first.value() = value;
+
+            return result;
+        }
+
+        /**
+         * Removes the item with the specified key.
+         *
+         * @param key Key of the item.
+         *
+         * @return Number of removed items (0 or 1).
+         */
+        size_t erase(const Key& key) {
+            // Make sure the GC is not currently iterating over this container since we modify the container.
+            ModificationGuard guard(this);
+
+            if (pRoot == nullptr || !eraseFromNode(pRoot, key)) {
+                return 0;
+            }
+            iSize -= 1;
+
+            // Shrink the tree if the root became empty.
+            if (pRoot->iCount == 0) {
+                const auto pOldRoot = pRoot;
+                pRoot = pOldRoot->bIsLeaf ? nullptr : static_cast<InnerNode*>(pOldRoot)->vChildren[0];
+                deleteNode(pOldRoot);
+            }
+
+            return 1;
+        }
+
+        /**
+         * Removes the specified item.
+         *
+         * @param pos Iterator to the item to remove.
+         *
+         * @return Iterator following the removed item.
+         */
+        iterator erase(const_iterator pos) {
+            // Make sure the GC is not currently iterating over this container since we modify the container.
+            ModificationGuard guard(this);
+
+            // Remember the key of the next item since erasure invalidates iterators.
+            auto next = std::next(pos);
+            if (next == cend()) {
+                erase(Key(pos.key()));
+                return end();
+            }
+            const auto nextKey = next.key();
+
+            erase(Key(pos.key()));
+
+            return find(nextKey);
+        }
+
+        /** Removes all items from the container. */
+        void clear() {
+            // Make sure the GC is not currently iterating over this container since we modify the container.
+            ModificationGuard guard(this);
+
+            destroyTree();
+        }
+
+    private:
+        /**
+         * Iterates over values in all leaves.
+         *
+         * @param pContainer  This.
+         * @param onGcPtrItem Called on every GcPtr item in the container.
+         */
+        static inline void iterateOverGcPtrItems(
+            const GcContainerBase* pContainer, const std::function<void(const GcPtrBase*)>& onGcPtrItem) {
+            // Get this.
+            const auto pThis = reinterpret_cast<const GcBTreeMap*>(pContainer);
+
+            // Walk leaves in order, values of each leaf are stored contiguously.
+            for (auto pLeaf = pThis->getFirstLeaf(); pLeaf != nullptr; pLeaf = pLeaf->pNext) {
+                for (size_t i = 0; i < pLeaf->iCount; i++) {
+                    onGcPtrItem(&pLeaf->vValues[i]);
+                }
+            }
+        }
+
+        /**
+         * Deletes the specified node (but not its children).
+         *
+         * @param pNode Node to delete (can be `nullptr`).
+         */
+        static void deleteNode(Node* pNode) {
+            if (pNode == nullptr) {
+                return;
+            }
+
+            if (pNode->bIsLeaf) {
+                delete static_cast<LeafNode*>(pNode);
+            } else {
+                delete static_cast<InnerNode*>(pNode);
+            }
+        }
+
+        /**
+         * Deletes the specified node and all its children.
+         *
+         * @param pNode Node to delete (can be `nullptr`).
+         */
+        static void destroyNode(Node* pNode) {
+            if (pNode != nullptr && !pNode->bIsLeaf) {
+                const auto pInner = static_cast<InnerNode*>(pNode);
+                for (size_t i = 0; i <= pInner->iCount; i++) {
+                    destroyNode(pInner->vChildren[i]);
+                }
+            }
+
+            deleteNode(pNode);
+        }
+
+        /**
+         * Creates a copy of the specified node and all its children.
+         *
+         * @param pNode         Node to copy.
+         * @param pPreviousLeaf Last copied leaf (to link leaves), updated to the last leaf of the copy.
+         *
+         * @return Copy.
+         */
+        static Node* cloneNode(const Node* pNode, LeafNode*& pPreviousLeaf) {
+            if (pNode->bIsLeaf) {
+                const auto pLeaf = static_cast<const LeafNode*>(pNode);
+                const auto pNewLeaf = new LeafNode();
+                std::copy_n(pLeaf->vKeys.begin(), pLeaf->iCount, pNewLeaf->vKeys.begin());
+                std::copy_n(pLeaf->vValues.begin(), pLeaf->iCount, pNewLeaf->vValues.begin());
+                pNewLeaf->iCount = pLeaf->iCount;
+
+                if (pPreviousLeaf != nullptr) {
+                    pPreviousLeaf->pNext = pNewLeaf;
+                }
+                pPreviousLeaf = pNewLeaf;
+
+                return pNewLeaf;
+            }
+
+            const auto pInner = static_cast<const InnerNode*>(pNode);
+            const auto pNewInner = new InnerNode();
+            std::copy_n(pInner->vKeys.begin(), pInner->iCount, pNewInner->vKeys.begin());
+            for (size_t i = 0; i <= pInner->iCount; i++) {
+                pNewInner->vChildren[i] = cloneNode(pInner->vChildren[i], pPreviousLeaf);
+            }
+            pNewInner->iCount = pInner->iCount;
+
+            return pNewInner;
+        }
+
+        /**
+         * Resets the specified key slot so that it does not hold resources.
+         *
+         * @param key Key slot.
+         */
+        static void resetKey(Key& key) { key = Key(); }
+
+        /**
+         * Resets the specified item slot of a leaf so that it does not reference anything.
+         *
+         * @param pLeaf  Leaf.
+         * @param iIndex Index of the slot.
+         */
+        static void resetLeafSlot(LeafNode* pLeaf, size_t iIndex) {
+            resetKey(pLeaf->vKeys[iIndex]);
+            pLeaf->vValues[iIndex] = nullptr;
+        }
+
+        /**
+         * Deletes all nodes.
+         *
+         * @remark Expects that the caller holds @ref ModificationGuard.
+         */
+        void destroyTree() {
+            destroyNode(pRoot);
+            pRoot = nullptr;
+            iSize = 0;
+        }
+
+        /**
+         * Copies items of the specified container (this container must be empty).
+         *
+         * @remark Expects that the caller holds @ref ModificationGuard.
+         *
+         * @param other Container to copy.
+         */
+        void copyFrom(const GcBTreeMap& other) {
+            if (other.pRoot != nullptr) {
+                LeafNode* pPreviousLeaf = nullptr;
+                pRoot = cloneNode(other.pRoot, pPreviousLeaf);
+            }
+            iSize = other.iSize;
+        }
+
+        /**
+         * Takes items of the specified container (this container must be empty).
+         *
+         * @remark Expects that the caller holds @ref ModificationGuard.
+         *
+         * @param other Container to move.
+         */
+        void moveFrom(GcBTreeMap& other) {
+            // Make sure the GC is not iterating over the other container.
+            ModificationGuard otherGuard(&other);
+
+            pRoot = std::exchange(other.pRoot, nullptr);
+            iSize = std::exchange(other.iSize, 0);
+        }
+
+        /**
+         * Returns the leaf with the smallest keys.
+         *
+         * @return `nullptr` if the container is empty.
+         */
+        LeafNode* getFirstLeaf() const {
+            auto pNode = pRoot;
+            if (pNode == nullptr) {
+                return nullptr;
+            }
+
+            while (!pNode->bIsLeaf) {
+                pNode = static_cast<InnerNode*>(pNode)->vChildren[0];
+            }
+
+            return static_cast<LeafNode*>(pNode);
+        }
+
+        /**
+         * Returns index of the child that may contain the specified key.
+         *
+         * @param pInner Inner node.
+         * @param key    Key to look for.
+         *
+         * @return Child index.
+         */
+        size_t findChildIndex(const InnerNode* pInner, const Key& key) const {
+            const auto keysBegin = pInner->vKeys.begin();
+            return static_cast<size_t>(
+                std::upper_bound(keysBegin, keysBegin + pInner->iCount, key, compare) - keysBegin);
+        }
+
+        /**
+         * Returns index of the first key in the leaf that is not less than the specified key.
+         *
+         * @param pLeaf Leaf node.
+         * @param key   Key to compare with.
+         *
+         * @return Index (equal to the number of keys if all keys are less).
+         */
+        size_t findKeyIndex(const LeafNode* pLeaf, const Key& key) const {
+            const auto keysBegin = pLeaf->vKeys.begin();
+            return static_cast<size_t>(
+                std::lower_bound(keysBegin, keysBegin + pLeaf->iCount, key, compare) - keysBegin);
+        }
+
+        /**
+         * Returns the leaf that contains the specified key (if the key exists).
+         *
+         * @param key Key to look for.
+         *
+         * @return `nullptr` if the container is empty.
+         */
+        LeafNode* findLeaf(const Key& key) const {
+            auto pNode = pRoot;
+            if (pNode == nullptr) {
+                return nullptr;
+            }
+
+            while (!pNode->bIsLeaf) {
+                const auto pInner = static_cast<InnerNode*>(pNode);
+                pNode = pInner->vChildren[findChildIndex(pInner, key)];
+            }
+
+            return static_cast<LeafNode*>(pNode);
+        }
+
+        /**
+         * Looks for the item with the specified key.
+         *
+         * @param key Key to look for.
+         *
+         * @return Leaf and index of the item (`nullptr` leaf if not found).
+         */
+        std::pair<LeafNode*, size_t> findItem(const Key& key) const {
+            const auto pLeaf = findLeaf(key);
+            if (pLeaf == nullptr) {
+                return {nullptr, 0};
+            }
+
+            const auto iIndex = findKeyIndex(pLeaf, key);
+            if (iIndex == pLeaf->iCount || compare(key, pLeaf->vKeys[iIndex])) {
+                return {nullptr, 0};
+            }
+
+            return {pLeaf, iIndex};
+        }
+
+        /**
+         * Looks for the first item which key is not less (or greater) than the specified key.
+         *
+         * @param key           Key to compare with.
+         * @param bIsUpperBound `true` to look for a greater key, `false` to look for a key that is not less.
+         *
+         * @return Leaf and index of the item (`nullptr` leaf if not found).
+         */
+        std::pair<LeafNode*, size_t> findBound(const Key& key, bool bIsUpperBound) const {
+            const auto pLeaf = findLeaf(key);
+            if (pLeaf == nullptr) {
+                return {nullptr, 0};
+            }
+
+            const auto keysBegin = pLeaf->vKeys.begin();
+            const auto keysEnd = keysBegin + pLeaf->iCount;
+            const auto iIndex = static_cast<size_t>(
+                (bIsUpperBound ? std::upper_bound(keysBegin, keysEnd, key, compare)
+                               : std::lower_bound(keysBegin, keysEnd, key, compare)) -
+                keysBegin);
+
+            // Keys of the next leaf are not less than the separator that routed us to this leaf.
+            if (iIndex == pLeaf->iCount) {
+                return {pLeaf->pNext, 0};
+            }
+
+            return {pLeaf, iIndex};
+        }
+
+        /**
+         * Splits the specified full child node in two.
+         *
+         * @param pParent Parent node (not full).
+         * @param iChild  Index of the child to split.
+         */
+        void splitChild(InnerNode* pParent, size_t iChild) {
+            const auto pChild = pParent->vChildren[iChild];
+
+            Key separator;
+            Node* pNewChild = nullptr;
+            if (pChild->bIsLeaf) {
+                // Move the right half of items to a new leaf.
+                const auto pLeaf = static_cast<LeafNode*>(pChild);
+                const auto pNewLeaf = new LeafNode();
+                const auto iLeftCount = iNodeCapacity / 2;
+                for (size_t i = iLeftCount; i < iNodeCapacity; i++) {
+                    pNewLeaf->vKeys[i - iLeftCount] = std::move(pLeaf->vKeys[i]);
+                    pNewLeaf->vValues[i - iLeftCount] = std::move(pLeaf->vValues[i]);
+                    resetLeafSlot(pLeaf, i);
+                }
+                pNewLeaf->iCount = iNodeCapacity - iLeftCount;
+                pLeaf->iCount = iLeftCount;
+
+                pNewLeaf->pNext = pLeaf->pNext;
+                pLeaf->pNext = pNewLeaf;
+
+                separator = pNewLeaf->vKeys[0];
+                pNewChild = pNewLeaf;
+            } else {
+                // Move keys and children to the right of the middle key to a new node.
+                const auto pInner = static_cast<InnerNode*>(pChild);
+                const auto pNewInner = new InnerNode();
+                const auto iMiddle = iNodeCapacity / 2;
+                for (size_t i = iMiddle + 1; i < iNodeCapacity; i++) {
+                    pNewInner->vKeys[i - iMiddle - 1] = std::move(pInner->vKeys[i]);
+                    resetKey(pInner->vKeys[i]);
+                }
+                for (size_t i = iMiddle + 1; i <= iNodeCapacity; i++) {
+                    pNewInner->vChildren[i - iMiddle - 1] = std::exchange(pInner->vChildren[i], nullptr);
+                }
+                pNewInner->iCount = iNodeCapacity - iMiddle - 1;
+                pInner->iCount = iMiddle;
+
+                // The middle key goes up to the parent.
+                separator = std::move(pInner->vKeys[iMiddle]);
+                resetKey(pInner->vKeys[iMiddle]);
+                pNewChild = pNewInner;
+            }
+
+            // Insert the separator and the new child into the parent.
+            const auto keysBegin = pParent->vKeys.begin();
+            std::move_backward(
+                keysBegin + iChild, keysBegin + pParent->iCount, keysBegin + pParent->iCount + 1);
+            const auto childrenBegin = pParent->vChildren.begin();
+            std::move_backward(
+                childrenBegin + iChild + 1,
+                childrenBegin + pParent->iCount + 1,
+                childrenBegin + pParent->iCount + 2);
+            pParent->vKeys[iChild] = std::move(separator);
+            pParent->vChildren[iChild + 1] = pNewChild;
+            pParent->iCount += 1;
+        }
+
+        /**
+         * Looks for the item with the specified key and adds an item with an empty value if not found.
+         *
+         * @remark Expects that the caller holds @ref ModificationGuard.
+         *
+         * @param key Key of the item.
+         *
+         * @return Iterator to the item and `true` if the item was added, `false` if it existed.
+         */
+        std::pair<iterator, bool> insertKey(const Key& key) {
+            if (pRoot == nullptr) {
+                pRoot = new LeafNode();
+            }
+
+            // Grow the tree if the root is full (full nodes are split on the way down).
+            if (pRoot->iCount == iNodeCapacity) {
+                const auto pNewRoot = new InnerNode();
+                pNewRoot->vChildren[0] = pRoot;
+                pRoot = pNewRoot;
+                splitChild(pNewRoot, 0);
+            }
+
+            // Find the leaf.
+            auto pNode = pRoot;
+            while (!pNode->bIsLeaf) {
+                const auto pInner = static_cast<InnerNode*>(pNode);
+                auto iChild = findChildIndex(pInner, key);
+                if (pInner->vChildren[iChild]->iCount == iNodeCapacity) {
+                    splitChild(pInner, iChild);
+                    if (!compare(key, pInner->vKeys[iChild])) {
+                        iChild += 1;
+                    }
+                }
+                pNode = pInner->vChildren[iChild];
+            }
+            const auto pLeaf = static_cast<LeafNode*>(pNode);
+
+            // See if the key already exists.
+            const auto iIndex = findKeyIndex(pLeaf, key);
+            if (iIndex < pLeaf->iCount && !compare(key, pLeaf->vKeys[iIndex])) {
+                return {iterator(pLeaf, iIndex), false};
+            }
+
+            // Make room for the new item.
+            const auto keysBegin = pLeaf->vKeys.begin();
+            std::move_backward(keysBegin + iIndex, keysBegin + pLeaf->iCount, keysBegin + pLeaf->iCount + 1);
+            const auto valuesBegin = pLeaf->vValues.begin();
+            std::move_backward(
+                valuesBegin + iIndex, valuesBegin + pLeaf->iCount, valuesBegin + pLeaf->iCount + 1);
+
+            pLeaf->vKeys[iIndex] = key;
+            pLeaf->vValues[iIndex] = nullptr;
+            pLeaf->iCount += 1;
+            iSize += 1;
+
+            return {iterator(pLeaf, iIndex), true};
+        }
+
+        /**
+         * Removes the item with the specified key from the subtree, child nodes that have too few keys
+         * after the removal are refilled from their siblings.
+         *
+         * @param pNode Root of the subtree.
+         * @param key   Key of the item.
+         *
+         * @return `true` if the item was removed, `false` if not found.
+         */
+        bool eraseFromNode(Node* pNode, const Key& key) {
+            if (pNode->bIsLeaf) {
+                const auto pLeaf = static_cast<LeafNode*>(pNode);
+                const auto iIndex = findKeyIndex(pLeaf, key);
+                if (iIndex == pLeaf->iCount || compare(key, pLeaf->vKeys[iIndex])) {
+                    return false;
+                }
+
+                std::move(pLeaf->vKeys.begin() + iIndex + 1, pLeaf->vKeys.begin() + pLeaf->iCount,
+                          pLeaf->vKeys.begin() + iIndex);
+                std::move(pLeaf->vValues.begin() + iIndex + 1, pLeaf->vValues.begin() + pLeaf->iCount,
+                          pLeaf->vValues.begin() + iIndex);
+                pLeaf->iCount -= 1;
+                resetLeafSlot(pLeaf, pLeaf->iCount);
+
+                return true;
+            }
+
+            const auto pInner = static_cast<InnerNode*>(pNode);
+            const auto iChild = findChildIndex(pInner, key);
+            if (!eraseFromNode(pInner->vChildren[iChild], key)) {
+                return false;
+            }
+
+            if (pInner->vChildren[iChild]->iCount < iMinNodeCount) {
+                refillChild(pInner, iChild);
+            }
+
+            return true;
+        }
+
+        /**
+         * Moves keys from a sibling into a child that has too few keys or merges it with a sibling.
+         *
+         * @param pParent Parent node.
+         * @param iChild  Index of the child.
+         */
+        void refillChild(InnerNode* pParent, size_t iChild) {
+            if (iChild > 0 && pParent->vChildren[iChild - 1]->iCount > iMinNodeCount) {
+                borrowFromLeftSibling(pParent, iChild);
+            } else if (iChild < pParent->iCount && pParent->vChildren[iChild + 1]->iCount > iMinNodeCount) {
+                borrowFromRightSibling(pParent, iChild);
+            } else if (iChild > 0) {
+                mergeChildren(pParent, iChild - 1);
+            } else {
+                mergeChildren(pParent, iChild);
+            }
+        }
+
+        /**
+         * Moves the last key of the left sibling to the specified child.
+         *
+         * @param pParent Parent node.
+         * @param iChild  Index of the child.
+         */
+        void borrowFromLeftSibling(InnerNode* pParent, size_t iChild) {
+            const auto pChild = pParent->vChildren[iChild];
+            const auto pSibling = pParent->vChildren[iChild - 1];
+
+            if (pChild->bIsLeaf) {
+                const auto pLeaf = static_cast<LeafNode*>(pChild);
+                const auto pSiblingLeaf = static_cast<LeafNode*>(pSibling);
+                const auto iLast = pSiblingLeaf->iCount - 1;
+
+                std::move_backward(
+                    pLeaf->vKeys.begin(), pLeaf->vKeys.begin() + pLeaf->iCount,
+                    pLeaf->vKeys.begin() + pLeaf->iCount + 1);
+                std::move_backward(
+                    pLeaf->vValues.begin(), pLeaf->vValues.begin() + pLeaf->iCount,
+                    pLeaf->vValues.begin() + pLeaf->iCount + 1);
+                pLeaf->vKeys[0] = std::move(pSiblingLeaf->vKeys[iLast]);
+                pLeaf->vValues[0] = std::move(pSiblingLeaf->vValues[iLast]);
+                resetLeafSlot(pSiblingLeaf, iLast);
+
+                pSiblingLeaf->iCount -= 1;
+                pLeaf->iCount += 1;
+                pParent->vKeys[iChild - 1] = pLeaf->vKeys[0];
+
+                return;
+            }
+
+            const auto pInner = static_cast<InnerNode*>(pChild);
+            const auto pSiblingInner = static_cast<InnerNode*>(pSibling);
+            const auto iLast = pSiblingInner->iCount - 1;
+
+            // Rotate through the parent: separator goes down, the last key of the sibling goes up.
+            std::move_backward(
+                pInner->vKeys.begin(), pInner->vKeys.begin() + pInner->iCount,
+                pInner->vKeys.begin() + pInner->iCount + 1);
+            std::move_backward(
+                pInner->vChildren.begin(), pInner->vChildren.begin() + pInner->iCount + 1,
+                pInner->vChildren.begin() + pInner->iCount + 2);
+            pInner->vKeys[0] = std::move(pParent->vKeys[iChild - 1]);
+            pInner->vChildren[0] = std::exchange(pSiblingInner->vChildren[iLast + 1], nullptr);
+            pParent->vKeys[iChild - 1] = std::move(pSiblingInner->vKeys[iLast]);
+            resetKey(pSiblingInner->vKeys[iLast]);
+
+            pSiblingInner->iCount -= 1;
+            pInner->iCount += 1;
+        }
+
+        /**
+         * Moves the first key of the right sibling to the specified child.
+         *
+         * @param pParent Parent node.
+         * @param iChild  Index of the child.
+         */
+        void borrowFromRightSibling(InnerNode* pParent, size_t iChild) {
+            const auto pChild = pParent->vChildren[iChild];
+            const auto pSibling = pParent->vChildren[iChild + 1];
+
+            if (pChild->bIsLeaf) {
+                const auto pLeaf = static_cast<LeafNode*>(pChild);
+                const auto pSiblingLeaf = static_cast<LeafNode*>(pSibling);
+
+                pLeaf->vKeys[pLeaf->iCount] = std::move(pSiblingLeaf->vKeys[0]);
+                pLeaf->vValues[pLeaf->iCount] = std::move(pSiblingLeaf->vValues[0]);
+                pLeaf->iCount += 1;
+
+                std::move(
+                    pSiblingLeaf->vKeys.begin() + 1, pSiblingLeaf->vKeys.begin() + pSiblingLeaf->iCount,
+                    pSiblingLeaf->vKeys.begin());
+                std::move(
+                    pSiblingLeaf->vValues.begin() + 1, pSiblingLeaf->vValues.begin() + pSiblingLeaf->iCount,
+                    pSiblingLeaf->vValues.begin());
+                pSiblingLeaf->iCount -= 1;
+                resetLeafSlot(pSiblingLeaf, pSiblingLeaf->iCount);
+
+                pParent->vKeys[iChild] = pSiblingLeaf->vKeys[0];
+
+                return;
+            }
+
+            const auto pInner = static_cast<InnerNode*>(pChild);
+            const auto pSiblingInner = static_cast<InnerNode*>(pSibling);
+
+            // Rotate through the parent: separator goes down, the first key of the sibling goes up.
+            pInner->vKeys[pInner->iCount] = std::move(pParent->vKeys[iChild]);
+            pInner->vChildren[pInner->iCount + 1] = pSiblingInner->vChildren[0];
+            pInner->iCount += 1;
+            pParent->vKeys[iChild] = std::move(pSiblingInner->vKeys[0]);
+
+            std::move(
+                pSiblingInner->vKeys.begin() + 1, pSiblingInner->vKeys.begin() + pSiblingInner->iCount,
+                pSiblingInner->vKeys.begin());
+            std::move(
+                pSiblingInner->vChildren.begin() + 1,
+                pSiblingInner->vChildren.begin() + pSiblingInner->iCount + 1,
+                pSiblingInner->vChildren.begin());
+            pSiblingInner->iCount -= 1;
+            resetKey(pSiblingInner->vKeys[pSiblingInner->iCount]);
+            pSiblingInner->vChildren[pSiblingInner->iCount + 1] = nullptr;
+        }
+
+        /**
+         * Moves all keys of the child that follows the specified one into the specified child and removes
+         * the emptied child.
+         *
+         * @param pParent Parent node.
+         * @param iChild  Index of the left child of the two.
+         */
+        void mergeChildren(InnerNode* pParent, size_t iChild) {
+            const auto pLeft = pParent->vChildren[iChild];
+            const auto pRight = pParent->vChildren[iChild + 1];
+
+            if (pLeft->bIsLeaf) {
+                const auto pLeftLeaf = static_cast<LeafNode*>(pLeft);
+                const auto pRightLeaf = static_cast<LeafNode*>(pRight);
+
+                std::move(
+                    pRightLeaf->vKeys.begin(), pRightLeaf->vKeys.begin() + pRightLeaf->iCount,
+                    pLeftLeaf->vKeys.begin() + pLeftLeaf->iCount);
+                std::move(
+                    pRightLeaf->vValues.begin(), pRightLeaf->vValues.begin() + pRightLeaf->iCount,
+                    pLeftLeaf->vValues.begin() + pLeftLeaf->iCount);
+                pLeftLeaf->iCount += pRightLeaf->iCount;
+                pLeftLeaf->pNext = pRightLeaf->pNext;
+            } else {
+                const auto pLeftInner = static_cast<InnerNode*>(pLeft);
+                const auto pRightInner = static_cast<InnerNode*>(pRight);
+
+                // The separator goes down between keys of the two nodes.
+                pLeftInner->vKeys[pLeftInner->iCount] = std::move(pParent->vKeys[iChild]);
+                std::move(
+                    pRightInner->vKeys.begin(), pRightInner->vKeys.begin() + pRightInner->iCount,
+                    pLeftInner->vKeys.begin() + pLeftInner->iCount + 1);
+                std::copy_n(
+                    pRightInner->vChildren.begin(),
+                    pRightInner->iCount + 1,
+                    pLeftInner->vChildren.begin() + pLeftInner->iCount + 1);
+                pLeftInner->iCount += pRightInner->iCount + 1;
+            }
+            deleteNode(pRight);
+
+            // Remove the separator and the right child from the parent.
+            std::move(
+                pParent->vKeys.begin() + iChild + 1, pParent->vKeys.begin() + pParent->iCount,
+                pParent->vKeys.begin() + iChild);
+            std::move(
+                pParent->vChildren.begin() + iChild + 2, pParent->vChildren.begin() + pParent->iCount + 1,
+                pParent->vChildren.begin() + iChild + 1);
+            pParent->iCount -= 1;
+            resetKey(pParent->vKeys[pParent->iCount]);
+            pParent->vChildren[pParent->iCount + 1] = nullptr;
+        }
+
+        /** Root node (`nullptr` if the container is empty). */
+        Node* pRoot = nullptr;
+
+        /** Number of items in the container. */
+        size_t iSize = 0;
+
+        /** Compares keys. */
+        [[no_unique_address]] Compare compare;
+    };
+}
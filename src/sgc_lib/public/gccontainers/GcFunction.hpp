@@ -0,0 +1,512 @@
+#pragma once
+
+// Standard.
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// Custom.
+#include "GcContainerBase.h"
+#include "GarbageCollector.h"
+#include "GcPtr.h"
+
+namespace sgc {
+    template <typename Signature> class GcFunction;
+
+    /**
+     * `std::function` replacement that stores callables which capture `GcPtr`s: captured `GcPtr`s are
+     * items of the container (not root nodes) so a callable stored in a GC object that captures this
+     * object does not keep it alive forever:
+     * @code
+     * class Foo {
+     * public:
+     *     sgc::GcFunction<void()> callback;
+     * };
+     *
+     * auto pFoo = sgc::makeGc<Foo>();
+     * pFoo->callback = [pFoo]() {}; // not a cyclic reference anymore
+     * @endcode
+     *
+     * @remark Callables that fit into an internal buffer (a few pointers in size) are stored without
+     * allocating memory.
+     *
+     * @remark Only `GcPtr`s that the callable stores directly (captures) are treated as items, other GC
+     * containers that the callable stores (for example a captured `GcFunction`) are still root nodes.
+     * Places of `GcPtr`s are recorded once per callable type, a callable that stores its `GcPtr`s at
+     * other places than the first callable of its type (for example captures a `std::optional<GcPtr<T>>`
+     * that is only sometimes engaged) records its own places (which allocates memory).
+     *
+     * @remark Like `std::function` requires copyable callables.
+     *
+     * @tparam Return Type that the callable returns.
+     * @tparam Args   Types of arguments of the callable.
+     */
+    template <typename Return, typename... Args> class GcFunction<Return(Args...)> : public GcContainerBase {
+    public:
+        virtual ~GcFunction() override {
+            {
+                // Make sure the GC is not currently iterating over this container since we modify it.
+                ModificationGuard guard(this);
+
+                reset();
+            }
+
+            notifyGarbageCollectorAboutDestruction();
+        }
+
+        /** Creates an empty function. */
+        GcFunction() : GcContainerBase(iterateOverGcPtrItems) {}
+
+        /** Creates an empty function. */
+        GcFunction(std::nullptr_t) : GcContainerBase(iterateOverGcPtrItems) {} // NOLINT: like std::function
+
+        /**
+         * Creates a function that stores the specified callable.
+         *
+         * @param callable Callable to store.
+         */
+        template <typename Callable>
+            requires(!std::same_as<std::remove_cvref_t<Callable>, GcFunction>) &&
+                    std::is_copy_constructible_v<std::decay_t<Callable>> &&
+                    std::is_invocable_r_v<Return, std::decay_t<Callable>&, Args...>
+        GcFunction(Callable&& callable) // NOLINT: implicit like std::function
+            : GcContainerBase(iterateOverGcPtrItems) {
+            // Make sure the GC is not currently iterating over this container since we modify the container.
+            ModificationGuard guard(this);
+
+            emplace(std::forward<Callable>(callable));
+        }
+
+        /**
+         * Copy constructor.
+         *
+         * @param other Function to copy.
+         */
+        GcFunction(const GcFunction& other) : GcContainerBase(iterateOverGcPtrItems) {
+            // Make sure the GC is not currently iterating over this container since we modify the container.
+            ModificationGuard guard(this);
+
+            copyFrom(other);
+        }
+
+        /**
+         * Move constructor.
+         *
+         * @param other Function to move.
+         */
+        GcFunction(GcFunction&& other) noexcept : GcContainerBase(iterateOverGcPtrItems) {
+            // Make sure the GC is not currently iterating over this container since we modify the container.
+            ModificationGuard guard(this);
+
+            moveFrom(std::move(other));
+        }
+
+        /**
+         * Copy assignment operator.
+         *
+         * @param other Function to copy.
+         *
+         * @return This.
+         */
+        GcFunction& operator=(const GcFunction& other) {
+            if (this == &other) {
+                return *this;
+            }
+
+            // Make sure the GC is not currently iterating over this container since we modify the container.
+            ModificationGuard guard(this);
+
+            reset();
+            copyFrom(other);
+
+            return *this;
+        }
+
+        /**
+         * Move assignment operator.
+         *
+         * @param other Function to move.
+         *
+         * @return This.
+         */
+        GcFunction& operator=(GcFunction&& other) noexcept {
+            if (this == &other) {
+                return *this;
+            }
+
+            // Make sure the GC is not currently iterating over this container since we modify the container.
+            ModificationGuard guard(this);
+
+            reset();
+            moveFrom(std::move(other));
+
+            return *this;
+        }
+
+        /**
+         * Replaces the stored callable.
+         *
+         * @param callable Callable to store.
+         *
+         * @return This.
+         */
+        template <typename Callable>
+            requires(!std::same_as<std::remove_cvref_t<Callable>, GcFunction>) &&
+                    std::is_copy_constructible_v<std::decay_t<Callable>> &&
+                    std::is_invocable_r_v<Return, std::decay_t<Callable>&, Args...>
+        GcFunction& operator=(Callable&& callable) {
+            // Construct first because the callable might be stored in our current callable.
+            GcFunction newFunction(std::forward<Callable>(callable));
+
+            return *this = std::move(newFunction);
+        }
+
+        /**
+         * Destroys the stored callable.
+         *
+         * @return This.
+         */
+        GcFunction& operator=(std::nullptr_t) {
+            // Make sure the GC is not currently iterating over this container since we modify the container.
+            ModificationGuard guard(this);
+
+            reset();
+
+            return *this;
+        }
+
+        /**
+         * Tells if a callable is stored.
+         *
+         * @return `true` if the function is not empty.
+         */
+        explicit operator bool() const noexcept { return pOps != nullptr; }
+
+        /**
+         * Calls the stored callable.
+         *
+         * @remark Throws `std::bad_function_call` if the function is empty.
+         *
+         * @param args Arguments to pass.
+         *
+         * @return Value that the callable returned.
+         */
+        Return operator()(Args... args) const {
+            if (pOps == nullptr) [[unlikely]] {
+                throw std::bad_function_call();
+            }
+
+            return pOps->invoke(getCallable(), std::forward<Args>(args)...);
+        }
+
+    private:
+        /** Size of the buffer that stores small callables without allocating memory. */
+        static constexpr size_t iInlineStorageSize = 64; // NOLINT: a few captured pointers
+
+        /** Offsets of `GcPtr`s (from the start of the callable) of most callables of a callable type. */
+        struct GcPtrOffsets {
+            /** Protects @ref vOffsets while they are not known. */
+            std::mutex mtxRecording;
+
+            /** `true` after @ref vOffsets were recorded (they are never modified after that). */
+            std::atomic<bool> bKnown{false};
+
+            /** Offsets of `GcPtr`s in bytes. */
+            std::vector<size_t> vOffsets;
+        };
+
+        /** Type-erased operations of a callable type. */
+        struct CallableOps {
+            /** Calls the callable. */
+            Return (*invoke)(void* pCallable, Args&&... args);
+
+            /** Copy-constructs a callable in the specified memory. */
+            void (*copyConstruct)(void* pDestination, const void* pSource);
+
+            /** Move-constructs a callable in the specified memory (only used for inline callables). */
+            void (*moveConstruct)(void* pDestination, void* pSource) noexcept;
+
+            /** Destroys the callable (does not free its memory). */
+            void (*destroy)(void* pCallable) noexcept;
+
+            /** Offsets of `GcPtr`s of the callable type. */
+            GcPtrOffsets* pGcPtrOffsets;
+
+            /** Size of the callable type in bytes. */
+            size_t iSizeInBytes;
+
+            /** Alignment of the callable type in bytes. */
+            size_t iAlignment;
+
+            /** `true` if the callable is stored in @ref inlineStorage, `false` if allocated. */
+            bool bIsInline;
+        };
+
+        /**
+         * Operations and `GcPtr` offsets of a callable type.
+         *
+         * @tparam Callable Callable type.
+         */
+        template <typename Callable> struct CallableInfo {
+            /** Offsets of `GcPtr`s, recorded when the first callable of this type is constructed. */
+            static inline GcPtrOffsets gcPtrOffsets;
+
+            /** Operations of the callable type. */
+            static constexpr CallableOps ops{
+                .invoke = [](void* pCallable, Args&&... args) -> Return {
+                    return std::invoke(*static_cast<Callable*>(pCallable), std::forward<Args>(args)...);
+                },
+                .copyConstruct =
+                    [](void* pDestination, const void* pSource) {
+                        new (pDestination) Callable(*static_cast<const Callable*>(pSource));
+                    },
+                .moveConstruct =
+                    [](void* pDestination, void* pSource) noexcept {
+                        new (pDestination) Callable(std::move(*static_cast<Callable*>(pSource)));
+                    },
+                .destroy = [](void* pCallable) noexcept { static_cast<Callable*>(pCallable)->~Callable(); },
+                .pGcPtrOffsets = &gcPtrOffsets,
+                .iSizeInBytes = sizeof(Callable),
+                .iAlignment = alignof(Callable),
+                .bIsInline = sizeof(Callable) <= iInlineStorageSize &&
+                             alignof(Callable) <= alignof(std::max_align_t) &&
+                             std::is_nothrow_move_constructible_v<Callable>};
+        };
+
+        /**
+         * Iterates over `GcPtr`s captured by the stored callable.
+         *
+         * @param pContainer  This.
+         * @param onGcPtrItem Called on every GcPtr item in the container.
+         */
+        static inline void iterateOverGcPtrItems(
+            const GcContainerBase* pContainer, const std::function<void(const GcPtrBase*)>& onGcPtrItem) {
+            // Get this.
+            const auto pThis = reinterpret_cast<const GcFunction*>(pContainer);
+            if (pThis->pOps == nullptr) {
+                return;
+            }
+
+            // Iterate over captures.
+            const auto pCallable = static_cast<const std::byte*>(pThis->getCallable());
+            for (const auto& iOffset : pThis->getGcPtrOffsets()) {
+                onGcPtrItem(reinterpret_cast<const GcPtrBase*>(pCallable + iOffset));
+            }
+        }
+
+        /** Frees memory of a callable that does not fit into @ref inlineStorage. */
+        struct AllocatedCallableDeleter {
+            /**
+             * Frees the specified memory.
+             *
+             * @param pCallable Memory allocated for a callable of @ref pOps type.
+             */
+            void operator()(void* pCallable) const noexcept {
+                ::operator delete(pCallable, pOps->iSizeInBytes, std::align_val_t(pOps->iAlignment));
+            }
+
+            /** Operations of the callable type. */
+            const CallableOps* pOps = nullptr;
+        };
+
+        /**
+         * Returns memory of the stored callable.
+         *
+         * @remark Expects that a callable is stored.
+         *
+         * @return Callable.
+         */
+        void* getCallable() const {
+            return pOps->bIsInline ? const_cast<std::byte*>(inlineStorage) : pAllocatedCallable;
+        }
+
+        /**
+         * Returns offsets of `GcPtr`s of the stored callable.
+         *
+         * @remark Expects that a callable is stored.
+         *
+         * @return Offsets from the start of the callable.
+         */
+        const std::vector<size_t>& getGcPtrOffsets() const {
+            return bHasOwnGcPtrOffsets ? vOwnGcPtrOffsets : pOps->pGcPtrOffsets->vOffsets;
+        }
+
+        /**
+         * Constructs a callable of the specified type in our storage.
+         *
+         * @remark Expects that the function is empty and a modification guard exists.
+         *
+         * @param pNewOps   Operations of the callable type.
+         * @param constructCallable Constructs the callable in the specified memory.
+         */
+        template <typename Construct>
+        void construct(const CallableOps* pNewOps, const Construct& constructCallable) {
+            // Allocate memory if the callable does not fit into inline storage (freed if construction fails).
+            std::unique_ptr<void, AllocatedCallableDeleter> pAllocated(
+                nullptr, AllocatedCallableDeleter{pNewOps});
+            if (!pNewOps->bIsInline) {
+                pAllocated.reset(
+                    ::operator new(pNewOps->iSizeInBytes, std::align_val_t(pNewOps->iAlignment)));
+            }
+            void* const pStorage = pNewOps->bIsInline ? static_cast<void*>(inlineStorage) : pAllocated.get();
+
+            // Check offsets of captured GC pointers against offsets of the callable type (record them if this
+            // is the first callable of its type).
+            auto& gcPtrOffsets = *pNewOps->pGcPtrOffsets;
+            const auto bOffsetsKnown = gcPtrOffsets.bKnown.load(std::memory_order_acquire);
+            std::vector<size_t> vRecordedOffsets;
+            bool bHasTypeOffsets = false;
+
+            {
+                ItemConstructionGuard itemGuard(
+                    pStorage,
+                    pNewOps->iSizeInBytes,
+                    &vRecordedOffsets,
+                    bOffsetsKnown ? &gcPtrOffsets.vOffsets : nullptr);
+                constructCallable(pStorage);
+
+                bHasTypeOffsets = bOffsetsKnown && itemGuard.hasExpectedGcPtrOffsets();
+            }
+
+            if (!bOffsetsKnown) {
+                std::scoped_lock offsetsGuard(gcPtrOffsets.mtxRecording);
+                if (!gcPtrOffsets.bKnown.load(std::memory_order_relaxed)) {
+                    gcPtrOffsets.vOffsets = std::move(vRecordedOffsets);
+                    gcPtrOffsets.bKnown.store(true, std::memory_order_release);
+                    bHasTypeOffsets = true;
+                } else {
+                    // Recorded by another thread at the same time.
+                    bHasTypeOffsets = gcPtrOffsets.vOffsets == vRecordedOffsets;
+                }
+            }
+
+            pOps = pNewOps;
+            pAllocatedCallable = pAllocated.release();
+            if (!bHasTypeOffsets) [[unlikely]] {
+                vOwnGcPtrOffsets = std::move(vRecordedOffsets);
+                bHasOwnGcPtrOffsets = true;
+            }
+        }
+
+        /**
+         * Stores a copy (or moved) callable.
+         *
+         * @remark Expects that the function is empty and a modification guard exists.
+         *
+         * @param callable Callable to store.
+         */
+        template <typename Callable> void emplace(Callable&& callable) {
+            using StoredCallable = std::decay_t<Callable>;
+
+            if constexpr (std::is_pointer_v<StoredCallable> || std::is_member_pointer_v<StoredCallable>) {
+                if (callable == nullptr) {
+                    return;
+                }
+            }
+
+            construct(&CallableInfo<StoredCallable>::ops, [&callable](void* pStorage) {
+                new (pStorage) StoredCallable(std::forward<Callable>(callable));
+            });
+        }
+
+        /**
+         * Copies the callable of the specified function.
+         *
+         * @remark Expects that the function is empty and a modification guard exists.
+         *
+         * @param other Function to copy.
+         */
+        void copyFrom(const GcFunction& other) {
+            if (other.pOps == nullptr) {
+                return;
+            }
+
+            const auto pOtherCallable = other.getCallable();
+            construct(other.pOps, [&other, pOtherCallable](void* pStorage) {
+                other.pOps->copyConstruct(pStorage, pOtherCallable);
+            });
+        }
+
+        /**
+         * Takes the callable of the specified function.
+         *
+         * @remark Expects that the function is empty and a modification guard exists.
+         *
+         * @param other Function to move.
+         */
+        void moveFrom(GcFunction&& other) noexcept {
+            if (other.pOps == nullptr) {
+                return;
+            }
+
+            // Make sure the GC is not currently iterating over the other container since we modify it.
+            ModificationGuard otherGuard(&other);
+
+            // Moved captures belong to our garbage collector.
+            ModificationGuard guard(this);
+
+            if (!other.pOps->bIsInline) {
+                // Take the allocated callable (its GC pointers stay where they are).
+                pOps = std::exchange(other.pOps, nullptr);
+                pAllocatedCallable = std::exchange(other.pAllocatedCallable, nullptr);
+                vOwnGcPtrOffsets = std::move(other.vOwnGcPtrOffsets);
+                bHasOwnGcPtrOffsets = std::exchange(other.bHasOwnGcPtrOffsets, false);
+                return;
+            }
+
+            const auto pOtherOps = other.pOps;
+            construct(pOtherOps, [&other, pOtherOps](void* pStorage) {
+                pOtherOps->moveConstruct(pStorage, other.inlineStorage);
+            });
+
+            other.reset();
+        }
+
+        /**
+         * Destroys the stored callable (if any).
+         *
+         * @remark Expects that a modification guard exists.
+         */
+        void reset() noexcept {
+            if (pOps == nullptr) {
+                return;
+            }
+
+            const auto pOldOps = std::exchange(pOps, nullptr);
+            if (bHasOwnGcPtrOffsets) [[unlikely]] {
+                vOwnGcPtrOffsets.clear();
+                bHasOwnGcPtrOffsets = false;
+            }
+
+            if (pOldOps->bIsInline) {
+                pOldOps->destroy(inlineStorage);
+                return;
+            }
+
+            const auto pCallable = std::exchange(pAllocatedCallable, nullptr);
+            pOldOps->destroy(pCallable);
+            ::operator delete(pCallable, pOldOps->iSizeInBytes, std::align_val_t(pOldOps->iAlignment));
+        }
+
+        /** Operations of the stored callable type (`nullptr` if empty). */
+        const CallableOps* pOps = nullptr;
+
+        /** Stored callable if it does not fit into @ref inlineStorage. */
+        void* pAllocatedCallable = nullptr;
+
+        /** Offsets of `GcPtr`s of the stored callable if they differ from offsets of its type. */
+        std::vector<size_t> vOwnGcPtrOffsets;
+
+        /** `true` if @ref vOwnGcPtrOffsets are used instead of offsets of the callable type. */
+        bool bHasOwnGcPtrOffsets = false;
+
+        /** Stores small callables. */
+        alignas(std::max_align_t) std::byte inlineStorage[iInlineStorageSize];
+    };
+}
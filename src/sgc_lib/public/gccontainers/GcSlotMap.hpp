@@ -0,0 +1,419 @@
+#pragma once
+
+// Standard.
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+// Custom.
+#include "GcContainerBase.h"
+#include "GarbageCollector.h"
+#include "GcPtr.h"
+
+namespace sgc {
+    /**
+     * Container that stores `GcPtr<InnerType>` items in a dense array and returns stable handles to them:
+     * insertion and erasure are O(1) (erasure moves the last item into the erased place) and handles of
+     * erased items are detected using generations so they never reference a different item.
+     *
+     * @remark Iteration visits items in the dense array, the order changes when items are erased.
+     *
+     * @tparam OuterType `GcPtr`.
+     * @tparam InnerType Type that `GcPtr`s of this container will store.
+     */
+    template <typename OuterType, typename InnerType = typename OuterType::element_type>
+        requires(std::same_as<OuterType, GcPtr<InnerType, true>> ||   // only GcPtr items are supported
+                 std::same_as<OuterType, GcPtr<InnerType, false>>) && //
+                (!std::derived_from<InnerType, GcContainerBase>)      // inner containers not supported
+    class GcSlotMap : public GcContainerBase {
+        /** Marks the end of the free slot list and invalid handles. */
+        static constexpr uint32_t iInvalidIndex = std::numeric_limits<uint32_t>::max();
+
+        /** Indirection from a handle to an item. */
+        struct Slot {
+            /** Index of the item in the dense array if the slot is used, otherwise the next free slot. */
+            uint32_t iIndex = iInvalidIndex;
+
+            /** Incremented every time the item of the slot is erased. */
+            uint32_t iGeneration = 0;
+        };
+
+    public:
+        /** Type that we store in the dense array. */
+        using vec_item_t = sgc::GcPtr<InnerType, false>;
+
+        /** Type of the dense array that stores items. */
+        using vec_t = std::vector<vec_item_t>;
+
+        /** Stable reference to an item of the container. */
+        struct Handle {
+            /**
+             * Compares handles.
+             *
+             * @param other Handle to compare with.
+             *
+             * @return `true` if handles reference the same item.
+             */
+            bool operator==(const Handle& other) const = default;
+
+            /** Index of the slot (invalid for default constructed handles). */
+            uint32_t iSlot = iInvalidIndex;
+
+            /** Generation of the slot when the item was inserted. */
+            uint32_t iGeneration = 0;
+        };
+
+        virtual ~GcSlotMap() override { notifyGarbageCollectorAboutDestruction(); }
+
+        /** Creates an empty container. */
+        GcSlotMap() : GcContainerBase(iterateOverGcPtrItems) {}
+
+        /**
+         * Copy constructor.
+         *
+         * @remark Handles of the copied container are valid for the copy too.
+         *
+         * @param other Container to copy.
+         */
+        GcSlotMap(const GcSlotMap& other) : GcContainerBase(iterateOverGcPtrItems) {
+            // Make sure the GC is not currently iterating over this container since we modify the container.
+            ModificationGuard guard(this);
+
+            copyFrom(other);
+        }
+
+        /**
+         * Move constructor.
+         *
+         * @param other Container to move.
+         */
+        GcSlotMap(GcSlotMap&& other) noexcept : GcContainerBase(iterateOverGcPtrItems) {
+            // Make sure the GC is not currently iterating over this container since we modify the container.
+            ModificationGuard guard(this);
+
+            moveFrom(other);
+        }
+
+        /**
+         * Copy assignment operator.
+         *
+         * @param other Container to copy.
+         *
+         * @return This.
+         */
+        GcSlotMap& operator=(const GcSlotMap& other) {
+            // Make sure the GC is not currently iterating over this container since we modify the container.
+            ModificationGuard guard(this);
+
+            copyFrom(other);
+
+            return *this;
+        }
+
+        /**
+         * Move assignment operator.
+         *
+         * @param other Container to move.
+         *
+         * @return This.
+         */
+        GcSlotMap& operator=(GcSlotMap&& other) noexcept {
+            if (this == &other) {
+                return *this;
+            }
+
+            // Make sure the GC is not currently iterating over this container since we modify the container.
+            ModificationGuard guard(this);
+
+            moveFrom(other);
+
+            return *this;
+        }
+
+        /**
+         * Returns an iterator to the first item of the dense array.
+         *
+         * @return Iterator.
+         */
+        constexpr vec_t::iterator begin() noexcept { return vData.begin(); }
+
+        /**
+         * Returns an iterator to the element following the last item of the dense array.
+         *
+         * @return Iterator.
+         */
+        constexpr vec_t::iterator end() noexcept { return vData.end(); }
+
+        /**
+         * Returns an iterator to the first item of the dense array.
+         *
+         * @return Iterator.
+         */
+        constexpr vec_t::const_iterator cbegin() const noexcept { return vData.cbegin(); }
+
+        /**
+         * Returns an iterator to the element following the last item of the dense array.
+         *
+         * @return Iterator.
+         */
+        constexpr vec_t::const_iterator cend() const noexcept { return vData.cend(); }
+
+        /**
+         * Checks whether the container is empty.
+         *
+         * @return `true` if empty, `false` otherwise.
+         */
+        constexpr bool empty() const noexcept { return vData.empty(); }
+
+        /**
+         * Returns the number of items in the container.
+         *
+         * @return Size.
+         */
+        constexpr size_t size() const noexcept { return vData.size(); }
+
+        /**
+         * Reserves storage.
+         *
+         * @param iSize Number of items to reserve memory for.
+         */
+        inline void reserve(size_t iSize) {
+            // Make sure the GC is not currently iterating over this container since we modify the container.
+            ModificationGuard guard(this);
+
+            vData.reserve(iSize);
+            vDataSlots.reserve(iSize);
+            vSlots.reserve(iSize);
+        }
+
+        /**
+         * Adds an item to the container.
+         *
+         * @param value Item to add.
+         *
+         * @return Handle to the added item.
+         */
+        inline Handle insert(const vec_item_t& value) {
+            // Make sure the GC is not currently iterating over this container since we modify the container.
+            ModificationGuard guard(this);
+
+            const auto handle = allocateSlot();
+            vData.push_back(value);
+
+            return handle;
+        }
+
+        /**
+         * Adds an item to the container.
+         *
+         * @param value Item to add.
+         *
+         * @return Handle to the added item.
+         */
+        inline Handle insert(vec_item_t&& value) {
+            // Make sure the GC is not currently iterating over this container since we modify the container.
+            ModificationGuard guard(this);
+
+            const auto handle = allocateSlot();
+            vData.push_back(std::move(value));
+
+            return handle;
+        }
+
+        /**
+         * Removes the item of the specified handle (the last item of the dense array takes its place).
+         *
+         * @param handle Handle of the item.
+         *
+         * @return `true` if the item was removed, `false` if the handle does not reference an item.
+         */
+        inline bool erase(Handle handle) {
+            // Make sure the GC is not currently iterating over this container since we modify the container.
+            ModificationGuard guard(this);
+
+            if (!contains(handle)) {
+                return false;
+            }
+            auto& slot = vSlots[handle.iSlot];
+
+            // Move the last item into the place of the erased one.
+            const auto iLastIndex = static_cast<uint32_t>(vData.size() - 1);
+            if (slot.iIndex != iLastIndex) {
+                vData[slot.iIndex] = std::move(vData[iLastIndex]);
+                vDataSlots[slot.iIndex] = vDataSlots[iLastIndex];
+                vSlots[vDataSlots[slot.iIndex]].iIndex = slot.iIndex;
+            }
+            vData.pop_back();
+            vDataSlots.pop_back();
+
+            // Invalidate handles to the slot and add it to the free list.
+            slot.iGeneration += 1;
+            slot.iIndex = iFirstFreeSlot;
+            iFirstFreeSlot = handle.iSlot;
+
+            return true;
+        }
+
+        /** Removes all items (all handles become invalid). */
+        inline void clear() {
+            // Make sure the GC is not currently iterating over this container since we modify the container.
+            ModificationGuard guard(this);
+
+            for (const auto& iSlot : vDataSlots) {
+                auto& slot = vSlots[iSlot];
+                slot.iGeneration += 1;
+                slot.iIndex = iFirstFreeSlot;
+                iFirstFreeSlot = iSlot;
+            }
+            vData.clear();
+            vDataSlots.clear();
+        }
+
+        /**
+         * Tells if the specified handle references an item of the container.
+         *
+         * @param handle Handle to check.
+         *
+         * @return `true` if the item exists, `false` if it was erased (or the handle is invalid).
+         */
+        inline bool contains(Handle handle) const {
+            // Generation of a slot changes when its item is erased.
+            return handle.iSlot < vSlots.size() && vSlots[handle.iSlot].iGeneration == handle.iGeneration;
+        }
+
+        /**
+         * Returns the item of the specified handle.
+         *
+         * @param handle Handle of the item.
+         *
+         * @return `nullptr` if the handle does not reference an item, otherwise the item.
+         */
+        inline vec_item_t* get(Handle handle) {
+            if (!contains(handle)) {
+                return nullptr;
+            }
+
+            return &vData[vSlots[handle.iSlot].iIndex];
+        }
+
+        /**
+         * Returns the item of the specified handle, with checking.
+         *
+         * @param handle Handle of the item.
+         *
+         * @return Item.
+         */
+        inline vec_item_t& at(Handle handle) {
+            const auto pItem = get(handle);
+            if (pItem == nullptr) {
+                throw std::out_of_range("the specified handle does not reference an item");
+            }
+
+            return *pItem;
+        }
+
+        /**
+         * Returns handle of the item at the specified position of the dense array.
+         *
+         * @param iPos Position of the item (see @ref begin).
+         *
+         * @return Handle.
+         */
+        inline Handle getHandle(size_t iPos) const {
+            const auto iSlot = vDataSlots.at(iPos);
+            return Handle{iSlot, vSlots[iSlot].iGeneration};
+        }
+
+    private:
+        /**
+         * Iterates over items in @ref vData.
+         *
+         * @param pContainer  This.
+         * @param onGcPtrItem Called on every GcPtr item in the container.
+         */
+        static inline void iterateOverGcPtrItems(
+            const GcContainerBase* pContainer, const std::function<void(const GcPtrBase*)>& onGcPtrItem) {
+            // Get this.
+            const auto pThis = reinterpret_cast<const GcSlotMap<OuterType, InnerType>*>(pContainer);
+
+            // Iterate over items.
+            for (const auto& pGcPtr : pThis->vData) {
+                onGcPtrItem(&pGcPtr);
+            }
+        }
+
+        /**
+         * Picks a slot for an item that is going to be added to the end of @ref vData.
+         *
+         * @remark Expects that the caller holds @ref ModificationGuard.
+         *
+         * @return Handle of the item.
+         */
+        inline Handle allocateSlot() {
+            if (vData.size() >= iInvalidIndex) [[unlikely]] {
+                throw std::length_error("slot map can't store more items");
+            }
+            const auto iIndex = static_cast<uint32_t>(vData.size());
+
+            // Reuse a free slot if there is one.
+            uint32_t iSlot = iFirstFreeSlot;
+            if (iSlot != iInvalidIndex) {
+                iFirstFreeSlot = vSlots[iSlot].iIndex;
+            } else {
+                iSlot = static_cast<uint32_t>(vSlots.size());
+                vSlots.push_back(Slot{});
+            }
+
+            vSlots[iSlot].iIndex = iIndex;
+            vDataSlots.push_back(iSlot);
+
+            return Handle{iSlot, vSlots[iSlot].iGeneration};
+        }
+
+        /**
+         * Copies items and slots of the specified container.
+         *
+         * @remark Expects that the caller holds @ref ModificationGuard.
+         *
+         * @param other Container to copy.
+         */
+        void copyFrom(const GcSlotMap& other) {
+            vData = other.vData;
+            vDataSlots = other.vDataSlots;
+            vSlots = other.vSlots;
+            iFirstFreeSlot = other.iFirstFreeSlot;
+        }
+
+        /**
+         * Takes items and slots of the specified container (leaves it empty).
+         *
+         * @remark Expects that the caller holds @ref ModificationGuard.
+         *
+         * @param other Container to move.
+         */
+        void moveFrom(GcSlotMap& other) {
+            vData = std::move(other.vData);
+            vDataSlots = std::move(other.vDataSlots);
+            vSlots = std::move(other.vSlots);
+            iFirstFreeSlot = std::exchange(other.iFirstFreeSlot, iInvalidIndex);
+
+            other.vData.clear();
+            other.vDataSlots.clear();
+            other.vSlots.clear();
+        }
+
+        /** Dense array of items. */
+        vec_t vData;
+
+        /** Slot index of each item in @ref vData. */
+        std::vector<uint32_t> vDataSlots;
+
+        /** Slots that handles reference. */
+        std::vector<Slot> vSlots;
+
+        /** Index of the first free slot in @ref vSlots (invalid index if there are no free slots). */
+        uint32_t iFirstFreeSlot = iInvalidIndex;
+    };
+}
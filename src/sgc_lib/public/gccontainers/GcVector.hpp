@@ -2,6 +2,7 @@
 
 // Standard.
 #include <vector>
+#include <memory_resource>
 
 // Custom.
 #include "GcContainerBase.h"
@@ -14,14 +15,19 @@ namespace sgc {
      *
      * @tparam OuterType `GcPtr`.
      * @tparam InnerType Type that `GcPtr`s of this container will store.
+     * @tparam Allocator Allocator for the vector's storage (see `sgc::pmr::GcVector` to use a
+     * `std::pmr::memory_resource`).
      */
-    template <typename OuterType, typename InnerType = typename OuterType::element_type>
+    template <
+        typename OuterType,
+        typename InnerType = typename OuterType::element_type,
+        typename Allocator = std::allocator<GcPtr<InnerType, false>>>
         requires(std::same_as<OuterType, GcPtr<InnerType, true>> ||   // only GcPtr items are supported
                  std::same_as<OuterType, GcPtr<InnerType, false>>) && //
                 (!std::derived_from<InnerType, GcContainerBase>)      // inner containers not supported
     class GcVector : public GcContainerBase {
         // Allow other container to look into our internals.
-        template <typename SomeOuterType, typename SomeInnerType>
+        template <typename SomeOuterType, typename SomeInnerType, typename SomeAllocator>
             requires(std::same_as<SomeOuterType, GcPtr<SomeInnerType, true>> ||
                      std::same_as<SomeOuterType, GcPtr<SomeInnerType, false>>) &&
                     (!std::derived_from<SomeInnerType, GcContainerBase>)
@@ -31,19 +37,38 @@ namespace sgc {
         /** Type that we store in `std::vector`. */
         using vec_item_t = sgc::GcPtr<InnerType, false>;
 
+        /** Type of the allocator used for the vector's storage. */
+        using allocator_type = Allocator;
+
+        /** Type of the `std::vector` that stores items. */
+        using vec_t = std::vector<vec_item_t, Allocator>;
+
         virtual ~GcVector() override { notifyGarbageCollectorAboutDestruction(); }
 
         /** Creates an empty container. */
         GcVector() : GcContainerBase(iterateOverGcPtrItems) {}
 
+        /**
+         * Creates an empty container that will use the specified allocator for its storage.
+         *
+         * @param allocator Allocator to use.
+         */
+        explicit GcVector(const Allocator& allocator)
+            : GcContainerBase(iterateOverGcPtrItems), vData(allocator) {}
+
         /**
          * Copy constructor.
          *
+         * @remark Picks allocator like `std::vector` does (a pmr vector uses the default memory resource).
+         *
          * @param vOther Container to copy.
          */
-        GcVector(const GcVector& vOther) : GcContainerBase(iterateOverGcPtrItems) {
+        GcVector(const GcVector& vOther)
+            : GcContainerBase(iterateOverGcPtrItems),
+              vData(std::allocator_traits<Allocator>::select_on_container_copy_construction(
+                  vOther.vData.get_allocator())) {
             // Make sure the GC is not currently iterating over this container since we modify the container.
-            std::scoped_lock guard(*GarbageCollector::get().getGarbageCollectionMutex());
+            ModificationGuard guard(this);
 
             vData = vOther.vData;
         }
@@ -53,9 +78,10 @@ namespace sgc {
          *
          * @param vOther Container to move.
          */
-        GcVector(GcVector&& vOther) noexcept : GcContainerBase(iterateOverGcPtrItems) {
+        GcVector(GcVector&& vOther) noexcept
+            : GcContainerBase(iterateOverGcPtrItems), vData(vOther.vData.get_allocator()) {
             // Make sure the GC is not currently iterating over this container since we modify the container.
-            std::scoped_lock guard(*GarbageCollector::get().getGarbageCollectionMutex());
+            ModificationGuard guard(this);
 
             vData = std::move(vOther.vData);
         }
@@ -63,15 +89,17 @@ namespace sgc {
         /**
          * Constructs the container with the specified copies of elements with value.
          *
-         * @param iCount Size of the vector.
-         * @param value  Optional value to copy.
+         * @param iCount    Size of the vector.
+         * @param value     Optional value to copy.
+         * @param allocator Optional allocator to use.
          */
-        explicit GcVector(size_t iCount, const vec_item_t& value = vec_item_t())
-            : GcContainerBase(iterateOverGcPtrItems) {
+        explicit GcVector(
+            size_t iCount, const vec_item_t& value = vec_item_t(), const Allocator& allocator = Allocator())
+            : GcContainerBase(iterateOverGcPtrItems), vData(allocator) {
             // Make sure the GC is not currently iterating over this container since we modify the container.
-            std::scoped_lock guard(*GarbageCollector::get().getGarbageCollectionMutex());
+            ModificationGuard guard(this);
 
-            vData = std::vector<vec_item_t>(iCount, value);
+            vData.assign(iCount, value);
         }
 
         /**
@@ -83,7 +111,7 @@ namespace sgc {
          */
         GcVector& operator=(const GcVector& vOther) {
             // Make sure the GC is not currently iterating over this container since we modify the container.
-            std::scoped_lock guard(*GarbageCollector::get().getGarbageCollectionMutex());
+            ModificationGuard guard(this);
 
             vData = vOther.vData;
 
@@ -99,7 +127,7 @@ namespace sgc {
          */
         GcVector& operator=(GcVector&& vOther) noexcept {
             // Make sure the GC is not currently iterating over this container since we modify the container.
-            std::scoped_lock guard(*GarbageCollector::get().getGarbageCollectionMutex());
+            ModificationGuard guard(this);
 
             vData = std::move(vOther.vData);
 
@@ -115,6 +143,15 @@ namespace sgc {
          */
         constexpr bool operator==(const GcVector& other) const noexcept { return vData == other.vData; }
 
+        /**
+         * Returns the allocator used for the vector's storage.
+         *
+         * @return Allocator.
+         */
+        constexpr Allocator get_allocator() const noexcept { // NOLINT: use name style as STL
+            return vData.get_allocator();
+        }
+
         /**
          * Returns a reference to the element at specified location, with bounds checking.
          *
@@ -183,7 +220,7 @@ namespace sgc {
          *
          * @return Iterator to the first element.
          */
-        constexpr std::vector<vec_item_t>::iterator begin() noexcept { return vData.begin(); }
+        constexpr vec_t::iterator begin() noexcept { return vData.begin(); }
 
         /**
          * Returns an iterator to the element following the last element of the vector.
@@ -192,7 +229,7 @@ namespace sgc {
          *
          * @return Iterator to the element following the last element.
          */
-        constexpr std::vector<vec_item_t>::iterator end() noexcept { return vData.end(); }
+        constexpr vec_t::iterator end() noexcept { return vData.end(); }
 
         /**
          * Returns an iterator to the first element of the vector.
@@ -201,7 +238,7 @@ namespace sgc {
          *
          * @return Iterator to the first element.
          */
-        constexpr std::vector<vec_item_t>::const_iterator cbegin() const noexcept { return vData.cbegin(); }
+        constexpr vec_t::const_iterator cbegin() const noexcept { return vData.cbegin(); }
 
         /**
          * Returns an iterator to the element following the last element of the vector.
@@ -210,7 +247,7 @@ namespace sgc {
          *
          * @return Iterator to the element following the last element.
          */
-        constexpr std::vector<vec_item_t>::const_iterator cend() const noexcept { return vData.cend(); }
+        constexpr vec_t::const_iterator cend() const noexcept { return vData.cend(); }
 
         /**
          * Returns a reverse iterator to the first element of the reversed vector.
@@ -219,7 +256,7 @@ namespace sgc {
          *
          * @return Reverse iterator to the first element.
          */
-        constexpr std::vector<vec_item_t>::iterator rbegin() noexcept { return vData.rbegin(); }
+        constexpr vec_t::iterator rbegin() noexcept { return vData.rbegin(); }
 
         /**
          * Returns a reverse iterator to the element following the last element of the reversed vector.
@@ -228,7 +265,7 @@ namespace sgc {
          *
          * @return Reverse iterator to the element following the last element.
          */
-        constexpr std::vector<vec_item_t>::iterator rend() noexcept { return vData.rend(); }
+        constexpr vec_t::iterator rend() noexcept { return vData.rend(); }
 
         /**
          * Returns a reverse iterator to the first element of the reversed vector.
@@ -237,7 +274,7 @@ namespace sgc {
          *
          * @return Reverse iterator to the first element.
          */
-        constexpr std::vector<vec_item_t>::iterator crbegin() const noexcept { return vData.crbegin(); }
+        constexpr vec_t::iterator crbegin() const noexcept { return vData.crbegin(); }
 
         /**
          * Returns a reverse iterator to the element following the last element of the reversed vector.
@@ -246,7 +283,7 @@ namespace sgc {
          *
          * @return Reverse iterator to the element following the last element.
          */
-        constexpr std::vector<vec_item_t>::iterator crend() const noexcept { return vData.crend(); }
+        constexpr vec_t::iterator crend() const noexcept { return vData.crend(); }
 
         /**
          * Checks whether the container is empty.
@@ -269,7 +306,7 @@ namespace sgc {
          */
         inline void reserve(size_t iSize) {
             // Make sure the GC is not currently iterating over this container since we modify the container.
-            std::scoped_lock guard(*GarbageCollector::get().getGarbageCollectionMutex());
+            ModificationGuard guard(this);
 
             vData.reserve(iSize);
         }
@@ -284,7 +321,7 @@ namespace sgc {
         /** Reduces memory usage by freeing unused memory. */
         inline void shrink_to_fit() { // NOLINT: use name style as STL
             // Make sure the GC is not currently iterating over this container since we modify the container.
-            std::scoped_lock guard(*GarbageCollector::get().getGarbageCollectionMutex());
+            ModificationGuard guard(this);
 
             vData.shrink_to_fit();
         }
@@ -292,7 +329,7 @@ namespace sgc {
         /** Erases all elements from the container. */
         inline void clear() {
             // Make sure the GC is not currently iterating over this container since we modify the container.
-            std::scoped_lock guard(*GarbageCollector::get().getGarbageCollectionMutex());
+            ModificationGuard guard(this);
 
             vData.clear();
         }
@@ -303,9 +340,9 @@ namespace sgc {
          * @param pos   Iterator before which the content will be inserted.
          * @param value Value to insert.
          */
-        inline void insert(std::vector<vec_item_t>::iterator pos, const vec_item_t& value) {
+        inline void insert(vec_t::iterator pos, const vec_item_t& value) {
             // Make sure the GC is not currently iterating over this container since we modify the container.
-            std::scoped_lock guard(*GarbageCollector::get().getGarbageCollectionMutex());
+            ModificationGuard guard(this);
 
             vData.insert(pos, value);
         }
@@ -316,9 +353,9 @@ namespace sgc {
          * @param pos   Iterator before which the content will be inserted.
          * @param value Value to insert.
          */
-        inline void insert(std::vector<vec_item_t>::iterator pos, vec_item_t&& value) {
+        inline void insert(vec_t::iterator pos, vec_item_t&& value) {
             // Make sure the GC is not currently iterating over this container since we modify the container.
-            std::scoped_lock guard(*GarbageCollector::get().getGarbageCollectionMutex());
+            ModificationGuard guard(this);
 
             vData.insert(pos, std::forward<vec_item_t>(value));
         }
@@ -329,9 +366,9 @@ namespace sgc {
          * @param pos   Iterator before which the content will be inserted.
          * @param value Value to insert.
          */
-        inline void insert(std::vector<vec_item_t>::const_iterator pos, const vec_item_t& value) {
+        inline void insert(vec_t::const_iterator pos, const vec_item_t& value) {
             // Make sure the GC is not currently iterating over this container since we modify the container.
-            std::scoped_lock guard(*GarbageCollector::get().getGarbageCollectionMutex());
+            ModificationGuard guard(this);
 
             vData.insert(pos, value);
         }
@@ -342,9 +379,9 @@ namespace sgc {
          * @param pos   Iterator before which the content will be inserted.
          * @param value Value to insert.
          */
-        inline void insert(std::vector<vec_item_t>::const_iterator pos, vec_item_t&& value) {
+        inline void insert(vec_t::const_iterator pos, vec_item_t&& value) {
             // Make sure the GC is not currently iterating over this container since we modify the container.
-            std::scoped_lock guard(*GarbageCollector::get().getGarbageCollectionMutex());
+            ModificationGuard guard(this);
 
             vData.insert(pos, std::forward<vec_item_t>(value));
         }
@@ -356,9 +393,9 @@ namespace sgc {
          *
          * @return Iterator following the last removed element.
          */
-        inline std::vector<vec_item_t>::iterator erase(std::vector<vec_item_t>::iterator pos) {
+        inline vec_t::iterator erase(vec_t::iterator pos) {
             // Make sure the GC is not currently iterating over this container since we modify the container.
-            std::scoped_lock guard(*GarbageCollector::get().getGarbageCollectionMutex());
+            ModificationGuard guard(this);
 
             return vData.erase(pos);
         }
@@ -370,9 +407,9 @@ namespace sgc {
          *
          * @return Iterator following the last removed element.
          */
-        inline std::vector<vec_item_t>::iterator erase(std::vector<vec_item_t>::const_iterator pos) {
+        inline vec_t::iterator erase(vec_t::const_iterator pos) {
             // Make sure the GC is not currently iterating over this container since we modify the container.
-            std::scoped_lock guard(*GarbageCollector::get().getGarbageCollectionMutex());
+            ModificationGuard guard(this);
 
             return vData.erase(pos);
         }
@@ -385,10 +422,9 @@ namespace sgc {
          *
          * @return Iterator following the last removed element.
          */
-        inline std::vector<vec_item_t>::iterator
-        erase(std::vector<vec_item_t>::iterator first, std::vector<vec_item_t>::iterator last) {
+        inline vec_t::iterator erase(vec_t::iterator first, vec_t::iterator last) {
             // Make sure the GC is not currently iterating over this container since we modify the container.
-            std::scoped_lock guard(*GarbageCollector::get().getGarbageCollectionMutex());
+            ModificationGuard guard(this);
 
             return vData.erase(first, last);
         }
@@ -401,10 +437,9 @@ namespace sgc {
          *
          * @return Iterator following the last removed element.
          */
-        inline std::vector<vec_item_t>::iterator
-        erase(std::vector<vec_item_t>::const_iterator first, std::vector<vec_item_t>::const_iterator last) {
+        inline vec_t::iterator erase(vec_t::const_iterator first, vec_t::const_iterator last) {
             // Make sure the GC is not currently iterating over this container since we modify the container.
-            std::scoped_lock guard(*GarbageCollector::get().getGarbageCollectionMutex());
+            ModificationGuard guard(this);
 
             return vData.erase(first, last);
         }
@@ -416,7 +451,7 @@ namespace sgc {
          */
         inline void push_back(const vec_item_t& valueToAdd) { // NOLINT: use name style as STL
             // Make sure the GC is not currently iterating over this container since we modify the container.
-            std::scoped_lock guard(*GarbageCollector::get().getGarbageCollectionMutex());
+            ModificationGuard guard(this);
 
             vData.push_back(valueToAdd);
         }
@@ -428,7 +463,7 @@ namespace sgc {
          */
         inline void push_back(vec_item_t&& valueToAdd) { // NOLINT: use name style as STL
             // Make sure the GC is not currently iterating over this container since we modify the container.
-            std::scoped_lock guard(*GarbageCollector::get().getGarbageCollectionMutex());
+            ModificationGuard guard(this);
 
             vData.push_back(std::forward<vec_item_t>(valueToAdd));
         }
@@ -443,7 +478,7 @@ namespace sgc {
         template <class... Args>
         inline vec_item_t& emplace_back(Args&&... args) { // NOLINT: use name style as STL
             // Make sure the GC is not currently iterating over this container since we modify the container.
-            std::scoped_lock guard(*GarbageCollector::get().getGarbageCollectionMutex());
+            ModificationGuard guard(this);
 
             return vData.emplace_back(std::forward<Args>(args)...);
         }
@@ -451,7 +486,7 @@ namespace sgc {
         /** Removes the last element of the container. */
         inline void pop_back() { // NOLINT: use name style as STL
             // Make sure the GC is not currently iterating over this container since we modify the container.
-            std::scoped_lock guard(*GarbageCollector::get().getGarbageCollectionMutex());
+            ModificationGuard guard(this);
 
             vData.pop_back();
         }
@@ -463,7 +498,7 @@ namespace sgc {
          */
         inline void resize(size_t iCount) {
             // Make sure the GC is not currently iterating over this container since we modify the container.
-            std::scoped_lock guard(*GarbageCollector::get().getGarbageCollectionMutex());
+            ModificationGuard guard(this);
 
             vData.resize(iCount);
         }
@@ -476,7 +511,7 @@ namespace sgc {
          */
         inline void resize(size_t iCount, const vec_item_t& value) {
             // Make sure the GC is not currently iterating over this container since we modify the container.
-            std::scoped_lock guard(*GarbageCollector::get().getGarbageCollectionMutex());
+            ModificationGuard guard(this);
 
             vData.resize(iCount, value);
         }
@@ -491,8 +526,7 @@ namespace sgc {
         static inline void iterateOverGcPtrItems(
             const GcContainerBase* pContainer, const std::function<void(const GcPtrBase*)>& onGcPtrItem) {
             // Get this.
-            using item_t = GcVector<OuterType>::vec_item_t;
-            const auto pThis = reinterpret_cast<const GcVector<item_t>*>(pContainer);
+            const auto pThis = reinterpret_cast<const GcVector<OuterType, InnerType, Allocator>*>(pContainer);
 
             // Iterate over items.
             for (const auto& pGcPtr : pThis->vData) {
@@ -501,6 +535,19 @@ namespace sgc {
         }
 
         /** Actual array that stores GcPtr items. */
-        std::vector<vec_item_t> vData;
+        vec_t vData;
     };
+
+    namespace pmr {
+        /**
+         * `GcVector` that uses `std::pmr::polymorphic_allocator` for its storage.
+         *
+         * @tparam OuterType `GcPtr`.
+         */
+        template <typename OuterType>
+        using GcVector = sgc::GcVector<
+            OuterType,
+            typename OuterType::element_type,
+            std::pmr::polymorphic_allocator<GcPtr<typename OuterType::element_type, false>>>;
+    }
 }
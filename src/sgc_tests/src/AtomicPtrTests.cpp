@@ -0,0 +1,281 @@
+// Standard.
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Custom.
+#include "GarbageCollector.h"
+#include "GcAtomicPtr.hpp"
+#include "GcPtr.h"
+
+// External.
+#include "catch2/catch_test_macros.hpp"
+
+TEST_CASE("atomic gc pointer loads, stores and exchanges objects") {
+    class Foo {
+    public:
+        Foo() = default;
+        explicit Foo(size_t iValue) : iValue(iValue) {}
+
+        size_t iValue = 0;
+    };
+
+    {
+        sgc::GcAtomicPtr<Foo> pAtomic;
+        REQUIRE(pAtomic.loadRaw() == nullptr);
+        REQUIRE(pAtomic.load() == nullptr);
+
+        auto pFirst = sgc::makeGc<Foo>(1);
+        pAtomic.store(pFirst, std::memory_order_release);
+        REQUIRE(pAtomic.loadRaw(std::memory_order_acquire) == pFirst.get());
+        REQUIRE(pAtomic.load() == pFirst);
+
+        // Exchange returns the previous object.
+        auto pSecond = sgc::makeGc<Foo>(2);
+        REQUIRE(pAtomic.exchange(pSecond) == pFirst);
+        REQUIRE(pAtomic.load()->iValue == 2);
+
+        // Failed compare exchange loads the referenced object.
+        auto pExpected = pFirst;
+        REQUIRE(!pAtomic.compare_exchange_strong(pExpected, sgc::makeGc<Foo>(3))); // NOLINT
+        REQUIRE(pExpected == pSecond);
+        REQUIRE(pAtomic.compare_exchange_weak(pExpected, pFirst));
+        REQUIRE(pAtomic.loadRaw() == pFirst.get());
+
+        // Compare exchange using a raw pointer.
+        auto pExpectedRaw = pSecond.get();
+        REQUIRE(!pAtomic.compare_exchange_strong(pExpectedRaw, pSecond));
+        REQUIRE(pExpectedRaw == pFirst.get());
+        REQUIRE(pAtomic.compare_exchange_strong(pExpectedRaw, nullptr));
+        REQUIRE(pAtomic.loadRaw() == nullptr);
+
+        // Atomic pointer is a root node.
+        pAtomic.store(sgc::makeGc<Foo>(4)); // NOLINT
+        pFirst = nullptr;
+        pSecond = nullptr;
+        pExpected = nullptr;
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 3);
+        REQUIRE(pAtomic.loadRaw()->iValue == 4);
+    }
+
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 1);
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
+
+TEST_CASE("atomic gc pointer is traced as a field and keeps its object in place during compaction") {
+    class Node {
+    public:
+        sgc::GcAtomicPtr<Node> pNext;
+    };
+
+    class Foo {
+    public:
+        size_t iValue = 0;
+        std::array<char, 64> vData{}; // NOLINT
+    };
+
+    {
+        // Create a cycle through atomic fields.
+        auto pFirst = sgc::makeGc<Node>();
+        auto pSecond = sgc::makeGc<Node>();
+        pFirst->pNext.store(pSecond);
+        pSecond->pNext.store(pFirst);
+
+        pSecond = nullptr;
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+        REQUIRE(pFirst->pNext.loadRaw()->pNext.loadRaw() == pFirst.get());
+    }
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 2);
+
+    sgc::GarbageCollector::get().setCompactHeap(true);
+    {
+        // Make heap pages sparse.
+        std::vector<sgc::GcPtr<Foo>> vObjects;
+        for (size_t i = 0; i < 4000; i++) { // NOLINT
+            vObjects.push_back(sgc::makeGc<Foo>());
+            vObjects.back()->iValue = i;
+        }
+        std::vector<sgc::GcPtr<Foo>> vKept;
+        std::vector<Foo*> vOldAddresses;
+        for (size_t i = 0; i < vObjects.size(); i += 100) { // NOLINT
+            vKept.push_back(vObjects[i]);
+            vOldAddresses.push_back(vObjects[i].get());
+        }
+        vObjects.clear();
+
+        // Publish every other kept object (the first one is published and then replaced).
+        std::vector<std::unique_ptr<sgc::GcAtomicPtr<Foo>>> vPublished;
+        for (size_t i = 0; i < vKept.size(); i += 2) {
+            vPublished.push_back(std::make_unique<sgc::GcAtomicPtr<Foo>>(vKept[i]));
+        }
+        vPublished[0]->store(nullptr);
+
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 4000 - vKept.size()); // NOLINT
+
+        // Published objects were not moved, others could be moved.
+        size_t iMovedCount = 0;
+        for (size_t i = 0; i < vKept.size(); i++) {
+            REQUIRE(vKept[i]->iValue == i * 100); // NOLINT
+            if (i % 2 == 0 && i != 0) {
+                REQUIRE(vPublished[i / 2]->loadRaw() == vOldAddresses[i]);
+                REQUIRE(vKept[i].get() == vOldAddresses[i]);
+            } else if (vKept[i].get() != vOldAddresses[i]) {
+                iMovedCount += 1;
+            }
+        }
+        REQUIRE(iMovedCount > 0);
+    }
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 40); // NOLINT
+    sgc::GarbageCollector::get().setCompactHeap(false);
+
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
+
+TEST_CASE("garbage cycles of atomic gc pointers are deleted") {
+    class Node {
+    public:
+        sgc::GcAtomicPtr<Node> pNext;
+        sgc::GcAtomicPtr<Node> pPrevious;
+    };
+
+    // Each destroyed node unpins its neighbors that might be already destroyed.
+    const auto createRing = [](size_t iNodeCount) {
+        auto pFirst = sgc::makeGc<Node>();
+        auto pLast = pFirst;
+        for (size_t i = 1; i < iNodeCount; i++) {
+            auto pNode = sgc::makeGc<Node>();
+            pNode->pPrevious.store(pLast);
+            pLast->pNext.store(pNode);
+            pLast = pNode;
+        }
+        pLast->pNext.store(pFirst);
+        pFirst->pPrevious.store(pLast);
+        return pFirst;
+    };
+
+    // Deleted by tracing.
+    createRing(100);                                               // NOLINT
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 100); // NOLINT
+
+    // Deleted by trial deletion.
+    sgc::GarbageCollector::get().setUseReferenceCounting(true);
+    {
+        auto pOwner = sgc::makeGc<Node>();
+        pOwner->pNext.store(createRing(100)); // NOLINT
+        pOwner->pNext.store(nullptr);
+        REQUIRE(sgc::GarbageCollector::get().collectUnreferencedCycles() == 100); // NOLINT
+        REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 1);
+    }
+    sgc::GarbageCollector::get().setUseReferenceCounting(false);
+
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 1);
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
+
+TEST_CASE("objects published using atomic gc pointer are fully visible to readers") {
+    class Snapshot {
+    public:
+        explicit Snapshot(size_t iVersion) : iVersion(iVersion), iVersionCopy(iVersion) {}
+
+        size_t iVersion = 0;
+        size_t iVersionCopy = 0;
+    };
+
+    {
+        sgc::GcAtomicPtr<Snapshot> pSnapshot(sgc::makeGc<Snapshot>(0));
+
+        // Keep published objects alive for the reader that does not use GC pointers.
+        std::vector<sgc::GcPtr<Snapshot>> vPublished;
+        std::atomic<bool> bFinished{false};
+        std::atomic<bool> bSawInconsistentObject{false};
+
+        std::thread reader([&pSnapshot, &bFinished, &bSawInconsistentObject]() {
+            size_t iLastVersion = 0;
+            while (!bFinished.load()) {
+                const auto pCurrent = pSnapshot.loadRaw(std::memory_order_acquire);
+                if (pCurrent->iVersion != pCurrent->iVersionCopy || pCurrent->iVersion < iLastVersion) {
+                    bSawInconsistentObject = true;
+                }
+                iLastVersion = pCurrent->iVersion;
+            }
+        });
+
+        for (size_t i = 1; i <= 1000; i++) { // NOLINT
+            vPublished.push_back(sgc::makeGc<Snapshot>(i));
+            pSnapshot.store(vPublished.back(), std::memory_order_release);
+        }
+        bFinished = true;
+        reader.join();
+
+        REQUIRE(!bSawInconsistentObject.load());
+
+        REQUIRE(pSnapshot.load()->iVersion == 1000); // NOLINT
+    }
+
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 1001); // NOLINT
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
+
+TEST_CASE("objects read using atomic gc pointer guards stay alive while they are replaced") {
+    class Foo {
+    public:
+        explicit Foo(size_t iValue) : iValue(iValue) {}
+
+        size_t iValue = 0;
+    };
+
+    {
+        sgc::GcAtomicPtr<Foo> pAtomic(sgc::makeGc<Foo>(1));
+
+        {
+            const auto guard = pAtomic.read(std::memory_order_acquire);
+            REQUIRE(guard->iValue == 1);
+
+            // The replaced object is kept for the reader.
+            pAtomic.store(sgc::makeGc<Foo>(2)); // NOLINT
+            pAtomic.store(sgc::makeGc<Foo>(3)); // NOLINT
+            REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+            REQUIRE(guard->iValue == 1);
+            REQUIRE(pAtomic.read()->iValue == 3);
+        }
+
+        // No readers, replaced objects are released by the next modification.
+        pAtomic.store(sgc::makeGc<Foo>(4)); // NOLINT
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 3);
+        REQUIRE(pAtomic.load(std::memory_order_acquire)->iValue == 4);
+    }
+
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 1);
+
+    {
+        // Readers that don't keep objects alive themselves.
+        sgc::GcAtomicPtr<Foo> pAtomic(sgc::makeGc<Foo>(0));
+        std::atomic<bool> bFinished{false};
+        std::atomic<bool> bSawInvalidObject{false};
+
+        std::thread reader([&pAtomic, &bFinished, &bSawInvalidObject]() {
+            while (!bFinished.load()) {
+                const auto guard = pAtomic.read(std::memory_order_acquire);
+                const auto iValue = guard->iValue;
+                sgc::GarbageCollector::get().collectGarbage();
+                if (guard->iValue != iValue) {
+                    bSawInvalidObject = true;
+                }
+            }
+        });
+
+        for (size_t i = 1; i <= 200; i++) { // NOLINT
+            pAtomic.store(sgc::makeGc<Foo>(i));
+        }
+        bFinished = true;
+        reader.join();
+
+        REQUIRE(!bSawInvalidObject.load());
+        REQUIRE(pAtomic.read()->iValue == 200); // NOLINT
+    }
+
+    sgc::GarbageCollector::get().collectGarbage();
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
@@ -0,0 +1,59 @@
+// Custom.
+#include "GarbageCollector.h"
+#include "GcPtr.h"
+#include "EnableGcFromThis.hpp"
+
+// External.
+#include "catch2/catch_test_macros.hpp"
+
+namespace {
+    class Part : public sgc::EnableGcFromThis<Part> {
+    public:
+        size_t iValue = 0;
+    };
+
+    class Other {
+    public:
+        virtual ~Other() = default;
+
+        size_t iOtherValue = 0;
+    };
+
+    class Self : public Other, public sgc::EnableGcFromThis<Self> {
+    public:
+        Self() { pSelfInConstructor = gcFromThis(); }
+
+        sgc::GcPtr<Self> pSelfInConstructor;
+
+        Part part;
+    };
+}
+
+TEST_CASE("objects create GC pointers to themselves") {
+    {
+        sgc::GcPtr<Self> pKept;
+        {
+            const auto pSelf = sgc::makeGc<Self>();
+
+            // Pointers created in the constructor and later point to the object.
+            REQUIRE(pSelf->pSelfInConstructor == pSelf);
+            REQUIRE(pSelf->gcFromThis() == pSelf);
+
+            // Objects that are fields of GC objects point inside of the outer object.
+            const auto pPart = pSelf->part.gcFromThis();
+            REQUIRE(pPart.get() == &pSelf->part);
+            pPart->iValue = 1;
+            REQUIRE(pSelf->part.iValue == 1);
+
+            pKept = pSelf->gcFromThis();
+        }
+
+        // Created pointers keep the object alive.
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+        REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 1);
+        REQUIRE(pKept->gcFromThis() == pKept);
+    }
+
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 1);
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
@@ -0,0 +1,114 @@
+// Standard.
+#include <memory>
+
+// Custom.
+#include "GarbageCollector.h"
+#include "GcRegion.h"
+#include "GcPtr.h"
+#include "gccontainers/GcVector.hpp"
+
+// External.
+#include "catch2/catch_test_macros.hpp"
+
+TEST_CASE("objects of a region are deleted when the region ends") {
+    class Node {
+    public:
+        Node() = delete;
+        explicit Node(size_t* pAliveCount) : pAliveCount(pAliveCount) { *pAliveCount += 1; }
+        ~Node() { *pAliveCount -= 1; }
+
+        sgc::GcPtr<Node> pNext;
+        sgc::GcVector<sgc::GcPtr<Node>> vChildren;
+
+    private:
+        size_t* pAliveCount = nullptr;
+    };
+
+    size_t iAliveCount = 0;
+
+    {
+        sgc::GcRegion region;
+        REQUIRE(&sgc::GarbageCollector::get() == &region.getGarbageCollector());
+        REQUIRE(
+            region.getGarbageCollector().getSharedGarbageCollector() == &sgc::GarbageCollector::getDefault());
+
+        // Create some scratch graph with cycles.
+        auto pRoot = sgc::makeGc<Node>(&iAliveCount);
+        for (size_t i = 0; i < 100; i++) { // NOLINT
+            auto pChild = sgc::makeGc<Node>(&iAliveCount);
+            pChild->pNext = pRoot;
+            pRoot->vChildren.push_back(pChild);
+        }
+
+        REQUIRE(iAliveCount == 101);
+        REQUIRE(region.getGarbageCollector().getAliveAllocationCount() == 101);
+        REQUIRE(sgc::GarbageCollector::getDefault().getAliveAllocationCount() == 0);
+    }
+    REQUIRE(&sgc::GarbageCollector::get() == &sgc::GarbageCollector::getDefault());
+
+    REQUIRE(iAliveCount == 0);
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
+
+TEST_CASE("objects that escape from a region survive the region") {
+    class Node {
+    public:
+        int iValue = 0;
+        sgc::GcPtr<Node> pNext;
+        sgc::GcVector<sgc::GcPtr<Node>> vChildren;
+    };
+
+    sgc::GcPtr<Node> pStored;
+    auto pOwner = sgc::makeGc<Node>();
+    std::unique_ptr<sgc::GcPtr<Node>> pOutliving;
+    std::unique_ptr<sgc::GcVector<sgc::GcPtr<Node>>> pOutlivingVector;
+
+    {
+        sgc::GcRegion region;
+
+        for (int i = 0; i < 10; i++) { // NOLINT
+            // Garbage.
+            sgc::makeGc<Node>()->pNext = sgc::makeGc<Node>();
+        }
+
+        // Stored in a pointer of the parent garbage collector.
+        pStored = sgc::makeGc<Node>();
+        pStored->iValue = 1;
+        pStored->pNext = sgc::makeGc<Node>();
+        pStored->pNext->iValue = 2;
+
+        // Stored in a container of a parent object.
+        pOwner->vChildren.push_back(sgc::makeGc<Node>());
+        pOwner->vChildren[0]->iValue = 3;
+
+        // Referenced by GC nodes that outlive the region.
+        pOutliving = std::make_unique<sgc::GcPtr<Node>>(sgc::makeGc<Node>());
+        (*pOutliving)->iValue = 4;
+        (*pOutliving)->pNext = pOwner;
+        pOutlivingVector = std::make_unique<sgc::GcVector<sgc::GcPtr<Node>>>();
+        pOutlivingVector->push_back(sgc::makeGc<Node>());
+        (*pOutlivingVector)[0]->iValue = 5;
+
+        REQUIRE(sgc::GarbageCollector::getDefault().getAliveAllocationCount() == 4);
+    }
+
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 6);
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+
+    REQUIRE(pStored->iValue == 1);
+    REQUIRE(pStored->pNext->iValue == 2);
+    REQUIRE(pOwner->vChildren[0]->iValue == 3);
+    REQUIRE((*pOutliving)->iValue == 4);
+    REQUIRE((*pOutliving)->pNext == pOwner);
+    REQUIRE(pOutliving->getGarbageCollector() == &sgc::GarbageCollector::getDefault());
+    REQUIRE((*pOutlivingVector)[0]->iValue == 5);
+    REQUIRE(pOutlivingVector->getGarbageCollector() == &sgc::GarbageCollector::getDefault());
+
+    pStored = nullptr;
+    pOwner = nullptr;
+    pOutliving = nullptr;
+    pOutlivingVector = nullptr;
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 6);
+
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
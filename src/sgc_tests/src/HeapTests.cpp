@@ -0,0 +1,463 @@
+// Standard.
+#include <array>
+#include <memory_resource>
+#include <vector>
+
+// Custom.
+#include "GarbageCollector.h"
+#include "GcPtr.h"
+#include "gccontainers/GcVector.hpp"
+
+// External.
+#include "catch2/catch_test_macros.hpp"
+
+TEST_CASE("large objects get their own mapping that is freed right after collection") {
+    class LargeObject {
+    public:
+        std::array<char, 128 * 1024> vData{}; // NOLINT: bigger than the default threshold
+        sgc::GcPtr<LargeObject> pOther;
+    };
+
+    class SmallObject {
+    public:
+        int iValue = 0;
+    };
+
+    REQUIRE(sgc::GarbageCollector::get().getLargeObjectSpaceSize() == 0);
+
+    {
+        auto pLarge1 = sgc::makeGc<LargeObject>();
+        auto pLarge2 = sgc::makeGc<LargeObject>();
+        const auto pSmall = sgc::makeGc<SmallObject>();
+
+        // Only large objects use the large object space.
+        const auto iLargeObjectSpaceSize = sgc::GarbageCollector::get().getLargeObjectSpaceSize();
+        REQUIRE(iLargeObjectSpaceSize >= 2 * sizeof(LargeObject));
+
+        // Make sure the memory is usable.
+        pLarge1->vData.back() = 1;
+        pLarge2->vData.front() = 2;
+        REQUIRE(pLarge1->vData.front() == 0);
+
+        // Raw pointers to large objects are still recognized.
+        sgc::GcPtr<LargeObject> pSameLarge = pLarge1.get();
+        REQUIRE(pSameLarge == pLarge1);
+
+        // Create a cycle.
+        pLarge1->pOther = pLarge2;
+        pLarge2->pOther = pLarge1;
+
+        pLarge2 = nullptr;
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+        REQUIRE(sgc::GarbageCollector::get().getLargeObjectSpaceSize() == iLargeObjectSpaceSize);
+    }
+
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 3);
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+    REQUIRE(sgc::GarbageCollector::get().getLargeObjectSpaceSize() == 0);
+}
+
+TEST_CASE("large object threshold can be changed") {
+    class Foo {
+    public:
+        std::array<char, 1024> vData{}; // NOLINT
+    };
+
+    const auto iInitialThreshold = sgc::GarbageCollector::get().getLargeObjectThreshold();
+
+    {
+        const auto pBefore = sgc::makeGc<Foo>();
+        REQUIRE(sgc::GarbageCollector::get().getLargeObjectSpaceSize() == 0);
+
+        sgc::GarbageCollector::get().setLargeObjectThreshold(sizeof(Foo));
+
+        const auto pAfter = sgc::makeGc<Foo>();
+        REQUIRE(sgc::GarbageCollector::get().getLargeObjectSpaceSize() >= sizeof(Foo));
+
+        sgc::GarbageCollector::get().setLargeObjectThreshold(iInitialThreshold);
+    }
+
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 2);
+    REQUIRE(sgc::GarbageCollector::get().getLargeObjectSpaceSize() == 0);
+}
+
+TEST_CASE("empty heap pages are returned to the OS according to the decommit policy") {
+    class Foo {
+    public:
+        std::array<char, 64> vData{}; // NOLINT
+        sgc::GcPtr<Foo> pNext;
+    };
+
+    const auto initialPolicy = sgc::GarbageCollector::get().getHeapDecommitPolicy();
+
+    // Prepare a lambda to allocate a linked list that occupies a few heap pages.
+    const auto allocateList = []() {
+        sgc::GcPtr<Foo> pFirst = sgc::makeGc<Foo>();
+        for (size_t i = 0; i < 4000; i++) { // NOLINT
+            auto pNew = sgc::makeGc<Foo>();
+            pNew->pNext = pFirst;
+            pFirst = pNew;
+        }
+        return pFirst;
+    };
+
+    // Return everything.
+    sgc::GcDecommitPolicy policy;
+    policy.iDecommitDelay = 0;
+    policy.iRetainedEmptyPageCount = 0;
+    sgc::GarbageCollector::get().setHeapDecommitPolicy(policy);
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+    REQUIRE(sgc::GarbageCollector::get().getCommittedHeapSize() == 0);
+
+    {
+        auto pList = allocateList();
+        REQUIRE(sgc::GarbageCollector::get().getCommittedHeapSize() >= 4000 * sizeof(Foo)); // NOLINT
+
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+        REQUIRE(sgc::GarbageCollector::get().getCommittedHeapSize() >= 4000 * sizeof(Foo)); // NOLINT
+    }
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 4001); // NOLINT
+    REQUIRE(sgc::GarbageCollector::get().getCommittedHeapSize() == 0);
+
+    // Now wait for 2 collections.
+    policy.iDecommitDelay = 2;
+    sgc::GarbageCollector::get().setHeapDecommitPolicy(policy);
+    allocateList();
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 4001); // NOLINT
+    const auto iCommittedSize = sgc::GarbageCollector::get().getCommittedHeapSize();
+    REQUIRE(iCommittedSize > 0);
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+    REQUIRE(sgc::GarbageCollector::get().getCommittedHeapSize() == iCommittedSize);
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+    REQUIRE(sgc::GarbageCollector::get().getCommittedHeapSize() == 0);
+
+    // Now keep some empty pages.
+    policy.iDecommitDelay = 0;
+    policy.iRetainedEmptyPageCount = 2;
+    sgc::GarbageCollector::get().setHeapDecommitPolicy(policy);
+    {
+        auto pList = allocateList();
+        REQUIRE(sgc::GarbageCollector::get().getCommittedHeapSize() > 2 * 64 * 1024); // NOLINT: page size
+
+        // Make sure decommitted pages are usable again.
+        pList->vData.fill(1);
+        REQUIRE(pList->pNext->vData[0] == 0);
+    }
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 4001); // NOLINT
+    REQUIRE(sgc::GarbageCollector::get().getCommittedHeapSize() == 2 * 64 * 1024); // NOLINT: page size
+
+    sgc::GarbageCollector::get().setHeapDecommitPolicy(initialPolicy);
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
+
+TEST_CASE("heap backed by huge pages only returns whole regions to the OS") {
+    class Foo {
+    public:
+        std::array<char, 64> vData{}; // NOLINT
+        sgc::GcPtr<Foo> pNext;
+    };
+
+    const auto initialPolicy = sgc::GarbageCollector::get().getHeapDecommitPolicy();
+
+    // Return everything.
+    sgc::GcDecommitPolicy policy;
+    policy.iDecommitDelay = 0;
+    policy.iRetainedEmptyPageCount = 0;
+    sgc::GarbageCollector::get().setHeapDecommitPolicy(policy);
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+    REQUIRE(sgc::GarbageCollector::get().getCommittedHeapSize() == 0);
+
+    // Huge pages might be unavailable, in this case regular pages are used.
+    const auto bUsingHugePages = sgc::GarbageCollector::get().setUseHugePagesForHeap(true);
+    REQUIRE(sgc::GarbageCollector::get().isHeapUsingHugePages() == bUsingHugePages);
+
+    {
+        // Keep one object alive while other pages of the region become empty.
+        auto pFirst = sgc::makeGc<Foo>();
+        {
+            sgc::GcPtr<Foo> pList = sgc::makeGc<Foo>();
+            for (size_t i = 0; i < 4000; i++) { // NOLINT
+                auto pNew = sgc::makeGc<Foo>();
+                pNew->pNext = pList;
+                pList = pNew;
+            }
+        }
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 4001); // NOLINT
+
+        if (bUsingHugePages) {
+            REQUIRE(sgc::GarbageCollector::get().getCommittedHeapSize() > 64 * 1024); // NOLINT: page size
+        } else {
+            REQUIRE(sgc::GarbageCollector::get().getCommittedHeapSize() == 64 * 1024); // NOLINT: page size
+        }
+
+        // Make sure the heap is still usable.
+        pFirst->pNext = sgc::makeGc<Foo>();
+        pFirst->pNext->vData.fill(1);
+    }
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 2);
+    REQUIRE(sgc::GarbageCollector::get().getCommittedHeapSize() == 0);
+
+    REQUIRE_FALSE(sgc::GarbageCollector::get().setUseHugePagesForHeap(false));
+    REQUIRE_FALSE(sgc::GarbageCollector::get().isHeapUsingHugePages());
+
+    sgc::GarbageCollector::get().setHeapDecommitPolicy(initialPolicy);
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
+
+TEST_CASE("gc objects are allocated from the specified memory resource") {
+    class CountingMemoryResource : public std::pmr::memory_resource {
+    public:
+        size_t iAllocatedSize = 0;
+        size_t iAllocationCount = 0;
+
+    private:
+        void* do_allocate(size_t iSizeInBytes, size_t iAlignment) override {
+            iAllocatedSize += iSizeInBytes;
+            iAllocationCount += 1;
+            return std::pmr::new_delete_resource()->allocate(iSizeInBytes, iAlignment);
+        }
+
+        void do_deallocate(void* pMemory, size_t iSizeInBytes, size_t iAlignment) override {
+            iAllocatedSize -= iSizeInBytes;
+            std::pmr::new_delete_resource()->deallocate(pMemory, iSizeInBytes, iAlignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    class alignas(64) Foo { // NOLINT
+    public:
+        std::array<char, 100> vData{}; // NOLINT
+        sgc::GcPtr<Foo> pNext;
+    };
+
+    CountingMemoryResource memoryResource;
+    REQUIRE(sgc::GarbageCollector::get().getMemoryResource() == nullptr);
+
+    {
+        // Allocate an object using default memory sources.
+        auto pFirst = sgc::makeGc<Foo>();
+
+        // Now use the memory resource.
+        sgc::GarbageCollector::get().setMemoryResource(&memoryResource);
+        REQUIRE(sgc::GarbageCollector::get().getMemoryResource() == &memoryResource);
+
+        pFirst->pNext = sgc::makeGc<Foo>();
+        pFirst->pNext->pNext = sgc::makeGc<Foo>();
+        REQUIRE(memoryResource.iAllocationCount == 2);
+        REQUIRE(memoryResource.iAllocatedSize >= 2 * sizeof(Foo));
+        REQUIRE(reinterpret_cast<uintptr_t>(pFirst->pNext.get()) % alignof(Foo) == 0);
+
+        // Switch back, memory allocated from the resource should still be returned to it.
+        sgc::GarbageCollector::get().setMemoryResource(nullptr);
+        pFirst->pNext->pNext = sgc::makeGc<Foo>();
+        REQUIRE(memoryResource.iAllocationCount == 2);
+
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 1);
+        REQUIRE(memoryResource.iAllocatedSize >= sizeof(Foo));
+        REQUIRE(memoryResource.iAllocatedSize < 2 * sizeof(Foo));
+    }
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 3);
+    REQUIRE(memoryResource.iAllocatedSize == 0);
+
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
+
+TEST_CASE("heap compaction moves objects out of sparse pages except pinned ones") {
+    class Foo {
+    public:
+        size_t iValue = 0;
+        std::array<char, 64> vData{}; // NOLINT
+        sgc::GcPtr<Foo> pNext;
+        sgc::GcVector<sgc::GcPtr<Foo>> vChildren;
+    };
+
+    const auto initialPolicy = sgc::GarbageCollector::get().getHeapDecommitPolicy();
+    sgc::GcDecommitPolicy policy;
+    policy.iDecommitDelay = 0;
+    policy.iRetainedEmptyPageCount = 0;
+    sgc::GarbageCollector::get().setHeapDecommitPolicy(policy);
+
+    REQUIRE(!sgc::GarbageCollector::get().isCompactingHeap());
+    sgc::GarbageCollector::get().setCompactHeap(true);
+    REQUIRE(sgc::GarbageCollector::get().isCompactingHeap());
+
+    {
+        // Allocate objects that occupy a few heap pages.
+        std::vector<sgc::GcPtr<Foo>> vObjects;
+        for (size_t i = 0; i < 4000; i++) { // NOLINT
+            vObjects.push_back(sgc::makeGc<Foo>());
+            vObjects.back()->iValue = i;
+        }
+
+        // Keep a few objects so that pages become sparse.
+        std::vector<sgc::GcPtr<Foo>> vKept;
+        std::vector<Foo*> vOldAddresses;
+        for (size_t i = 0; i < vObjects.size(); i += 100) { // NOLINT
+            vKept.push_back(vObjects[i]);
+            vOldAddresses.push_back(vObjects[i].get());
+        }
+        vObjects.clear();
+
+        // Link kept objects together.
+        for (size_t i = 1; i < vKept.size(); i++) {
+            vKept[i - 1]->pNext = vKept[i];
+            vKept[i - 1]->vChildren.push_back(vKept[i]);
+        }
+
+        // Allocate new objects to fill some space in the last page.
+        auto pFresh = sgc::makeGc<Foo>();
+        pFresh->iValue = 12345; // NOLINT
+        pFresh->pNext = vKept[0];
+
+        sgc::GcPin<Foo> pin(vKept[1]);
+        const auto iCommittedSizeBefore = sgc::GarbageCollector::get().getCommittedHeapSize();
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 4000 - vKept.size()); // NOLINT
+
+        // Pinned object was not moved, others were.
+        REQUIRE(pin.get() == vOldAddresses[1]);
+        REQUIRE(pin->iValue == 100); // NOLINT
+        size_t iMovedCount = 0;
+        for (size_t i = 0; i < vKept.size(); i++) {
+            if (vKept[i].get() != vOldAddresses[i]) {
+                iMovedCount += 1;
+            }
+        }
+        REQUIRE(iMovedCount > 0);
+        REQUIRE(sgc::GarbageCollector::get().getCommittedHeapSize() < iCommittedSizeBefore);
+
+        // References are still valid.
+        REQUIRE(pFresh->iValue == 12345); // NOLINT
+        REQUIRE(pFresh->pNext == vKept[0]);
+        for (size_t i = 0; i < vKept.size(); i++) {
+            REQUIRE(vKept[i]->iValue == i * 100); // NOLINT
+            if (i + 1 < vKept.size()) {
+                REQUIRE(vKept[i]->pNext == vKept[i + 1]);
+                REQUIRE(vKept[i]->vChildren.size() == 1);
+                REQUIRE(vKept[i]->vChildren[0] == vKept[i + 1]);
+            }
+        }
+
+        // Moved objects are still traced.
+        vKept.resize(1);
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+        REQUIRE(vKept[0]->pNext->pNext->iValue == 200); // NOLINT
+    }
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 41); // NOLINT
+
+    sgc::GarbageCollector::get().setCompactHeap(false);
+    sgc::GarbageCollector::get().setHeapDecommitPolicy(initialPolicy);
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
+
+TEST_CASE("nursery blocks are freed as a whole and reuse memory of deleted objects") {
+    class Foo {
+    public:
+        size_t iValue = 0;
+        std::array<char, 40> vData{}; // NOLINT
+        sgc::GcPtr<Foo> pNext;
+    };
+
+    constexpr size_t iBlockSize = 64 * 1024; // NOLINT: nursery block size
+
+    const auto iCommittedHeapSize = sgc::GarbageCollector::get().getCommittedHeapSize();
+    REQUIRE(!sgc::GarbageCollector::get().isUsingNursery());
+    REQUIRE(sgc::GarbageCollector::get().getNurserySize() == 0);
+
+    sgc::GarbageCollector::get().setUseNursery(true);
+    REQUIRE(sgc::GarbageCollector::get().isUsingNursery());
+
+    // Prepare a lambda to allocate a linked list that occupies a few nursery blocks.
+    const auto allocateList = [](size_t iCount) {
+        sgc::GcPtr<Foo> pFirst;
+        for (size_t i = 0; i < iCount; i++) {
+            auto pNew = sgc::makeGc<Foo>();
+            pNew->iValue = iCount - i - 1;
+            pNew->pNext = pFirst;
+            pFirst = pNew;
+        }
+        return pFirst;
+    };
+
+    {
+        auto pList = allocateList(4000); // NOLINT
+        REQUIRE(sgc::GarbageCollector::get().getNurserySize() > 2 * iBlockSize);
+        REQUIRE(sgc::GarbageCollector::get().getCommittedHeapSize() == iCommittedHeapSize);
+    }
+
+    // Only the current block is kept.
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 4000); // NOLINT
+    REQUIRE(sgc::GarbageCollector::get().getNurserySize() == iBlockSize);
+
+    {
+        // Keep every 10th object so that all blocks survive.
+        auto pList = allocateList(4000); // NOLINT
+        for (auto pCurrent = pList; pCurrent != nullptr; pCurrent = pCurrent->pNext) {
+            auto pSkipped = pCurrent;
+            for (size_t i = 0; i < 10 && pSkipped != nullptr; i++) { // NOLINT
+                pSkipped = pSkipped->pNext;
+            }
+            pCurrent->pNext = pSkipped;
+        }
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 3600); // NOLINT
+        const auto iNurserySize = sgc::GarbageCollector::get().getNurserySize();
+
+        // New objects use memory of deleted objects.
+        auto pOtherList = allocateList(3000); // NOLINT
+        REQUIRE(sgc::GarbageCollector::get().getNurserySize() == iNurserySize);
+
+        size_t iExpectedValue = 0;
+        for (auto pCurrent = pList; pCurrent != nullptr; pCurrent = pCurrent->pNext) {
+            REQUIRE(pCurrent->iValue == iExpectedValue);
+            iExpectedValue += 10; // NOLINT
+        }
+        REQUIRE(iExpectedValue == 4000); // NOLINT
+        REQUIRE(pOtherList->pNext->iValue == 1);
+    }
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 3400); // NOLINT
+    REQUIRE(sgc::GarbageCollector::get().getNurserySize() == iBlockSize);
+
+    // New objects use the heap again.
+    sgc::GarbageCollector::get().setUseNursery(false);
+    sgc::makeGc<Foo>();
+    REQUIRE(sgc::GarbageCollector::get().getNurserySize() == iBlockSize);
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 1);
+
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
+
+TEST_CASE("raw pointers to nursery objects are resolved") {
+    class Foo {
+    public:
+        size_t iValue = 0;
+    };
+
+    sgc::GarbageCollector::get().setUseNursery(true);
+
+    {
+        // Objects in the nursery are found using the page table.
+        std::vector<sgc::GcPtr<Foo>> vObjects;
+        std::vector<Foo*> vRawObjects;
+        for (size_t i = 0; i < 100; i++) { // NOLINT
+            auto pObject = sgc::makeGc<Foo>();
+            pObject->iValue = i;
+            vRawObjects.push_back(pObject.get());
+        }
+        for (const auto& pRawObject : vRawObjects) {
+            vObjects.push_back(pRawObject);
+        }
+
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+        for (size_t i = 0; i < vObjects.size(); i++) {
+            REQUIRE(vObjects[i].get() == vRawObjects[i]);
+            REQUIRE(vObjects[i]->iValue == i);
+        }
+    }
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 100); // NOLINT
+
+    sgc::GarbageCollector::get().setUseNursery(false);
+
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
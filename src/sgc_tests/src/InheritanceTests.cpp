@@ -1,3 +1,8 @@
+// Standard.
+#include <array>
+#include <memory_resource>
+#include <vector>
+
 // Custom.
 #include "GarbageCollector.h"
 #include "GcPtr.h"
@@ -225,3 +230,129 @@ TEST_CASE("sub gc ptr field offsets are correct") {
     REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 2);
     REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
 }
+
+TEST_CASE("pointers to non-primary parents of objects are resolved") {
+    class Parent1 {
+    public:
+        virtual ~Parent1() = default;
+
+        size_t iParent1Value = 1;
+    };
+
+    class Parent2 {
+    public:
+        virtual ~Parent2() = default;
+
+        size_t iParent2Value = 2;
+    };
+
+    class MultiChild : public Parent1, public Parent2 {
+    public:
+        virtual ~MultiChild() override = default;
+    };
+
+    class LargeMultiChild : public Parent1, public Parent2 {
+    public:
+        virtual ~LargeMultiChild() override = default;
+
+        std::array<char, 128 * 1024> vData{}; // NOLINT: placed into the large object space
+    };
+
+    {
+        sgc::GcPtr<Parent2> pParent2;
+        sgc::GcPtr<Parent2> pLargeParent2;
+        {
+            const auto pMultiChild = sgc::makeGc<MultiChild>();
+            const auto pLargeMultiChild = sgc::makeGc<LargeMultiChild>();
+
+            // Cast to the second parent (the pointer is not the start of the object).
+            pParent2 = pMultiChild;
+            REQUIRE(static_cast<void*>(pParent2.get()) != static_cast<void*>(pMultiChild.get()));
+            REQUIRE(pParent2.get() == static_cast<Parent2*>(pMultiChild.get()));
+            REQUIRE(pParent2->iParent2Value == 2);
+
+            // Cross cast from the first parent.
+            sgc::GcPtr<Parent1> pParent1 = pLargeMultiChild;
+            pLargeParent2 = dynamic_cast<Parent2*>(pParent1.get());
+            REQUIRE(pLargeParent2.get() == static_cast<Parent2*>(pLargeMultiChild.get()));
+            REQUIRE(pLargeParent2->iParent2Value == 2);
+        }
+
+        // Copies and moves keep pointing to the same parent.
+        auto pCopy = pParent2;
+        REQUIRE(pCopy == pParent2);
+        auto pMoved = std::move(pCopy);
+        REQUIRE(pMoved == pParent2);
+        REQUIRE(pMoved->iParent2Value == 2);
+
+        // Pointers to parents keep objects alive.
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+        REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 2);
+        REQUIRE(pLargeParent2->iParent2Value == 2);
+    }
+
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 2);
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
+
+TEST_CASE("pointers to non-primary parents of objects outside of gc heaps are resolved") {
+    class Parent1 {
+    public:
+        virtual ~Parent1() = default;
+
+        size_t iParent1Value = 1;
+    };
+
+    class Parent2 {
+    public:
+        virtual ~Parent2() = default;
+
+        size_t iParent2Value = 2;
+    };
+
+    class SmallChild : public Parent1, public Parent2 {};
+
+    class MultiPageChild : public Parent1, public Parent2 {
+    public:
+        std::array<char, 20 * 1024> vData{}; // NOLINT: not in the heap but below the large object threshold
+        size_t iChildValue = 3;
+    };
+
+    const auto checkParents = [](size_t iObjectCount) {
+        // Create objects next to each other and point to their second parents using raw pointers (the
+        // objects are found by an address inside of them).
+        std::vector<sgc::GcPtr<SmallChild>> vChildren;
+        std::vector<sgc::GcPtr<Parent2>> vParents;
+        for (size_t i = 0; i < iObjectCount; i++) {
+            vChildren.push_back(sgc::makeGc<SmallChild>());
+            vChildren.back()->iParent2Value = i;
+            vParents.push_back(static_cast<Parent2*>(vChildren.back().get()));
+        }
+        sgc::GcPtr<Parent2> pMultiPageParent2 = static_cast<Parent2*>(sgc::makeGc<MultiPageChild>().get());
+        vChildren.clear();
+
+        // Pointers to parents keep objects alive.
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+        for (size_t i = 0; i < iObjectCount; i++) {
+            REQUIRE(vParents[i]->iParent2Value == i);
+        }
+        REQUIRE(dynamic_cast<MultiPageChild*>(pMultiPageParent2.get())->iChildValue == 3);
+    };
+
+    // Nursery blocks.
+    sgc::GarbageCollector::get().setUseNursery(true);
+    checkParents(1000); // NOLINT
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 1001);
+    sgc::GarbageCollector::get().setUseNursery(false);
+
+    // Densely packed objects of a memory resource.
+    {
+        std::pmr::monotonic_buffer_resource memoryResource;
+        sgc::GarbageCollector::get().setMemoryResource(&memoryResource);
+        checkParents(1000); // NOLINT
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 1001);
+        sgc::GarbageCollector::get().setMemoryResource(nullptr);
+    }
+
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
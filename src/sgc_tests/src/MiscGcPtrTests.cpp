@@ -1,5 +1,7 @@
 // Standard.
 #include <functional>
+#include <array>
+#include <atomic>
 
 // Custom.
 #include "GarbageCollector.h"
@@ -67,6 +69,37 @@ TEST_CASE("passed construction arguments to make gc are passed to type construct
     REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
 }
 
+TEST_CASE("gc allocations respect alignment of the type") {
+    struct alignas(64) CacheLineCounter { // NOLINT: cache line size
+        std::atomic<size_t> iCounter{0};
+    };
+
+    struct DoubleValue {
+        char cSomeValue = 0;
+        double value = 0.0;
+    };
+
+    {
+        std::vector<sgc::GcPtr<CacheLineCounter>> vCounters;
+        for (size_t i = 0; i < 8; i++) { // NOLINT
+            vCounters.push_back(sgc::makeGc<CacheLineCounter>());
+            REQUIRE(reinterpret_cast<uintptr_t>(vCounters.back().get()) % alignof(CacheLineCounter) == 0);
+
+            vCounters.back()->iCounter.fetch_add(1);
+        }
+
+        const auto pDouble = sgc::makeGc<DoubleValue>();
+        REQUIRE(reinterpret_cast<uintptr_t>(pDouble.get()) % alignof(DoubleValue) == 0);
+
+        // Constructing a GC pointer from a raw pointer to an aligned object still works.
+        sgc::GcPtr<CacheLineCounter> pSameCounter = vCounters[0].get();
+        REQUIRE(pSameCounter == vCounters[0]);
+    }
+
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 9); // NOLINT
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
+
 TEST_CASE("gc allocations are destroyed only while collecting garbage") {
     class Foo {};
 
@@ -921,3 +954,134 @@ TEST_CASE("benchmark garbage collection") {
     };
     REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
 }
+
+TEST_CASE("gc pointers reference allocations correctly when allocation slots are reused") {
+#if defined(SGC_COMPRESSED_REFERENCES)
+    static_assert(sizeof(sgc::GcAllocationRef) == sizeof(uint32_t));
+#else
+    static_assert(sizeof(sgc::GcAllocationRef) == sizeof(void*));
+#endif
+
+    class Node {
+    public:
+        size_t iValue = 0;
+        sgc::GcPtr<Node> pNext;
+    };
+
+    {
+        sgc::GcPtr<Node> pHead;
+        for (size_t iRound = 0; iRound < 3; iRound++) {
+            // Create a list (memory of allocations from the previous round is reused).
+            for (size_t i = 0; i < 1000; i++) { // NOLINT
+                auto pNode = sgc::makeGc<Node>();
+                pNode->iValue = i;
+                pNode->pNext = pHead;
+                pHead = pNode;
+            }
+
+            // Check the list.
+            size_t iNodeCount = 0;
+            for (auto pNode = pHead; pNode != nullptr; pNode = pNode->pNext) {
+                REQUIRE(pNode->iValue == 999 - iNodeCount); // NOLINT
+                iNodeCount += 1;
+            }
+            REQUIRE(iNodeCount == 1000);
+
+            pHead = nullptr;
+            REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 1000);
+        }
+    }
+
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
+
+TEST_CASE("compressed references make gc pointers and gc vector items smaller") {
+    // Without compressed references the allocation reference takes a full pointer.
+    constexpr size_t iUncompressedGcPtrSize = 2 * sizeof(void*) + 8; // NOLINT
+#if defined(SGC_COMPRESSED_REFERENCES)
+    static_assert(sizeof(sgc::GcPtrBase) == iUncompressedGcPtrSize - 8); // NOLINT
+#else
+    static_assert(sizeof(sgc::GcPtrBase) == iUncompressedGcPtrSize);
+#endif
+#if defined(DEBUG)
+    constexpr size_t iDebugFieldSize = sizeof(void*);
+#else
+    constexpr size_t iDebugFieldSize = 0;
+#endif
+    static_assert(
+        sizeof(sgc::GcVector<sgc::GcPtr<int>>::vec_item_t) == sizeof(sgc::GcPtrBase) + iDebugFieldSize);
+
+    class Padding {
+    public:
+        std::array<char, 60 * 1024> vData{}; // NOLINT: close to the limit of compressed references
+    };
+
+    class Parent {
+    public:
+        size_t iValue = 2;
+    };
+
+    class Child : public Padding, public Parent {};
+
+    {
+        // Interior pointers up to 64 KB from the start of the object are supported in both modes.
+        sgc::GcPtr<Parent> pParent;
+        {
+            const auto pChild = sgc::makeGc<Child>();
+            pParent = pChild;
+            REQUIRE(
+                reinterpret_cast<char*>(pParent.get()) - reinterpret_cast<char*>(pChild.get()) >=
+                static_cast<ptrdiff_t>(sizeof(Padding)));
+        }
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+        REQUIRE(pParent->iValue == 2);
+    }
+
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 1);
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
+
+TEST_CASE("gc fields of small and big types are found using field bitmaps and offset arrays") {
+    class Collected {};
+
+    class Small {
+    public:
+        sgc::GcPtr<Collected> pFirst;
+        int iValue = 0;
+        sgc::GcVector<sgc::GcPtr<Collected>> vItems;
+        sgc::GcPtr<Collected> pSecond;
+    };
+
+    class Big {
+    public:
+        std::array<sgc::GcPtr<Collected>, 300> vPointers; // NOLINT: bigger than inline bitmaps
+    };
+
+    // Make sure no GC object exists.
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+
+    {
+        auto pSmall = sgc::makeGc<Small>();
+        pSmall->pFirst = sgc::makeGc<Collected>();
+        pSmall->pSecond = sgc::makeGc<Collected>();
+        pSmall->vItems.push_back(sgc::makeGc<Collected>());
+
+        auto pBig = sgc::makeGc<Big>();
+        pBig->vPointers.front() = sgc::makeGc<Collected>();
+        pBig->vPointers.back() = sgc::makeGc<Collected>();
+
+        REQUIRE(sgc::GcTypeInfo::getStaticInfo<Small>()->isUsingFieldBitmap());
+        REQUIRE(!sgc::GcTypeInfo::getStaticInfo<Big>()->isUsingFieldBitmap());
+
+        REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 7);
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+
+        pSmall->pSecond = nullptr;
+        pBig->vPointers.back() = nullptr;
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 2);
+        REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 5);
+    }
+
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 5);
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
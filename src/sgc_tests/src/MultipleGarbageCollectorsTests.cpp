@@ -0,0 +1,186 @@
+// Standard.
+#include <thread>
+#include <array>
+
+// Custom.
+#include "GarbageCollector.h"
+#include "GcPtr.h"
+#include "gccontainers/GcVector.hpp"
+
+// External.
+#include "catch2/catch_test_macros.hpp"
+
+TEST_CASE("objects of a separate garbage collector are collected independently") {
+    class Foo {
+    public:
+        sgc::GcPtr<Foo> pNext;
+    };
+
+    sgc::GarbageCollector garbageCollector;
+    REQUIRE(&sgc::GarbageCollector::get() == &sgc::GarbageCollector::getDefault());
+
+    {
+        sgc::GcScope scope(garbageCollector);
+        REQUIRE(&sgc::GarbageCollector::get() == &garbageCollector);
+
+        // Create a cycle.
+        auto pFirst = sgc::makeGc<Foo>();
+        pFirst->pNext = sgc::makeGc<Foo>();
+        pFirst->pNext->pNext = pFirst;
+        REQUIRE(pFirst.getGarbageCollector() == &garbageCollector);
+        REQUIRE(pFirst->pNext.getGarbageCollector() == &garbageCollector);
+
+        REQUIRE(garbageCollector.getAliveAllocationCount() == 2);
+        REQUIRE(sgc::GarbageCollector::getDefault().getAliveAllocationCount() == 0);
+
+        // Collecting the default garbage collector does not affect this heap.
+        REQUIRE(sgc::GarbageCollector::getDefault().collectGarbage() == 0);
+        REQUIRE(garbageCollector.collectGarbage() == 0);
+        REQUIRE(garbageCollector.getRootNodes().second->gcPtrRootNodes.size() == 1);
+        REQUIRE(sgc::GarbageCollector::getDefault().getRootNodes().second->gcPtrRootNodes.empty());
+    }
+    REQUIRE(&sgc::GarbageCollector::get() == &sgc::GarbageCollector::getDefault());
+
+    REQUIRE(garbageCollector.collectGarbage() == 2);
+    REQUIRE(garbageCollector.getAliveAllocationCount() == 0);
+
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
+
+TEST_CASE("makeGcIn allocates objects and container items in the specified garbage collector") {
+    class Item {
+    public:
+        int iValue = 0;
+    };
+
+    class Owner {
+    public:
+        Owner() { pItem = sgc::makeGc<Item>(); }
+
+        sgc::GcPtr<Item> pItem;
+        sgc::GcVector<sgc::GcPtr<Item>> vItems;
+    };
+
+    sgc::GarbageCollector garbageCollector;
+
+    {
+        // Not bound to the thread.
+        auto pOwner = sgc::makeGcIn<Owner>(garbageCollector);
+        REQUIRE(pOwner.getGarbageCollector() == &garbageCollector);
+        REQUIRE(pOwner->vItems.getGarbageCollector() == &garbageCollector);
+        REQUIRE(garbageCollector.getAliveAllocationCount() == 2);
+
+        // New items belong to the container's garbage collector.
+        pOwner->vItems.push_back(sgc::makeGcIn<Item>(garbageCollector));
+        pOwner->vItems.resize(3);
+        pOwner->vItems[2] = sgc::makeGcIn<Item>(garbageCollector);
+        pOwner->vItems[2]->iValue = 2;
+        for (const auto& pItem : pOwner->vItems) {
+            REQUIRE(pItem.getGarbageCollector() == &garbageCollector);
+        }
+
+        REQUIRE(garbageCollector.collectGarbage() == 0);
+        REQUIRE(garbageCollector.getAliveAllocationCount() == 4);
+        REQUIRE(pOwner->vItems[2]->iValue == 2);
+
+        pOwner->vItems.pop_back();
+        REQUIRE(garbageCollector.collectGarbage() == 1);
+    }
+    REQUIRE(garbageCollector.collectGarbage() == 3);
+
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
+
+TEST_CASE("separate garbage collectors allocate and collect in parallel") {
+    class Foo {
+    public:
+        std::array<char, 32> vData{}; // NOLINT
+        sgc::GcPtr<Foo> pNext;
+    };
+
+    constexpr size_t iThreadCount = 4;
+    constexpr size_t iObjectCount = 1000;
+
+    std::array<sgc::GarbageCollector, iThreadCount> vGarbageCollectors;
+    std::array<size_t, iThreadCount> vCollectedCounts{};
+
+    {
+        std::array<std::thread, iThreadCount> vThreads;
+        for (size_t i = 0; i < iThreadCount; i++) {
+            vThreads[i] = std::thread([&, i]() {
+                sgc::GcScope scope(vGarbageCollectors[i]);
+
+                for (size_t iIteration = 0; iIteration < 10; iIteration++) { // NOLINT
+                    {
+                        auto pFirst = sgc::makeGc<Foo>();
+                        for (size_t iObject = 1; iObject < iObjectCount; iObject++) {
+                            auto pNew = sgc::makeGc<Foo>();
+                            pNew->pNext = pFirst;
+                            pFirst = pNew;
+                        }
+                    }
+                    vCollectedCounts[i] += sgc::GarbageCollector::get().collectGarbage();
+                }
+            });
+        }
+
+        for (auto& thread : vThreads) {
+            thread.join();
+        }
+    }
+
+    for (size_t i = 0; i < iThreadCount; i++) {
+        REQUIRE(vCollectedCounts[i] == 10 * iObjectCount); // NOLINT
+        REQUIRE(vGarbageCollectors[i].getAliveAllocationCount() == 0);
+    }
+
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
+
+TEST_CASE("GC pointers created inside of GC objects and containers use the owner's garbage collector") {
+    class Item {
+    public:
+        int iValue = 0;
+    };
+
+    class Holder {
+    public:
+        Holder() = default;
+        Holder(const sgc::GcPtr<Item>& pItem) : pItem(pItem) {} // NOLINT
+
+        sgc::GcPtr<Item> pItem;
+        sgc::GcVector<sgc::GcPtr<Item>> vItems;
+    };
+
+    sgc::GarbageCollector firstGarbageCollector;
+    sgc::GarbageCollector secondGarbageCollector;
+
+    {
+        auto pHolder = sgc::makeGcIn<Holder>(firstGarbageCollector);
+        const auto pFirstItem = sgc::makeGcIn<Item>(firstGarbageCollector);
+        const auto pSecondItem = sgc::makeGcIn<Item>(secondGarbageCollector);
+
+        // Items referencing an object of a different garbage collector are not allowed.
+        REQUIRE_THROWS_AS(pHolder->vItems.emplace_back(pSecondItem), std::runtime_error);
+        REQUIRE(pHolder->vItems.empty());
+
+        // Fields too.
+        REQUIRE_THROWS_AS(sgc::makeGcIn<Holder>(firstGarbageCollector, pSecondItem), std::runtime_error);
+
+        pHolder->vItems.push_back(pFirstItem);
+        pHolder->vItems.push_back(pFirstItem);
+        for (const auto& pItem : pHolder->vItems) {
+            REQUIRE(pItem.getGarbageCollector() == &firstGarbageCollector);
+        }
+
+        const auto pOtherHolder = sgc::makeGcIn<Holder>(firstGarbageCollector, pFirstItem);
+        REQUIRE(pOtherHolder->pItem.getGarbageCollector() == &firstGarbageCollector);
+
+        REQUIRE(firstGarbageCollector.collectGarbage() == 1); // failed holder
+        REQUIRE(secondGarbageCollector.collectGarbage() == 0);
+    }
+    REQUIRE(firstGarbageCollector.collectGarbage() == 3);
+    REQUIRE(secondGarbageCollector.collectGarbage() == 1);
+
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
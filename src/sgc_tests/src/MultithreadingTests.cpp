@@ -8,6 +8,8 @@
 #include "GarbageCollector.h"
 #include "GcPtr.h"
 #include "gccontainers/GcVector.hpp"
+#include "gccontainers/GcBTreeMap.hpp"
+#include "gccontainers/GcSlotMap.hpp"
 #include "ThreadPool.h"
 #include "DebugLogger.hpp"
 
@@ -70,6 +72,8 @@ TEST_CASE("allocate GC objects and collect garbage from multiple threads") {
                     iAdditionTasksInProgress.fetch_add(1);
 
                     sgc::GcVector<sgc::GcPtr<Foo>> vSomeFoos;
+                    sgc::GcBTreeMap<size_t, sgc::GcPtr<Foo>> someFoosByIndex;
+                    sgc::GcSlotMap<sgc::GcPtr<Foo>> someFooSlots;
 
                     taskStarted.test_and_set();
 
@@ -83,10 +87,15 @@ TEST_CASE("allocate GC objects and collect garbage from multiple threads") {
                             reinterpret_cast<uintptr_t>(&pFoo)));
 
                         vSomeFoos.push_back(pFoo); // NOLINT
+                        someFoosByIndex.insert_or_assign(vSomeFoos.size(), pFoo);
+                        someFooSlots.erase(someFooSlots.insert(pFoo));
+                        someFooSlots.insert(pFoo);
 
                         SGC_DEBUG_LOG("task iteration finished");
                     }
                     vSomeFoos.clear();
+                    someFoosByIndex.clear();
+                    someFooSlots.clear();
 
                     iAdditionTasksInProgress.fetch_sub(1);
                 });
@@ -0,0 +1,188 @@
+// Custom.
+#include "GarbageCollector.h"
+#include "GcPtr.h"
+#include "gccontainers/GcVector.hpp"
+
+// External.
+#include "catch2/catch_test_macros.hpp"
+
+TEST_CASE("reference counting deletes unreferenced objects without garbage collection") {
+    class Node {
+    public:
+        Node() = delete;
+        explicit Node(size_t* pAliveCount) : pAliveCount(pAliveCount) { *pAliveCount += 1; }
+        ~Node() { *pAliveCount -= 1; }
+
+        sgc::GcPtr<Node> pNext;
+        sgc::GcVector<sgc::GcPtr<Node>> vChildren;
+
+    private:
+        size_t* pAliveCount = nullptr;
+    };
+
+    size_t iAliveCount = 0;
+
+    REQUIRE(!sgc::GarbageCollector::get().isUsingReferenceCounting());
+    sgc::GarbageCollector::get().setUseReferenceCounting(true);
+    REQUIRE(sgc::GarbageCollector::get().isUsingReferenceCounting());
+
+    {
+        // Create a list.
+        auto pFirst = sgc::makeGc<Node>(&iAliveCount);
+        auto pLast = pFirst;
+        for (size_t i = 0; i < 99; i++) { // NOLINT
+            pLast->pNext = sgc::makeGc<Node>(&iAliveCount);
+            pLast = pLast->pNext;
+        }
+        pLast = nullptr;
+        REQUIRE(iAliveCount == 100);
+
+        // All objects are referenced.
+        REQUIRE(sgc::GarbageCollector::get().collectUnreferencedObjects() == 0);
+
+        // Cut the list in half.
+        auto pMiddle = pFirst;
+        for (size_t i = 0; i < 49; i++) { // NOLINT
+            pMiddle = pMiddle->pNext;
+        }
+        pMiddle->pNext = nullptr;
+        REQUIRE(sgc::GarbageCollector::get().collectUnreferencedObjects() == 50); // NOLINT
+        REQUIRE(iAliveCount == 50);
+
+        // Objects referenced by root nodes only are kept.
+        pFirst = nullptr;
+        REQUIRE(sgc::GarbageCollector::get().collectUnreferencedObjects() == 49); // NOLINT
+        REQUIRE(iAliveCount == 1);
+        REQUIRE(pMiddle->pNext == nullptr);
+    }
+    REQUIRE(sgc::GarbageCollector::get().collectUnreferencedObjects() == 1);
+    REQUIRE(iAliveCount == 0);
+
+    {
+        // Items of GC containers are counted.
+        auto pParent = sgc::makeGc<Node>(&iAliveCount);
+        for (size_t i = 0; i < 10; i++) { // NOLINT
+            pParent->vChildren.push_back(sgc::makeGc<Node>(&iAliveCount));
+        }
+        REQUIRE(sgc::GarbageCollector::get().collectUnreferencedObjects() == 0);
+
+        pParent->vChildren.erase(pParent->vChildren.begin(), pParent->vChildren.begin() + 5);
+        REQUIRE(sgc::GarbageCollector::get().collectUnreferencedObjects() == 5);
+
+        // Counts stay valid after garbage collection.
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+        pParent->vChildren.clear();
+        REQUIRE(sgc::GarbageCollector::get().collectUnreferencedObjects() == 5);
+        REQUIRE(iAliveCount == 1);
+    }
+
+    {
+        // Cycles are left to the garbage collection.
+        auto pFirst = sgc::makeGc<Node>(&iAliveCount);
+        pFirst->pNext = sgc::makeGc<Node>(&iAliveCount);
+        pFirst->pNext->pNext = pFirst;
+    }
+    REQUIRE(sgc::GarbageCollector::get().collectUnreferencedObjects() == 1);
+    REQUIRE(iAliveCount == 2);
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 2);
+    REQUIRE(iAliveCount == 0);
+
+    // Temporary objects are deleted while new objects are created.
+    for (size_t i = 0; i < 10000; i++) { // NOLINT
+        sgc::makeGc<Node>(&iAliveCount)->pNext = sgc::makeGc<Node>(&iAliveCount);
+        REQUIRE(iAliveCount <= 1024); // NOLINT
+    }
+
+    sgc::GarbageCollector::get().setUseReferenceCounting(false);
+    REQUIRE(sgc::GarbageCollector::get().collectUnreferencedObjects() == 0);
+    sgc::GarbageCollector::get().collectGarbage();
+    REQUIRE(iAliveCount == 0);
+
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
+
+TEST_CASE("trial deletion deletes garbage cycles reachable from objects that lost a reference") {
+    class Node {
+    public:
+        Node() = delete;
+        explicit Node(size_t* pAliveCount) : pAliveCount(pAliveCount) { *pAliveCount += 1; }
+        ~Node() { *pAliveCount -= 1; }
+
+        sgc::GcPtr<Node> pNext;
+        sgc::GcVector<sgc::GcPtr<Node>> vChildren;
+
+    private:
+        size_t* pAliveCount = nullptr;
+    };
+
+    size_t iAliveCount = 0;
+    sgc::GarbageCollector::get().setUseReferenceCounting(true);
+
+    // Prepare a lambda to create a cycle of 3 objects.
+    const auto createCycle = [&iAliveCount]() {
+        auto pFirst = sgc::makeGc<Node>(&iAliveCount);
+        pFirst->pNext = sgc::makeGc<Node>(&iAliveCount);
+        pFirst->pNext->vChildren.push_back(sgc::makeGc<Node>(&iAliveCount));
+        pFirst->pNext->vChildren[0]->pNext = pFirst;
+        return pFirst;
+    };
+
+    {
+        // Create a big list that should not be touched.
+        auto pList = sgc::makeGc<Node>(&iAliveCount);
+        for (size_t i = 0; i < 999; i++) { // NOLINT
+            auto pNew = sgc::makeGc<Node>(&iAliveCount);
+            pNew->pNext = pList;
+            pList = pNew;
+        }
+
+        auto pParent = sgc::makeGc<Node>(&iAliveCount);
+        auto pOtherParent = sgc::makeGc<Node>(&iAliveCount);
+        pParent->pNext = createCycle();
+        pParent->pNext->pNext->pNext = pList; // cycle references the list
+        REQUIRE(sgc::GarbageCollector::get().collectUnreferencedObjects() == 0);
+        REQUIRE(iAliveCount == 1005); // NOLINT
+
+        // Cycle is referenced by another object.
+        pOtherParent->pNext = pParent->pNext;
+        pParent->pNext = nullptr;
+        REQUIRE(sgc::GarbageCollector::get().collectUnreferencedCycles() == 0);
+
+        // Cycle is referenced by a root node.
+        {
+            sgc::GcPtr<Node> pCycleObject = pOtherParent->pNext->pNext;
+            pOtherParent->pNext = nullptr;
+            REQUIRE(sgc::GarbageCollector::get().collectUnreferencedCycles() == 0);
+            REQUIRE(iAliveCount == 1005); // NOLINT
+
+            pParent->pNext = pCycleObject;
+        }
+
+        // Now it's garbage.
+        pParent->pNext = nullptr;
+        REQUIRE(sgc::GarbageCollector::get().collectUnreferencedCycles() == 3);
+        REQUIRE(iAliveCount == 1002); // NOLINT
+
+        // The list lost a reference from the cycle.
+        pList = nullptr;
+        REQUIRE(sgc::GarbageCollector::get().collectUnreferencedObjects() == 1000); // NOLINT
+        REQUIRE(iAliveCount == 2);
+    }
+    REQUIRE(sgc::GarbageCollector::get().collectUnreferencedObjects() == 2);
+    REQUIRE(iAliveCount == 0);
+
+    {
+        // Cycles are deleted while new objects are created.
+        auto pParent = sgc::makeGc<Node>(&iAliveCount);
+        for (size_t i = 0; i < 5000; i++) { // NOLINT
+            pParent->pNext = createCycle();
+            REQUIRE(iAliveCount <= 4000); // NOLINT
+        }
+    }
+
+    sgc::GarbageCollector::get().setUseReferenceCounting(false);
+    sgc::GarbageCollector::get().collectGarbage();
+    REQUIRE(iAliveCount == 0);
+
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
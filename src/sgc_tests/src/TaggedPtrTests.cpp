@@ -0,0 +1,125 @@
+// Standard.
+#include <utility>
+#include <vector>
+
+// Custom.
+#include "GarbageCollector.h"
+#include "GcTaggedPtr.hpp"
+#include "GcPtr.h"
+
+// External.
+#include "catch2/catch_test_macros.hpp"
+
+TEST_CASE("tagged gc pointer stores a tag independent of the referenced object") {
+    class Foo {
+    public:
+        Foo() = default;
+        explicit Foo(size_t iValue) : iValue(iValue) {}
+
+        size_t iValue = 0;
+    };
+
+    using TaggedFoo = sgc::GcTaggedPtr<Foo, sgc::GcAllocationRef::iTagBitCount>;
+    static_assert(sizeof(TaggedFoo) == sizeof(sgc::GcPtr<Foo>), "tag should not increase the size");
+
+    {
+        TaggedFoo pTagged;
+        REQUIRE(pTagged == nullptr);
+        REQUIRE(pTagged.getTag() == 0);
+
+        // Tag of an empty pointer.
+        pTagged.setTag(1);
+        REQUIRE(pTagged == nullptr);
+        REQUIRE(pTagged.getTag() == 1);
+
+        // Assigning an object keeps the tag.
+        auto pFoo = sgc::makeGc<Foo>(1);
+        pTagged = pFoo;
+        REQUIRE(pTagged == pFoo);
+        REQUIRE(pTagged->iValue == 1);
+        REQUIRE(pTagged.getTag() == 1);
+
+        // Tag does not affect the referenced object.
+        pTagged.setTag(TaggedFoo::iMaxTag);
+        REQUIRE(pTagged.getTag() == TaggedFoo::iMaxTag);
+        REQUIRE(pTagged.get() == pFoo.get());
+        pTagged.setTag(TaggedFoo::iMaxTag + 2);
+        REQUIRE(pTagged.getTag() == 1);
+
+        // GC pointers created from tagged pointers have no tag.
+        const sgc::GcPtr<Foo> pCopy = pTagged;
+        REQUIRE(pCopy == pFoo);
+        REQUIRE(TaggedFoo(pCopy).getTag() == 0);
+
+        // Copy and move tagged pointers with their tag.
+        TaggedFoo pTaggedCopy = pTagged;
+        REQUIRE(pTaggedCopy == pFoo);
+        REQUIRE(pTaggedCopy.getTag() == 1);
+        TaggedFoo pTaggedMoved = std::move(pTaggedCopy);
+        REQUIRE(pTaggedMoved.getTag() == 1);
+        REQUIRE(pTaggedCopy == nullptr); // NOLINT: test moved from state
+        REQUIRE(pTaggedCopy.getTag() == 0);
+
+        TaggedFoo pAssigned(sgc::makeGc<Foo>(2), 2);
+        REQUIRE(pAssigned->iValue == 2);
+        REQUIRE(pAssigned.getTag() == 2);
+        pAssigned = pTaggedMoved;
+        REQUIRE(pAssigned == pFoo);
+        REQUIRE(pAssigned.getTag() == 1);
+        pAssigned = nullptr;
+        REQUIRE(pAssigned == nullptr);
+        REQUIRE(pAssigned.getTag() == 1);
+
+        // Tag of a pointer created from a raw pointer.
+        TaggedFoo pFromRaw(pFoo.get(), 2);
+        REQUIRE(pFromRaw == pFoo);
+        REQUIRE(pFromRaw.getTag() == 2);
+    }
+
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 2);
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
+
+TEST_CASE("garbage collector follows tagged gc pointers") {
+    class Node {
+    public:
+        size_t iValue = 0;
+        sgc::GcTaggedPtr<Node, 1> pLeft;
+        sgc::GcTaggedPtr<Node, 1> pRight;
+    };
+
+    {
+        // Build a tree where only tagged pointers reference nodes.
+        sgc::GcTaggedPtr<Node, 1> pRoot(sgc::makeGc<Node>(), 1);
+        std::vector<Node*> vNodes{pRoot.get()};
+        for (size_t i = 1; i < 100; i++) { // NOLINT
+            const auto pParent = vNodes[(i - 1) / 2];
+            auto& pChild = i % 2 == 1 ? pParent->pLeft : pParent->pRight;
+            pChild = sgc::makeGc<Node>();
+            pChild.setTag(i % 3 == 0 ? 1 : 0);
+            pChild->iValue = i;
+            vNodes.push_back(pChild.get());
+        }
+
+        // Create a cycle.
+        vNodes.back()->pLeft = pRoot;
+        vNodes.back()->pLeft.setTag(1);
+
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+        for (size_t i = 1; i < vNodes.size(); i++) {
+            const auto& pChild = i % 2 == 1 ? vNodes[(i - 1) / 2]->pLeft : vNodes[(i - 1) / 2]->pRight;
+            REQUIRE(pChild->iValue == i);
+            REQUIRE(pChild.getTag() == (i % 3 == 0 ? 1 : 0));
+        }
+
+        // Detach a subtree.
+        pRoot->pRight = nullptr;
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() > 0);
+        REQUIRE(pRoot.getTag() == 1);
+        REQUIRE(pRoot->pRight.getTag() == 0);
+        REQUIRE(pRoot->pLeft->iValue == 1);
+    }
+
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() > 0);
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
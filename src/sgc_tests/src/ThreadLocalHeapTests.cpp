@@ -0,0 +1,215 @@
+// Standard.
+#include <thread>
+#include <future>
+
+// Custom.
+#include "GarbageCollector.h"
+#include "GcPtr.h"
+#include "gccontainers/GcVector.hpp"
+
+// External.
+#include "catch2/catch_test_macros.hpp"
+
+namespace {
+    class Node {
+    public:
+        int iValue = 0;
+        sgc::GcPtr<Node> pNext;
+        sgc::GcVector<sgc::GcPtr<Node>> vChildren;
+    };
+}
+
+TEST_CASE("thread-local objects are collected without touching the shared garbage collector") {
+    sgc::GarbageCollector sharedGarbageCollector;
+    {
+        sgc::GarbageCollector threadLocalGarbageCollector(sharedGarbageCollector);
+        REQUIRE(threadLocalGarbageCollector.getSharedGarbageCollector() == &sharedGarbageCollector);
+        REQUIRE(sharedGarbageCollector.getSharedGarbageCollector() == nullptr);
+
+        auto pShared = sgc::makeGcIn<Node>(sharedGarbageCollector);
+
+        {
+            sgc::GcScope scope(threadLocalGarbageCollector);
+
+            // Thread-local objects can reference shared objects.
+            auto pLocal = sgc::makeGc<Node>();
+            pLocal->pNext = pShared;
+            pShared = nullptr;
+            sgc::makeGc<Node>(); // garbage
+
+            REQUIRE(threadLocalGarbageCollector.getAliveAllocationCount() == 2);
+            REQUIRE(threadLocalGarbageCollector.collectGarbage() == 1);
+
+            // The shared object is only referenced from a thread-local object.
+            REQUIRE(sharedGarbageCollector.collectGarbage() == 0);
+            REQUIRE(sharedGarbageCollector.getAliveAllocationCount() == 1);
+            REQUIRE(threadLocalGarbageCollector.getAliveAllocationCount() == 1);
+
+            pLocal->pNext = nullptr;
+            REQUIRE(threadLocalGarbageCollector.collectGarbage() == 0);
+            REQUIRE(sharedGarbageCollector.collectGarbage() == 1);
+        }
+
+        REQUIRE(threadLocalGarbageCollector.collectGarbage() == 1);
+    }
+
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
+
+TEST_CASE("thread-local objects are promoted when stored in a shared object") {
+    sgc::GarbageCollector sharedGarbageCollector;
+    {
+        sgc::GarbageCollector threadLocalGarbageCollector(sharedGarbageCollector);
+
+        auto pShared = sgc::makeGcIn<Node>(sharedGarbageCollector);
+
+        {
+            sgc::GcScope scope(threadLocalGarbageCollector);
+
+            // Create a thread-local chain.
+            auto pLocal = sgc::makeGc<Node>();
+            pLocal->iValue = 1;
+            pLocal->pNext = sgc::makeGc<Node>();
+            pLocal->pNext->iValue = 2;
+            pLocal->vChildren.push_back(sgc::makeGc<Node>());
+            pLocal->vChildren[0]->iValue = 3;
+            REQUIRE(threadLocalGarbageCollector.getAliveAllocationCount() == 3);
+
+            // Escape.
+            pShared->pNext = pLocal;
+
+            // The whole chain now belongs to the shared garbage collector.
+            REQUIRE(threadLocalGarbageCollector.getAliveAllocationCount() == 0);
+            REQUIRE(sharedGarbageCollector.getAliveAllocationCount() == 4);
+            REQUIRE(pShared->pNext->pNext.getGarbageCollector() == &sharedGarbageCollector);
+            REQUIRE(pShared->pNext->vChildren.getGarbageCollector() == &sharedGarbageCollector);
+            REQUIRE(pShared->pNext->vChildren[0].getGarbageCollector() == &sharedGarbageCollector);
+            REQUIRE(pShared->pNext->pNext->iValue == 2);
+            REQUIRE(pShared->pNext->vChildren[0]->iValue == 3);
+
+            // Promoted objects are not collected by the thread-local garbage collector.
+            pLocal = nullptr;
+            REQUIRE(threadLocalGarbageCollector.collectGarbage() == 0);
+            REQUIRE(sharedGarbageCollector.collectGarbage() == 0);
+            REQUIRE(pShared->pNext->iValue == 1);
+
+            // Objects added to a shared container are promoted too.
+            pShared->vChildren.push_back(sgc::makeGc<Node>());
+            REQUIRE(pShared->vChildren[0].getGarbageCollector() == &sharedGarbageCollector);
+            REQUIRE(threadLocalGarbageCollector.getAliveAllocationCount() == 0);
+            REQUIRE(sharedGarbageCollector.getAliveAllocationCount() == 5);
+        }
+
+        pShared->pNext = nullptr;
+        REQUIRE(sharedGarbageCollector.collectGarbage() == 3);
+
+        pShared = nullptr;
+        REQUIRE(sharedGarbageCollector.collectGarbage() == 2);
+    }
+
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
+
+TEST_CASE("objects of a thread-local garbage collector outlive their thread once promoted") {
+    auto pShared = sgc::makeGc<Node>();
+
+    std::thread thread([&pShared]() {
+        auto& threadLocalGarbageCollector = sgc::GarbageCollector::getThreadLocal();
+        REQUIRE(threadLocalGarbageCollector.getSharedGarbageCollector() == &sgc::GarbageCollector::get());
+
+        sgc::GcScope scope(threadLocalGarbageCollector);
+        for (int i = 0; i < 100; i++) { // NOLINT
+            auto pLocal = sgc::makeGc<Node>();
+            pLocal->iValue = i;
+            if (i % 2 == 0) {
+                pShared->vChildren.push_back(pLocal);
+            }
+        }
+
+        REQUIRE(threadLocalGarbageCollector.getAliveAllocationCount() == 50); // NOLINT
+        REQUIRE(threadLocalGarbageCollector.collectGarbage() == 50);          // NOLINT
+    });
+    thread.join();
+
+    // Objects of the exited thread are still alive.
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+    REQUIRE(pShared->vChildren.size() == 50); // NOLINT
+    for (size_t i = 0; i < pShared->vChildren.size(); i++) {
+        REQUIRE(pShared->vChildren[i]->iValue == static_cast<int>(i * 2));
+    }
+
+    pShared = nullptr;
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 51); // NOLINT
+
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
+
+TEST_CASE("thread-local objects are promoted when a GC pointer to them is passed to another thread") {
+    std::promise<sgc::GcPtr<Node>> objectPromise;
+    std::promise<void> copiedPromise;
+    auto objectFuture = objectPromise.get_future();
+
+    std::thread thread([&objectPromise, copiedFuture = copiedPromise.get_future()]() {
+        sgc::GcScope scope(sgc::GarbageCollector::getThreadLocal());
+
+        auto pLocal = sgc::makeGc<Node>();
+        pLocal->iValue = 1;
+        pLocal->pNext = sgc::makeGc<Node>();
+        pLocal->pNext->iValue = 2;
+        objectPromise.set_value(pLocal);
+
+        // Wait for the other thread to receive the object.
+        copiedFuture.wait();
+        REQUIRE(pLocal.getGarbageCollector() == &sgc::GarbageCollector::getThreadLocal());
+        REQUIRE(sgc::GarbageCollector::getThreadLocal().getAliveAllocationCount() == 0);
+    });
+
+    // The thread is still running.
+    auto pReceived = objectFuture.get();
+    REQUIRE(pReceived.getGarbageCollector() == &sgc::GarbageCollector::get());
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 2);
+    copiedPromise.set_value();
+    thread.join();
+
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+    REQUIRE(pReceived->iValue == 1);
+    REQUIRE(pReceived->pNext->iValue == 2);
+
+    pReceived = nullptr;
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 2);
+
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
+
+TEST_CASE("thread-local objects that are alive when their thread exits are promoted") {
+    std::promise<sgc::GcPtr<Node>> objectPromise;
+    auto objectFuture = objectPromise.get_future();
+
+    std::thread thread([&objectPromise]() {
+        sgc::GcScope scope(sgc::GarbageCollector::getThreadLocal());
+
+        auto pLocal = sgc::makeGc<Node>();
+        pLocal->iValue = 1;
+        pLocal->vChildren.push_back(sgc::makeGc<Node>());
+        pLocal->vChildren[0]->iValue = 2;
+        objectPromise.set_value(std::move(pLocal));
+
+        // Garbage.
+        sgc::makeGc<Node>();
+    });
+    thread.join();
+
+    // The pointer stored in the promise was moved to the shared garbage collector.
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 2);
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+
+    auto pReceived = objectFuture.get();
+    REQUIRE(pReceived.getGarbageCollector() == &sgc::GarbageCollector::get());
+    REQUIRE(pReceived->iValue == 1);
+    REQUIRE(pReceived->vChildren[0]->iValue == 2);
+
+    pReceived = nullptr;
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 2);
+
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
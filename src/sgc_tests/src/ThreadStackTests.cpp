@@ -0,0 +1,200 @@
+// Standard.
+#include <array>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+// Custom.
+#include "GarbageCollector.h"
+#include "GcPtr.h"
+#include "GcThreadStack.h"
+
+// External.
+#include "catch2/catch_test_macros.hpp"
+
+TEST_CASE("GC pointers on a registered thread stack are found by scanning the stack") {
+    class Node {
+    public:
+        Node() = delete;
+        explicit Node(size_t* pAliveCount) : pAliveCount(pAliveCount) { *pAliveCount += 1; }
+        ~Node() { *pAliveCount -= 1; }
+
+        sgc::GcPtr<Node> pNext;
+
+    private:
+        size_t* pAliveCount = nullptr;
+    };
+
+    size_t iAliveCount = 0;
+
+    const auto getRootGcPtrCount = []() {
+        const auto [pMutex, pRootNodes] = sgc::GarbageCollector::get().getRootNodes();
+        std::scoped_lock guard(*pMutex);
+        return pRootNodes->gcPtrRootNodes.size();
+    };
+    const auto iInitialRootGcPtrCount = getRootGcPtrCount();
+
+    {
+        sgc::GcThreadStack threadStack;
+
+        {
+            // Nested registration does nothing.
+            sgc::GcThreadStack nestedThreadStack;
+        }
+
+        auto pFirst = sgc::makeGc<Node>(&iAliveCount);
+        pFirst->pNext = sgc::makeGc<Node>(&iAliveCount);
+        REQUIRE(getRootGcPtrCount() == iInitialRootGcPtrCount);
+
+        // Objects referenced from the stack are kept.
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+        REQUIRE(iAliveCount == 2);
+        REQUIRE(pFirst->pNext != nullptr);
+
+        // GC pointers that are not on the stack are still registered.
+        std::vector<sgc::GcPtr<Node>> vNodes = {pFirst->pNext};
+        REQUIRE(getRootGcPtrCount() == iInitialRootGcPtrCount + 1);
+        pFirst = nullptr;
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 1);
+        REQUIRE(iAliveCount == 1);
+
+        vNodes.clear();
+        REQUIRE(getRootGcPtrCount() == iInitialRootGcPtrCount);
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 1);
+        REQUIRE(iAliveCount == 0);
+    }
+
+    // Stacks of other threads are scanned too.
+    std::atomic<size_t> iStep{0};
+    std::thread thread([&]() {
+        sgc::GcThreadStack threadStack;
+        {
+            auto pNode = sgc::makeGc<Node>(&iAliveCount);
+            iStep = 1;
+            while (iStep != 2) {
+                std::this_thread::yield();
+            }
+        }
+        iStep = 3;
+        while (iStep != 4) {
+            std::this_thread::yield();
+        }
+    });
+
+    while (iStep != 1) {
+        std::this_thread::yield();
+    }
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+    REQUIRE(iAliveCount == 1);
+
+    iStep = 2;
+    while (iStep != 3) {
+        std::this_thread::yield();
+    }
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 1);
+    REQUIRE(iAliveCount == 0);
+
+    iStep = 4;
+    thread.join();
+
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
+
+TEST_CASE("GC pointers on a registered thread stack are cleared without waiting for the garbage collector") {
+    class Node {
+    public:
+        size_t iValue = 0;
+    };
+
+    std::atomic<size_t> iStep{0};
+    std::thread thread([&iStep]() {
+        sgc::GcThreadStack threadStack;
+        {
+            auto pNode = sgc::makeGc<Node>();
+            sgc::GcPtr<Node> pEmpty;
+            auto pOther = pNode;
+            iStep = 1;
+            while (iStep != 2) {
+                std::this_thread::yield();
+            }
+
+            // Clear pointers while the garbage collector's mutex is locked by another thread.
+            pOther = pEmpty;
+            pOther = nullptr;
+            pNode = std::move(pEmpty);
+        }
+        iStep = 3;
+    });
+
+    while (iStep != 1) {
+        std::this_thread::yield();
+    }
+
+    bool bClearedWhileLocked = false;
+    {
+        std::scoped_lock guard(*sgc::GarbageCollector::get().getGarbageCollectionMutex());
+        iStep = 2;
+
+        // Wait for a while (the thread would wait for the mutex if clearing required it).
+        const auto startTime = std::chrono::steady_clock::now();
+        while (iStep != 3 && std::chrono::steady_clock::now() - startTime < std::chrono::seconds(10)) {
+            std::this_thread::yield();
+        }
+        bClearedWhileLocked = iStep == 3;
+    }
+    thread.join();
+    REQUIRE(bClearedWhileLocked);
+
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 1);
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
+
+TEST_CASE("GC pointers deep in the registered stack of another thread are found by scanning the stack") {
+    class Node {
+    public:
+        size_t iValue = 0;
+    };
+
+    std::atomic<size_t> iStep{0};
+    std::thread thread([&iStep]() {
+        sgc::GcThreadStack threadStack;
+        auto pShallow = sgc::makeGc<Node>();
+        pShallow->iValue = 1;
+
+        // Create a GC pointer far below the previous one (and wait for the garbage collector there).
+        const auto recurse = [&iStep](const auto& self, size_t iDepth) -> size_t {
+            std::array<volatile char, 1024> vFrame{}; // NOLINT: make frames big
+            vFrame[0] = static_cast<char>(iDepth);
+            if (iDepth != 0) {
+                return self(self, iDepth - 1) + static_cast<size_t>(vFrame[0]);
+            }
+
+            auto pDeep = sgc::makeGc<Node>();
+            pDeep->iValue = 2;
+            iStep = 1;
+            while (iStep != 2) {
+                std::this_thread::yield();
+            }
+            return pDeep->iValue;
+        };
+        const auto iDeepValue = recurse(recurse, 64); // NOLINT
+        if (pShallow->iValue == 1 && iDeepValue == 2 + 64 * 65 / 2) { // NOLINT
+            iStep = 3;
+        }
+    });
+
+    while (iStep != 1) {
+        std::this_thread::yield();
+    }
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 2);
+
+    iStep = 2;
+    thread.join();
+    REQUIRE(iStep == 3);
+
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 2);
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
@@ -0,0 +1,99 @@
+// Standard.
+#include <vector>
+#include <unordered_map>
+
+// Custom.
+#include "GarbageCollector.h"
+#include "GcPtr.h"
+#include "GcTracingAllocator.hpp"
+
+// External.
+#include "catch2/catch_test_macros.hpp"
+
+namespace {
+    class TracedNode {
+    public:
+        using VectorAllocator = sgc::GcTracingAllocator<sgc::GcPtr<TracedNode>>;
+        using MapAllocator = sgc::GcTracingAllocator<std::pair<const size_t, sgc::GcPtr<TracedNode>>>;
+
+        TracedNode() = delete;
+        explicit TracedNode(size_t* pAliveCount) : pAliveCount(pAliveCount) { *pAliveCount += 1; }
+        ~TracedNode() { *pAliveCount -= 1; }
+
+        std::vector<sgc::GcPtr<TracedNode>, VectorAllocator> vChildren{VectorAllocator(this)};
+        std::unordered_map<
+            size_t,
+            sgc::GcPtr<TracedNode>,
+            std::hash<size_t>,
+            std::equal_to<size_t>,
+            MapAllocator>
+            namedChildren{MapAllocator(this)};
+
+    private:
+        size_t* pAliveCount = nullptr;
+    };
+}
+
+TEST_CASE("GC pointers in memory of tracing allocators are not root nodes and cycles are collected") {
+    size_t iAliveCount = 0;
+
+    const auto getRootGcPtrCount = []() {
+        const auto [pMutex, pRootNodes] = sgc::GarbageCollector::get().getRootNodes();
+        std::scoped_lock guard(*pMutex);
+        return pRootNodes->gcPtrRootNodes.size();
+    };
+
+    {
+        auto pFirst = sgc::makeGc<TracedNode>(&iAliveCount);
+        auto pSecond = sgc::makeGc<TracedNode>(&iAliveCount);
+        const auto iRootGcPtrCount = getRootGcPtrCount();
+
+        // Create cycles through standard containers.
+        for (size_t i = 0; i < 10; i++) { // NOLINT: grow the vector a few times
+            pFirst->vChildren.push_back(pSecond);
+        }
+        pFirst->namedChildren[0] = pSecond;
+        pSecond->namedChildren[1] = pFirst;
+        pSecond->vChildren.push_back(sgc::makeGc<TracedNode>(&iAliveCount));
+        REQUIRE(getRootGcPtrCount() == iRootGcPtrCount);
+
+        pSecond = nullptr;
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+        REQUIRE(iAliveCount == 3);
+        REQUIRE(pFirst->vChildren.size() == 10);
+        REQUIRE(pFirst->namedChildren[0]->vChildren.size() == 1);
+
+        // Objects only referenced by removed items are deleted.
+        pFirst->namedChildren[0]->vChildren.clear();
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 1);
+        REQUIRE(iAliveCount == 2);
+    }
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 2);
+    REQUIRE(iAliveCount == 0);
+
+    {
+        // Memory of an allocator without an owner is a root.
+        std::vector<sgc::GcPtr<TracedNode>, sgc::GcTracingAllocator<sgc::GcPtr<TracedNode>>> vRoots;
+        const auto iRootGcPtrCount = getRootGcPtrCount();
+        vRoots.push_back(sgc::makeGc<TracedNode>(&iAliveCount));
+        vRoots.back()->vChildren.push_back(sgc::makeGc<TracedNode>(&iAliveCount));
+        REQUIRE(getRootGcPtrCount() == iRootGcPtrCount);
+
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+        REQUIRE(iAliveCount == 2);
+
+        // Reference counting sees references from containers of objects.
+        sgc::GarbageCollector::get().setUseReferenceCounting(true);
+        REQUIRE(sgc::GarbageCollector::get().collectUnreferencedObjects() == 0);
+        vRoots.back()->vChildren.clear();
+        REQUIRE(sgc::GarbageCollector::get().collectUnreferencedObjects() == 1);
+        REQUIRE(iAliveCount == 1);
+        sgc::GarbageCollector::get().setUseReferenceCounting(false);
+
+        vRoots.clear();
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 1);
+        REQUIRE(iAliveCount == 0);
+    }
+
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
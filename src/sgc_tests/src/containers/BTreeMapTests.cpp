@@ -0,0 +1,182 @@
+// Standard.
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+
+// Custom.
+#include "GarbageCollector.h"
+#include "gccontainers/GcBTreeMap.hpp"
+#include "GcPtr.h"
+
+// External.
+#include "catch2/catch_test_macros.hpp"
+
+namespace {
+    class Foo {
+    public:
+        Foo() = delete;
+        explicit Foo(size_t iValue) : iValue(iValue) {}
+
+        size_t iValue = 0;
+    };
+
+    /** Map with small nodes to split and merge nodes often. */
+    using SmallNodeMap = sgc::GcBTreeMap<size_t, sgc::GcPtr<Foo>, Foo, std::less<size_t>, 4>;
+}
+
+TEST_CASE("test basic b-tree map functionality") {
+    {
+        // Empty map.
+        sgc::GcBTreeMap<std::string, sgc::GcPtr<Foo>> map;
+        REQUIRE(map.empty());
+        REQUIRE(map.size() == 0); // NOLINT: test size
+        REQUIRE(map.begin() == map.end());
+        REQUIRE(map.find("a") == map.end());
+        REQUIRE(map.erase("a") == 0);
+        REQUIRE_THROWS_AS(map.at("a"), std::out_of_range);
+
+        // Insertion does not overwrite, insert or assign does.
+        REQUIRE(map.insert("b", sgc::makeGc<Foo>(2)).second);
+        REQUIRE(!map.insert("b", sgc::makeGc<Foo>(3)).second); // NOLINT
+        REQUIRE(map.at("b")->iValue == 2);
+        REQUIRE(!map.insert_or_assign("b", sgc::makeGc<Foo>(3)).second); // NOLINT
+        REQUIRE(map.at("b")->iValue == 3);
+        map["a"] = sgc::makeGc<Foo>(1);
+        REQUIRE(map["c"] == nullptr);
+
+        REQUIRE(map.size() == 3);
+        REQUIRE(map.contains("a"));
+        REQUIRE(map.count("c") == 1);
+        REQUIRE(map.begin().key() == "a");
+        REQUIRE((*map.begin()).second->iValue == 1);
+    }
+
+    {
+        // Compare with a standard map on random operations.
+        SmallNodeMap map;
+        std::map<size_t, size_t> reference;
+        std::mt19937 generator(42); // NOLINT
+        std::uniform_int_distribution<size_t> keyDistribution(0, 300); // NOLINT
+
+        for (size_t i = 0; i < 3000; i++) { // NOLINT
+            const auto iKey = keyDistribution(generator);
+            if (generator() % 3 == 0) {
+                REQUIRE(map.erase(iKey) == reference.erase(iKey));
+            } else {
+                map.insert_or_assign(iKey, sgc::makeGc<Foo>(i));
+                reference[iKey] = i;
+            }
+            REQUIRE(map.size() == reference.size());
+        }
+
+        // Iteration is in key order.
+        auto referenceIt = reference.begin();
+        for (const auto& [iKey, pFoo] : map) {
+            REQUIRE(referenceIt != reference.end());
+            REQUIRE(iKey == referenceIt->first);
+            REQUIRE(pFoo->iValue == referenceIt->second);
+            ++referenceIt;
+        }
+        REQUIRE(referenceIt == reference.end());
+
+        // Bounds.
+        for (size_t iKey = 0; iKey <= 301; iKey++) { // NOLINT
+            const auto lowerIt = map.lower_bound(iKey);
+            const auto referenceLowerIt = reference.lower_bound(iKey);
+            REQUIRE((lowerIt == map.end()) == (referenceLowerIt == reference.end()));
+            if (lowerIt != map.end()) {
+                REQUIRE(lowerIt.key() == referenceLowerIt->first);
+            }
+
+            const auto upperIt = map.upper_bound(iKey);
+            const auto referenceUpperIt = reference.upper_bound(iKey);
+            REQUIRE((upperIt == map.end()) == (referenceUpperIt == reference.end()));
+            if (upperIt != map.end()) {
+                REQUIRE(upperIt.key() == referenceUpperIt->first);
+            }
+        }
+
+        // Copy and move.
+        SmallNodeMap copy(map);
+        REQUIRE(copy.size() == map.size());
+        REQUIRE(std::equal(copy.begin(), copy.end(), map.begin(), map.end()));
+
+        SmallNodeMap moved(std::move(copy));
+        REQUIRE(copy.empty()); // NOLINT: test moved from state
+        REQUIRE(moved.size() == map.size());
+
+        copy = moved;
+        REQUIRE(copy.size() == map.size());
+        moved = std::move(copy);
+        REQUIRE(copy.empty()); // NOLINT: test moved from state
+
+        // Erase everything using iterators.
+        auto it = moved.begin();
+        while (it != moved.end()) {
+            it = moved.erase(it);
+        }
+        REQUIRE(moved.empty());
+        REQUIRE(moved.begin() == moved.end());
+
+        map.clear();
+        REQUIRE(map.empty());
+    }
+
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() > 0);
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
+
+TEST_CASE("b-tree map values are not root nodes and erased values are collected") {
+    class Node {
+    public:
+        sgc::GcBTreeMap<size_t, sgc::GcPtr<Node>> links;
+    };
+
+    const auto getRootGcPtrCount = []() {
+        const auto [pMutex, pRootNodes] = sgc::GarbageCollector::get().getRootNodes();
+        std::scoped_lock guard(*pMutex);
+        return pRootNodes->gcPtrRootNodes.size();
+    };
+
+    // Make sure no GC object exists.
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+
+    {
+        SmallNodeMap map;
+        const auto iRootGcPtrCount = getRootGcPtrCount();
+        for (size_t i = 0; i < 100; i++) { // NOLINT
+            map[i] = sgc::makeGc<Foo>(i);
+        }
+        REQUIRE(getRootGcPtrCount() == iRootGcPtrCount);
+        REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 100);
+
+        // Only erased values are collected.
+        for (size_t i = 0; i < 100; i += 2) { // NOLINT
+            REQUIRE(map.erase(i) == 1);
+        }
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 50);
+        REQUIRE(map.at(1)->iValue == 1);
+    }
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 50);
+
+    {
+        // Cycles through maps that are fields of GC objects are collected.
+        auto pFirst = sgc::makeGc<Node>();
+        auto pSecond = sgc::makeGc<Node>();
+        pFirst->links.insert(1, pSecond);
+        pSecond->links.insert(1, pFirst);
+        pSecond->links.insert(2, pSecond);
+
+        sgc::GcBTreeMap<size_t, sgc::GcPtr<Node>> nodes;
+        nodes.insert(1, pFirst);
+
+        pFirst = nullptr;
+        pSecond = nullptr;
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+
+        nodes.clear();
+    }
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 2);
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
@@ -0,0 +1,127 @@
+// Standard.
+#include <array>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <type_traits>
+
+// Custom.
+#include "GarbageCollector.h"
+#include "gccontainers/GcFunction.hpp"
+#include "GcPtr.h"
+
+// External.
+#include "catch2/catch_test_macros.hpp"
+
+namespace {
+    class Callback {
+    public:
+        Callback() = delete;
+        explicit Callback(size_t* pAliveCount) : pAliveCount(pAliveCount) { *pAliveCount += 1; }
+        ~Callback() { *pAliveCount -= 1; }
+
+        sgc::GcFunction<size_t(size_t)> callback;
+
+    private:
+        size_t* pAliveCount = nullptr;
+    };
+}
+
+TEST_CASE("GC pointers captured by a GC function are not root nodes and cycles are collected") {
+    size_t iAliveCount = 0;
+
+    const auto getRootGcPtrCount = []() {
+        const auto [pMutex, pRootNodes] = sgc::GarbageCollector::get().getRootNodes();
+        std::scoped_lock guard(*pMutex);
+        return pRootNodes->gcPtrRootNodes.size();
+    };
+
+    {
+        auto pFirst = sgc::makeGc<Callback>(&iAliveCount);
+        auto pSecond = sgc::makeGc<Callback>(&iAliveCount);
+        const auto iRootGcPtrCount = getRootGcPtrCount();
+
+        // Capture objects that own the functions.
+        pFirst->callback = [pFirst, pSecond](size_t iValue) { return iValue + 1; };
+        pSecond->callback = [pFirst](size_t iValue) { return iValue * 2; }; // NOLINT
+        REQUIRE(getRootGcPtrCount() == iRootGcPtrCount);
+        REQUIRE(pFirst->callback(1) == 2);
+        REQUIRE(pSecond->callback(3) == 6); // NOLINT
+
+        // Copies and moves keep captures traced.
+        sgc::GcFunction<size_t(size_t)> copy = pFirst->callback;
+        auto moved = std::move(copy);
+        REQUIRE(!copy);
+        REQUIRE(moved(2) == 3);
+        moved = nullptr;
+        REQUIRE(!moved);
+        REQUIRE_THROWS_AS(moved(1), std::bad_function_call);
+
+        pSecond = nullptr;
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+        REQUIRE(iAliveCount == 2);
+    }
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 2);
+    REQUIRE(iAliveCount == 0);
+
+    {
+        // Large callables are allocated and traced too.
+        auto pNode = sgc::makeGc<Callback>(&iAliveCount);
+        std::array<size_t, 32> vPadding{}; // NOLINT: does not fit into the inline storage
+        vPadding[1] = 5;                   // NOLINT
+        pNode->callback = [vPadding, pNode](size_t iIndex) { return vPadding[iIndex]; };
+        REQUIRE(pNode->callback(1) == 5); // NOLINT
+
+        // A function that is not a field of a GC object keeps its captures alive.
+        const sgc::GcFunction<size_t(size_t)> rootFunction = pNode->callback;
+        pNode = nullptr;
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+        REQUIRE(iAliveCount == 1);
+    }
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 1);
+    REQUIRE(iAliveCount == 0);
+
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
+
+TEST_CASE("GC function traces callables of the same type that store GC pointers at different places") {
+    size_t iAliveCount = 0;
+
+    // All callables have the same type.
+    const auto createCallback = [](const std::optional<sgc::GcPtr<Callback>>& pOptional) {
+        return sgc::GcFunction<size_t(size_t)>(
+            [pOptional](size_t iValue) { return pOptional.has_value() ? iValue + 1 : iValue; });
+    };
+
+    {
+        auto pFirst = sgc::makeGc<Callback>(&iAliveCount);
+        auto pSecond = sgc::makeGc<Callback>(&iAliveCount);
+
+        // The first callable of the type has no GC pointers.
+        pFirst->callback = createCallback(std::nullopt);
+        REQUIRE(pFirst->callback(1) == 1);
+
+        // Others capture a GC pointer (create a cycle).
+        pSecond->callback = createCallback(pFirst);
+        pFirst->callback = createCallback(pSecond);
+        REQUIRE(pFirst->callback(1) == 2);
+
+        // Copies and moves keep captures traced.
+        sgc::GcFunction<size_t(size_t)> copy = pSecond->callback;
+        pSecond->callback = std::move(copy);
+        REQUIRE(pSecond->callback(1) == 2);
+
+        pSecond = nullptr;
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+        REQUIRE(iAliveCount == 2);
+    }
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 2);
+    REQUIRE(iAliveCount == 0);
+
+    // Like `std::function` only copyable callables are accepted.
+    const auto nonCopyable = [pValue = std::make_unique<size_t>(1)](size_t iValue) { return iValue; };
+    static_assert(!std::is_constructible_v<sgc::GcFunction<size_t(size_t)>, decltype(nonCopyable)>);
+    static_assert(!std::is_assignable_v<sgc::GcFunction<size_t(size_t)>&, decltype(nonCopyable)>);
+
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
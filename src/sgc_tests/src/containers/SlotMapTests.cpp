@@ -0,0 +1,127 @@
+// Standard.
+#include <utility>
+#include <vector>
+
+// Custom.
+#include "GarbageCollector.h"
+#include "gccontainers/GcSlotMap.hpp"
+#include "GcPtr.h"
+
+// External.
+#include "catch2/catch_test_macros.hpp"
+
+namespace {
+    class Foo {
+    public:
+        Foo() = delete;
+        explicit Foo(size_t iValue) : iValue(iValue) {}
+
+        size_t iValue = 0;
+    };
+}
+
+TEST_CASE("test basic slot map functionality") {
+    {
+        sgc::GcSlotMap<sgc::GcPtr<Foo>> map;
+        REQUIRE(map.empty());
+        REQUIRE(!map.contains({}));
+        REQUIRE(map.get({}) == nullptr);
+        REQUIRE_THROWS_AS(map.at({}), std::out_of_range);
+
+        // Insert items.
+        std::vector<sgc::GcSlotMap<sgc::GcPtr<Foo>>::Handle> vHandles;
+        for (size_t i = 0; i < 10; i++) { // NOLINT
+            vHandles.push_back(map.insert(sgc::makeGc<Foo>(i)));
+        }
+        REQUIRE(map.size() == 10);
+        for (size_t i = 0; i < vHandles.size(); i++) {
+            REQUIRE(map.at(vHandles[i])->iValue == i);
+        }
+
+        // Erase keeps other handles valid and items dense.
+        REQUIRE(map.erase(vHandles[2]));
+        REQUIRE(!map.erase(vHandles[2]));
+        REQUIRE(map.erase(vHandles[9])); // NOLINT: last item
+        REQUIRE(map.size() == 8);
+        REQUIRE(!map.contains(vHandles[2]));
+        for (size_t i = 0; i < vHandles.size(); i++) {
+            if (i == 2 || i == 9) { // NOLINT
+                continue;
+            }
+            REQUIRE(map.at(vHandles[i])->iValue == i);
+        }
+        for (size_t i = 0; i < map.size(); i++) {
+            REQUIRE(*map.get(map.getHandle(i)) == *(map.begin() + static_cast<std::ptrdiff_t>(i)));
+        }
+
+        // Erased slots are reused with a new generation.
+        const auto newHandle = map.insert(sgc::makeGc<Foo>(100)); // NOLINT
+        REQUIRE(newHandle.iSlot == vHandles[9].iSlot);
+        REQUIRE(newHandle != vHandles[9]);
+        REQUIRE(!map.contains(vHandles[9]));
+        REQUIRE(map.at(newHandle)->iValue == 100);
+
+        // Copy and move keep handles.
+        auto copy = map;
+        REQUIRE(copy.at(newHandle)->iValue == 100);
+        auto moved = std::move(copy);
+        REQUIRE(copy.empty()); // NOLINT: test moved from state
+        REQUIRE(!copy.contains(newHandle));
+        REQUIRE(moved.at(vHandles[0])->iValue == 0);
+
+        // Clear invalidates all handles.
+        map.clear();
+        REQUIRE(map.empty());
+        REQUIRE(!map.contains(newHandle));
+        REQUIRE(!map.contains(vHandles[0]));
+        REQUIRE(map.begin() == map.end());
+    }
+
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 11);
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
+
+TEST_CASE("slot map items are not root nodes and erased items are collected") {
+    class Entity {
+    public:
+        sgc::GcSlotMap<sgc::GcPtr<Entity>> children;
+    };
+
+    const auto getRootGcPtrCount = []() {
+        const auto [pMutex, pRootNodes] = sgc::GarbageCollector::get().getRootNodes();
+        std::scoped_lock guard(*pMutex);
+        return pRootNodes->gcPtrRootNodes.size();
+    };
+
+    // Make sure no GC object exists.
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+
+    {
+        sgc::GcSlotMap<sgc::GcPtr<Entity>> entities;
+        const auto iRootGcPtrCount = getRootGcPtrCount();
+
+        std::vector<sgc::GcSlotMap<sgc::GcPtr<Entity>>::Handle> vHandles;
+        for (size_t i = 0; i < 100; i++) { // NOLINT
+            vHandles.push_back(entities.insert(sgc::makeGc<Entity>()));
+        }
+        REQUIRE(getRootGcPtrCount() == iRootGcPtrCount);
+
+        // Create a cycle.
+        const auto pFirst = entities.at(vHandles[0]).get();
+        const auto pSecond = entities.at(vHandles[1]).get();
+        pFirst->children.insert(pSecond);
+        pSecond->children.insert(pFirst);
+
+        // Erase every other entity (including the cycle).
+        for (size_t i = 0; i < vHandles.size(); i += 2) { // NOLINT
+            REQUIRE(entities.erase(vHandles[i]));
+        }
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 49); // NOLINT: cycle is still referenced
+        REQUIRE(entities.erase(vHandles[1]));
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 2);
+        REQUIRE(entities.size() == 49); // NOLINT
+    }
+
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 49); // NOLINT
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
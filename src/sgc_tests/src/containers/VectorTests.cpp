@@ -1,5 +1,7 @@
 // Standard.
 #include <utility>
+#include <memory_resource>
+#include <array>
 
 // Custom.
 #include "GarbageCollector.h"
@@ -469,6 +471,45 @@ TEST_CASE("new vector elements are not registered as root nodes") {
     REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
 }
 
+TEST_CASE("growing gc vector keeps moved items pointing to their objects") {
+    class Foo {
+    public:
+        Foo() = delete;
+        Foo(size_t iValue) : iValue(iValue) {}
+
+        size_t iValue = 0;
+    };
+
+    {
+        sgc::GcVector<sgc::GcPtr<Foo>> vTest;
+
+        // Cause a few reallocations (items will be moved).
+        constexpr size_t iItemCount = 100;
+        for (size_t i = 0; i < iItemCount; i++) {
+            vTest.push_back(sgc::makeGc<Foo>(i));
+        }
+        vTest.reserve(vTest.capacity() * 2);
+        vTest.shrink_to_fit();
+
+        REQUIRE(vTest.size() == iItemCount);
+        for (size_t i = 0; i < iItemCount; i++) {
+            REQUIRE(vTest[i]->iValue == i);
+        }
+
+        REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == iItemCount);
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+        REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == iItemCount);
+
+        // Moved pointers are cleared.
+        sgc::GcPtr<Foo> pMoved = std::move(vTest[0]);
+        REQUIRE(vTest[0] == nullptr);
+        REQUIRE(pMoved->iValue == 0);
+    }
+
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 100); // NOLINT: item count
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}
+
 TEST_CASE("vector is non root node when used as a field in GC object") {
     {
         class Foo {
@@ -653,3 +694,43 @@ TEST_CASE("storing gc vector in pair does not cause leaks") {
     REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 1);
     REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
 }
+
+TEST_CASE("pmr gc vector stores items in the specified memory resource") {
+    class Collected {
+    public:
+        int iValue = 0;
+    };
+
+    std::array<std::byte, 1024> vBuffer{}; // NOLINT
+    std::pmr::monotonic_buffer_resource bufferResource(
+        vBuffer.data(), vBuffer.size(), std::pmr::null_memory_resource());
+
+    {
+        auto pVector = sgc::makeGc<sgc::pmr::GcVector<sgc::GcPtr<Collected>>>(&bufferResource);
+        REQUIRE(pVector->get_allocator().resource() == &bufferResource);
+
+        for (size_t i = 0; i < 8; i++) { // NOLINT
+            pVector->push_back(sgc::makeGc<Collected>());
+            pVector->back()->iValue = static_cast<int>(i);
+        }
+
+        // Items are stored in the buffer.
+        const auto iDataAddress = reinterpret_cast<uintptr_t>(pVector->data());
+        REQUIRE(iDataAddress >= reinterpret_cast<uintptr_t>(vBuffer.data()));
+        REQUIRE(iDataAddress < reinterpret_cast<uintptr_t>(vBuffer.data() + vBuffer.size()));
+
+        // Items are still found by the garbage collector.
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+        REQUIRE(pVector->at(7)->iValue == 7);
+
+        // Moved vector keeps the memory resource.
+        auto pOtherVector =
+            sgc::makeGc<sgc::pmr::GcVector<sgc::GcPtr<Collected>>>(std::move(*pVector));
+        REQUIRE(pOtherVector->get_allocator().resource() == &bufferResource);
+        REQUIRE(pOtherVector->size() == 8);
+        REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 0);
+    }
+    REQUIRE(sgc::GarbageCollector::get().collectGarbage() == 10); // NOLINT
+
+    REQUIRE(sgc::GarbageCollector::get().getAliveAllocationCount() == 0);
+}